@@ -9,6 +9,7 @@
 #
 #    usFunctionAddResources(TARGET target [BUNDLE_NAME bundle_name]
 #      [WORKING_DIRECTORY dir] [COMPRESSION_LEVEL level]
+#      [STORE_INCOMPRESSIBLE] [ALIGNMENT bytes]
 #      [FILES res1...] [ZIP_ARCHIVES archive1...])
 #
 # This CMake function uses an external command line program to generate a ZIP archive
@@ -41,10 +42,18 @@
 #      the required bundle name.
 #    * ``COMPRESSION_LEVEL`` (optional): The zip compression level (0-9). Defaults to the default zip
 #      level. Level 0 disables compression.
+#    * ``ALIGNMENT`` (optional): Align the data of resources stored without compression to a
+#      multiple of the given number of bytes (a power of two up to 32768), e.g. 4096 to align
+#      them to memory pages.
 #    * ``WORKING_DIRECTORY`` (optional): The root path for all resource files listed after the
 #      FILES argument. If no or a relative path is given, it is considered relative to the
 #      current CMake source directory.
 #
+# **Options**
+#    * ``STORE_INCOMPRESSIBLE``: Store resources without compression if deflating them does
+#      not reduce their size noticeably, e.g. images or other compressed formats. Stored
+#      resources are read directly from the bundle file at runtime.
+#
 # **Multi-value keywords**
 #    * ``FILES`` (optional): A list of resource files (paths to external files in the file system)
 #      relative to the current working directory.
@@ -60,7 +69,7 @@
 #
 function(usFunctionAddResources)
 
-  cmake_parse_arguments(US_RESOURCE "" "TARGET;BUNDLE_NAME;WORKING_DIRECTORY;COMPRESSION_LEVEL" "FILES;ZIP_ARCHIVES" ${ARGN})
+  cmake_parse_arguments(US_RESOURCE "STORE_INCOMPRESSIBLE" "TARGET;BUNDLE_NAME;WORKING_DIRECTORY;COMPRESSION_LEVEL;ALIGNMENT" "FILES;ZIP_ARCHIVES" ${ARGN})
 
   if(NOT US_RESOURCE_TARGET)
     message(SEND_ERROR "TARGET argument not specified.")
@@ -85,9 +94,16 @@ function(usFunctionAddResources)
     set(US_RESOURCE_WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/${US_RESOURCE_WORKING_DIRECTORY}")
   endif()
 
-  if(US_RESOURCE_COMPRESSION_LEVEL)
+  # Level 0 is a valid value (no compression), so test for a non-empty value
+  if(NOT "${US_RESOURCE_COMPRESSION_LEVEL}" STREQUAL "")
     set(cmd_line_args -c ${US_RESOURCE_COMPRESSION_LEVEL})
   endif()
+  if(US_RESOURCE_STORE_INCOMPRESSIBLE)
+    list(APPEND cmd_line_args -s)
+  endif()
+  if(US_RESOURCE_ALIGNMENT)
+    list(APPEND cmd_line_args -a ${US_RESOURCE_ALIGNMENT})
+  endif()
 
   if(CMAKE_CROSSCOMPILING)
     # Cross-compiled builds need to use the imported host version of usResourceCompiler
@@ -21,17 +21,28 @@ macro(_us_create_test_bundle_helper)
   
   target_link_libraries(${name} ${${PROJECT_NAME}_TARGET} ${US_TEST_LINK_LIBRARIES} ${US_TEST_OTHER_LIBRARIES} CppMicroServices)
 
+  set(_compression_level )
+  if(NOT "${US_TEST_COMPRESSION_LEVEL}" STREQUAL "")
+    set(_compression_level COMPRESSION_LEVEL ${US_TEST_COMPRESSION_LEVEL})
+  endif()
+  set(_alignment )
+  if(US_TEST_ALIGNMENT)
+    set(_alignment ALIGNMENT ${US_TEST_ALIGNMENT})
+  endif()
+
   if(_res_files OR US_TEST_LINK_LIBRARIES)
     usFunctionAddResources(TARGET ${name} WORKING_DIRECTORY ${_res_root}
                            FILES ${_res_files}
-                           ZIP_ARCHIVES ${US_TEST_LINK_LIBRARIES})
+                           ZIP_ARCHIVES ${US_TEST_LINK_LIBRARIES}
+                           ${_compression_level} ${_alignment})
   endif()
   if(_bin_res_files)
     usFunctionAddResources(TARGET ${name} WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/resources
-                           FILES ${_bin_res_files})
+                           FILES ${_bin_res_files}
+                           ${_compression_level} ${_alignment})
   endif()
 
-  usFunctionEmbedResources(TARGET ${name} ${_mode})
+  usFunctionEmbedResources(TARGET ${name} ${_mode} ${_alignment})
 
   if(NOT US_TEST_SKIP_BUNDLE_LIST)
     set(_us_test_bundle_libs "${_us_test_bundle_libs};${name}" CACHE INTERNAL "" FORCE)
@@ -49,7 +60,7 @@ function(usFunctionCreateTestBundle name)
 endfunction()
 
 function(usFunctionCreateTestBundleWithResources name)
-  cmake_parse_arguments(US_TEST "SKIP_BUNDLE_LIST;LINK_RESOURCES;APPEND_RESOURCES" "RESOURCES_ROOT;LIBRARY_EXTENSION;BUNDLE_SYMBOLIC_NAME" "SOURCES;RESOURCES;BINARY_RESOURCES;LINK_LIBRARIES;OTHER_LIBRARIES" "" ${ARGN})
+  cmake_parse_arguments(US_TEST "SKIP_BUNDLE_LIST;LINK_RESOURCES;APPEND_RESOURCES" "RESOURCES_ROOT;LIBRARY_EXTENSION;BUNDLE_SYMBOLIC_NAME;COMPRESSION_LEVEL;ALIGNMENT" "SOURCES;RESOURCES;BINARY_RESOURCES;LINK_LIBRARIES;OTHER_LIBRARIES" "" ${ARGN})
 
   if(US_TEST_BUNDLE_SYMBOLIC_NAME)
     set(_bundle_symbolic_name ${US_TEST_BUNDLE_SYMBOLIC_NAME})
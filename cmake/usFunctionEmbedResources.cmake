@@ -9,6 +9,7 @@
 #
 #    usFunctionEmbedResources(TARGET target [BUNDLE_NAME bundle_name] [APPEND | LINK]
 #      [WORKING_DIRECTORY dir] [COMPRESSION_LEVEL level]
+#      [STORE_INCOMPRESSIBLE] [ALIGNMENT bytes]
 #      [FILES res1...] [ZIP_ARCHIVES archive1...])
 #
 # This CMake function uses an external command line program to generate a ZIP archive
@@ -53,8 +54,12 @@
 #    * ``APPEND``: Append the resources zip file to the target file.
 #    * ``LINK``: Link (embed) the resources zip file if possible.
 #
-# For the ``WORKING_DIRECTORY``, ``COMPRESSION_LEVEL``, ``FILES``, ``ZIP_ARCHIVES`` parameters see the
-# documentation of the usFunctionAddResources macro which is called with these parameters if set.
+# For the ``WORKING_DIRECTORY``, ``COMPRESSION_LEVEL``, ``STORE_INCOMPRESSIBLE``, ``ALIGNMENT``,
+# ``FILES``, ``ZIP_ARCHIVES`` parameters see the documentation of the usFunctionAddResources macro
+# which is called with these parameters if set. The ``ALIGNMENT`` is kept when merging the
+# resources of the target, and in *APPEND* mode the zip file is appended at an aligned offset.
+# In *LINK* mode with ELF binaries, the section containing the zip file is aligned too, which
+# requires objcopy 2.34 or newer.
 #
 # .. seealso::
 #
@@ -64,17 +69,24 @@
 #
 function(usFunctionEmbedResources)
 
-  cmake_parse_arguments(US_RESOURCE "APPEND;LINK" "TARGET;BUNDLE_NAME;WORKING_DIRECTORY;COMPRESSION_LEVEL" "FILES;ZIP_ARCHIVES" ${ARGN})
+  cmake_parse_arguments(US_RESOURCE "APPEND;LINK;STORE_INCOMPRESSIBLE" "TARGET;BUNDLE_NAME;WORKING_DIRECTORY;COMPRESSION_LEVEL;ALIGNMENT" "FILES;ZIP_ARCHIVES" ${ARGN})
 
   if(NOT US_RESOURCE_TARGET)
     message(SEND_ERROR "TARGET argument not specified.")
   endif()
 
+  set(_store_option )
+  if(US_RESOURCE_STORE_INCOMPRESSIBLE)
+    set(_store_option STORE_INCOMPRESSIBLE)
+  endif()
+
   if(US_RESOURCE_FILES OR US_RESOURCE_ZIP_ARCHIVES)
     usFunctionAddResources(TARGET ${US_RESOURCE_TARGET}
       BUNDLE_NAME ${US_RESOURCE_BUNDLE_NAME}
       WORKING_DIRECTORY ${US_RESOURCE_WORKING_DIRECTORY}
       COMPRESSION_LEVEL ${US_RESOURCE_COMPRESSION_LEVEL}
+      ${_store_option}
+      ALIGNMENT ${US_RESOURCE_ALIGNMENT}
       FILES ${US_RESOURCE_FILES}
       ZIP_ARCHIVES ${US_RESOURCE_ZIP_ARCHIVES}
     )
@@ -134,6 +146,15 @@ function(usFunctionEmbedResources)
     endif()
   endif()
 
+  set(_alignment_args )
+  set(_section_alignment_command )
+  if(US_RESOURCE_ALIGNMENT)
+    set(_alignment_args -a ${US_RESOURCE_ALIGNMENT})
+    # Offsets in the zip file are only aligned in memory if the linked
+    # section starts at an aligned address.
+    set(_section_alignment_command COMMAND ${CMAKE_OBJCOPY} --set-section-alignment .us_resources=${US_RESOURCE_ALIGNMENT} ${_source_output} ${_source_output})
+  endif()
+
   set(_zip_archive )
   get_target_property(_counter ${US_RESOURCE_TARGET} _us_resource_counter)
   if(_counter EQUAL 0)
@@ -149,7 +170,7 @@ function(usFunctionEmbedResources)
     endif()
     add_custom_command(
       OUTPUT ${_zip_archive}
-      COMMAND ${resource_compiler} -o ${_zip_archive} -n dummy ${_zip_args}
+      COMMAND ${resource_compiler} -o ${_zip_archive} -n dummy ${_alignment_args} ${_zip_args}
       DEPENDS ${_res_zips} ${resource_compiler}
       COMMENT "Creating resources zip file for ${US_RESOURCE_TARGET}"
       VERBATIM
@@ -200,6 +221,7 @@ function(usFunctionEmbedResources)
         OUTPUT ${_source_output}
         COMMAND ${CMAKE_LINKER} -r --format=binary ${_ADDITIONAL_LINKER_FLAGS} -o ${_source_output} ${_zip_archive_name}
         COMMAND ${CMAKE_OBJCOPY} --rename-section .data=.us_resources,alloc,load,readonly,data,contents ${_source_output} ${_source_output}
+        ${_section_alignment_command}
         DEPENDS ${_zip_archive}
         WORKING_DIRECTORY ${_zip_archive_path}
         COMMENT "Linking resources zip file for ${US_RESOURCE_TARGET}"
@@ -230,7 +252,7 @@ function(usFunctionEmbedResources)
     add_custom_command(
       TARGET ${US_RESOURCE_TARGET}
       POST_BUILD
-      COMMAND ${resource_compiler} -b $<TARGET_FILE:${US_RESOURCE_TARGET}> -z ${_zip_archive}
+      COMMAND ${resource_compiler} -b $<TARGET_FILE:${US_RESOURCE_TARGET}> ${_alignment_args} -z ${_zip_archive}
       WORKING_DIRECTORY ${US_RESOURCE_WORKING_DIRECTORY}
       COMMENT "Appending zipped resources to ${US_RESOURCE_TARGET}"
       VERBATIM
@@ -37,12 +37,17 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdlib>
 #include <functional>
 #include <list>
 #include <map>
 #include <memory>
+#include <new>
 #include <set>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -273,6 +278,9 @@ std::ostream& any_value_to_json(std::ostream& os,
  * An Any class represents a general type and is capable of storing any type, supporting type-safe extraction
  * of the internally stored data.
  *
+ * Small values, e.g. numbers, pointers, shared pointers and strings, are
+ * stored inline without allocating.
+ *
  * Code taken from the Boost 1.46.1 library. Original copyright by Kevlin Henney. Modified for CppMicroServices.
  */
 class US_Framework_EXPORT Any
@@ -296,7 +304,7 @@ public:
    */
   template<typename ValueType>
   Any(const ValueType& value)
-    : _content(new Holder<ValueType>(value))
+    : _content(Holder<ValueType>::Create(GetStorage(), value))
   {}
 
   /**
@@ -305,7 +313,8 @@ public:
    * \param other The Any to copy
    */
   Any(const Any& other)
-    : _content(other._content ? other._content->Clone() : nullptr)
+    : _content(other._content ? other._content->CloneInto(GetStorage())
+                              : nullptr)
   {}
 
   /**
@@ -313,9 +322,9 @@ public:
    *
    * @param other The Any to move
    */
-  Any(Any&& other) noexcept
-    : _content(std::move(other._content))
-  {}
+  Any(Any&& other) noexcept { MoveFrom(other); }
+
+  ~Any() { Reset(); }
 
   /**
    * Swaps the content of the two Anys.
@@ -324,7 +333,13 @@ public:
    */
   Any& Swap(Any& rhs)
   {
-    std::swap(_content, rhs._content);
+    if (!IsInline() && !rhs.IsInline()) {
+      std::swap(_content, rhs._content);
+      return *this;
+    }
+    Any tmp(std::move(rhs));
+    rhs = std::move(*this);
+    *this = std::move(tmp);
     return *this;
   }
 
@@ -409,7 +424,10 @@ public:
    */
   Any& operator=(Any&& rhs) noexcept
   {
-    _content = std::move(rhs._content);
+    if (this != &rhs) {
+      Reset();
+      MoveFrom(rhs);
+    }
     return *this;
   }
 
@@ -437,6 +455,18 @@ public:
    */
   std::string ToStringNoExcept() const;
 
+  /**
+   * Writes a string representation for the content to a stream, without
+   * creating intermediate strings for nested containers.
+   *
+   * \param os The stream to write to.
+   * \returns \c os
+   * \throws std::logic_error if the Any is empty.
+   *
+   * \see ToString()
+   */
+  std::ostream& ToString(std::ostream& os) const;
+
   /**
    * Returns a JSON representation for the content.
    *
@@ -454,7 +484,9 @@ public:
    */
   std::string ToJSON(const uint8_t increment, const int32_t indent) const
   {
-    return Empty() ? "null" : _content->ToJSON(increment, indent);
+    std::ostringstream ss;
+    ToJSON(ss, increment, indent);
+    return ss.str();
   }
   std::string ToJSON(bool prettyPrint = false) const
   {
@@ -463,6 +495,31 @@ public:
     uint8_t increment = prettyPrint ? 4 : 0;
     return ToJSON(increment, increment);
   }
+
+  /**
+   * Writes a JSON representation for the content to a stream. Nested
+   * containers are written into the same stream, so large values are
+   * serialized without intermediate strings.
+   *
+   * @param os        The stream to write to.
+   * @param increment The amount of extra indentation to add for each level of JSON. An increment of
+   *                  zero indicates no special formatting
+   * @param indent    The current amount of indent to apply to the current line.
+   * @return \c os
+   *
+   * @see ToJSON(const uint8_t, const int32_t) const
+   */
+  std::ostream& ToJSON(std::ostream& os,
+                       const uint8_t increment,
+                       const int32_t indent) const
+  {
+    return Empty() ? os << "null" : _content->ToJSON(os, increment, indent);
+  }
+  std::ostream& ToJSON(std::ostream& os, bool prettyPrint = false) const
+  {
+    uint8_t increment = prettyPrint ? 4 : 0;
+    return ToJSON(os, increment, increment);
+  }
   /**
    * Returns the type information of the stored content.
    * If the Any is empty typeid(void) is returned.
@@ -475,17 +532,46 @@ public:
   }
 
 private:
+  /**
+   * Size of the inline storage, large enough for a holder of a
+   * std::string. Over-aligned values are stored on the heap.
+   *
+   * The storage is only part of an Any if the library was configured with
+   * US_ENABLE_ANY_INLINE_STORAGE, because it changes the size of Any and
+   * therefore the ABI. Otherwise all values are stored on the heap.
+   */
+  static constexpr std::size_t BufferSize =
+    sizeof(void*) + sizeof(std::string);
+
+  struct alignas(void*) alignas(double) Storage
+  {
+    unsigned char data[BufferSize];
+  };
+
   class Placeholder
   {
   public:
     virtual ~Placeholder() = default;
 
-    virtual std::string ToString() const = 0;
-    virtual std::string ToJSON(const uint8_t increment = 0,
-                               const int32_t indent = 0) const = 0;
+    virtual std::ostream& ToString(std::ostream& os) const = 0;
+    virtual std::ostream& ToJSON(std::ostream& os,
+                                 const uint8_t increment,
+                                 const int32_t indent) const = 0;
 
     virtual const std::type_info& Type() const = 0;
-    virtual std::unique_ptr<Placeholder> Clone() const = 0;
+
+    /**
+     * Copies this holder into <code>storage</code> if the value fits,
+     * and onto the heap otherwise.
+     */
+    virtual Placeholder* CloneInto(Storage* storage) const = 0;
+
+    /**
+     * Moves this holder into <code>storage</code>. Only called for
+     * holders which are stored inline.
+     */
+    virtual Placeholder* MoveInto(Storage* storage) noexcept = 0;
+
     virtual bool compare(const Any& lhs) const = 0;
   };
 
@@ -501,26 +587,58 @@ private:
       : _held(std::move(value))
     {}
 
-    std::string ToString() const override
+    /**
+     * Values are stored inline if they fit and cannot throw while being
+     * moved, so that moving an Any stays noexcept.
+     */
+    static constexpr bool IsInline()
+    {
+#ifdef US_ENABLE_ANY_INLINE_STORAGE
+      return sizeof(Holder) <= sizeof(Storage) &&
+             alignof(Holder) <= alignof(Storage) &&
+             std::is_nothrow_move_constructible<ValueType>::value;
+#else
+      return false;
+#endif
+    }
+
+    static Placeholder* Create(Storage* storage, const ValueType& value)
     {
-      std::stringstream ss;
-      any_value_to_string(ss, _held);
-      return ss.str();
+      if constexpr (IsInline()) {
+        return new (storage) Holder(value);
+      } else {
+        return new Holder(value);
+      }
     }
 
-    std::string ToJSON(const uint8_t increment,
-                       const int32_t indent) const override
+    std::ostream& ToString(std::ostream& os) const override
     {
-      std::stringstream ss;
-      any_value_to_json(ss, _held, increment, indent);
-      return ss.str();
+      return any_value_to_string(os, _held);
+    }
+
+    std::ostream& ToJSON(std::ostream& os,
+                         const uint8_t increment,
+                         const int32_t indent) const override
+    {
+      return any_value_to_json(os, _held, increment, indent);
     }
 
     const std::type_info& Type() const override { return typeid(ValueType); }
 
-    std::unique_ptr<Placeholder> Clone() const override
+    Placeholder* CloneInto(Storage* storage) const override
     {
-      return std::unique_ptr<Placeholder>(new Holder(_held));
+      return Create(storage, _held);
+    }
+
+    Placeholder* MoveInto(Storage* storage) noexcept override
+    {
+      if constexpr (IsInline()) {
+        return new (storage) Holder(std::move(_held));
+      } else {
+        // heap holders are moved by transferring the pointer
+        static_cast<void>(storage);
+        std::abort();
+      }
     }
 
     ValueType _held;
@@ -543,7 +661,63 @@ private:
   template<typename ValueType>
   friend ValueType* unsafe_any_cast(Any*);
 
-  std::unique_ptr<Placeholder> _content;
+  bool IsInline() const noexcept
+  {
+#ifdef US_ENABLE_ANY_INLINE_STORAGE
+    return static_cast<const void*>(_content) ==
+           static_cast<const void*>(&_storage);
+#else
+    return false;
+#endif
+  }
+
+  Storage* GetStorage() noexcept
+  {
+#ifdef US_ENABLE_ANY_INLINE_STORAGE
+    return &_storage;
+#else
+    return nullptr;
+#endif
+  }
+
+  void Reset() noexcept
+  {
+    if (IsInline()) {
+      _content->~Placeholder();
+    } else {
+      delete _content;
+    }
+    _content = nullptr;
+  }
+
+  /**
+   * Takes the content of <code>other</code>, which is left empty. The
+   * content of this Any must have been reset before.
+   */
+  void MoveFrom(Any& other) noexcept
+  {
+    if (other.IsInline()) {
+      _content = other._content->MoveInto(GetStorage());
+      other.Reset();
+    } else {
+      _content = other._content;
+      other._content = nullptr;
+    }
+  }
+
+  /**
+   * Inline storage for small values. It is declared before
+   * <code>_content</code>, which the constructors create in it.
+   */
+#ifdef US_ENABLE_ANY_INLINE_STORAGE
+  Storage _storage;
+#endif
+
+  /**
+   * The held value. Points to <code>_storage</code> if the value is
+   * stored inline, and to a heap allocated holder otherwise.
+   */
+  Placeholder* _content = nullptr;
 };
 
 /**
@@ -606,7 +780,7 @@ template<typename ValueType>
 ValueType* any_cast(Any* operand)
 {
   return operand && operand->Type() == typeid(ValueType)
-           ? &static_cast<Any::Holder<ValueType>*>(operand->_content.get())
+           ? &static_cast<Any::Holder<ValueType>*>(operand->_content)
                 ->_held
            : nullptr;
 }
@@ -741,7 +915,7 @@ ValueType& ref_any_cast(Any& operand)
 template<typename ValueType>
 ValueType* unsafe_any_cast(Any* operand)
 {
-  return &static_cast<Any::Holder<ValueType>*>(operand->_content.get())->_held;
+  return &static_cast<Any::Holder<ValueType>*>(operand->_content)->_held;
 }
 
 /**
@@ -768,10 +942,10 @@ std::ostream& any_value_to_string(std::ostream& os, const std::map<K, Any>& m)
   const Iterator begin = i1;
   const Iterator end = m.end();
   for (; i1 != end; ++i1) {
-    if (i1 == begin)
-      os << i1->first << " : " << i1->second.ToString();
-    else
-      os << ", " << i1->first << " : " << i1->second.ToString();
+    if (i1 != begin)
+      os << ", ";
+    os << i1->first << " : ";
+    i1->second.ToString(os);
   }
   os << "}";
   return os;
@@ -816,8 +990,8 @@ std::ostream& any_value_to_json(std::ostream& os,
       os << ", ";
     }
     newline_and_indent(os, increment, indent);
-    os << "\"" << i1->first
-       << "\" : " << i1->second.ToJSON(increment, indent + increment);
+    os << "\"" << i1->first << "\" : ";
+    i1->second.ToJSON(os, increment, indent + increment);
   }
   newline_and_indent(os, increment, indent - increment);
   os << "}";
@@ -26,20 +26,29 @@
 #include "cppmicroservices/Any.h"
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace cppmicroservices {
 
 namespace detail {
 
+/**
+ * Hashes keys ignoring the case of ASCII letters, without copying them.
+ */
 struct US_Framework_EXPORT any_map_cihash
 {
   std::size_t operator()(const std::string& key) const;
+  std::size_t operator()(std::string_view key) const;
 };
 
+/**
+ * Compares keys ignoring the case of ASCII letters.
+ */
 struct US_Framework_EXPORT any_map_ciequal
 {
   bool operator()(const std::string& l, const std::string& r) const;
+  bool operator()(std::string_view l, std::string_view r) const;
 };
 
 }
@@ -242,11 +251,23 @@ public:
   bool empty() const;
   size_type size() const;
   size_type count(const key_type& key) const;
+  size_type count(std::string_view key) const;
+  size_type count(const char* key) const;
   void clear();
 
   mapped_type& at(const key_type& key);
   const mapped_type& at(const key_type& key) const;
 
+  /**
+   * Look up a key which is not held in a std::string. The key is copied
+   * into a buffer which is reused by the calling thread, so the lookup
+   * does not allocate once the buffer is large enough.
+   */
+  mapped_type& at(std::string_view key);
+  const mapped_type& at(std::string_view key) const;
+  mapped_type& at(const char* key);
+  const mapped_type& at(const char* key) const;
+
   mapped_type& operator[](const key_type& key);
   mapped_type& operator[](key_type&& key);
 
@@ -277,6 +298,8 @@ public:
    * return the iterator to the value referenced by key
    */
   const_iterator find(const key_type& key) const;
+  const_iterator find(std::string_view key) const;
+  const_iterator find(const char* key) const;
 
   /**
    * Erase entry for value for 'key'
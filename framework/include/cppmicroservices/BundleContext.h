@@ -24,6 +24,7 @@
 #define CPPMICROSERVICES_BUNDLECONTEXT_H
 
 #include "cppmicroservices/AnyMap.h"
+#include "cppmicroservices/BundleStartResult.h"
 #include "cppmicroservices/GlobalConfig.h"
 #include "cppmicroservices/ListenerFunctors.h"
 #include "cppmicroservices/ListenerToken.h"
@@ -31,6 +32,8 @@
 #include "cppmicroservices/ServiceRegistration.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace cppmicroservices {
 
@@ -294,8 +297,9 @@ public:
    *
    * @throws std::runtime_error If this BundleContext is no longer valid, or if there are
              case variants of the same key in the supplied properties map.
-   * @throws std::invalid_argument If the InterfaceMap is empty, or
-   *         if a service is registered as a null class.
+   * @throws std::invalid_argument If the InterfaceMap is empty, if a
+   *         service is registered as a null class, or if the
+   *         Constants::SERVICE_RANKING property is not an <code>int</code>.
    *
    * @see ServiceRegistration
    * @see ServiceFactory
@@ -305,6 +309,65 @@ public:
     const InterfaceMapConstPtr& service,
     const ServiceProperties& properties = ServiceProperties());
 
+  /**
+   * Registers several service objects with the framework. Each element of
+   * <code>services</code> is registered as if by a call to
+   * {@link #RegisterService(const InterfaceMapConstPtr&, const ServiceProperties&)},
+   * but all services are added to the service registry at once:
+   * <ul>
+   * <li>All services are validated first. If one of them is invalid, an
+   * exception is thrown and none of them is registered.
+   * <li>The services are added to the framework service registry and may now
+   * be used by other bundles.
+   * <li>A service event of type ServiceEvent#SERVICE_REGISTERED is fired for
+   * each service, in the order of <code>services</code>.
+   * </ul>
+   *
+   * Registering services in a batch is considerably cheaper than
+   * registering them one by one, in particular when many service
+   * listeners are registered.
+   *
+   * @param services The services to register. Each element holds a
+   *        shared_ptr to a map of interface identifiers to service objects
+   *        and the properties for this service.
+   * @return The <code>ServiceRegistration</code> objects, in the order of
+   *         <code>services</code>.
+   *
+   * @throws std::runtime_error If this BundleContext is no longer valid, or if there are
+   *         case variants of the same key in the supplied properties maps.
+   * @throws std::invalid_argument If one of the InterfaceMaps is empty, if
+   *         a service is registered as a null class, or if a
+   *         Constants::SERVICE_RANKING property is not an <code>int</code>.
+   *
+   * @see RegisterService
+   * @see UnregisterServices
+   */
+  std::vector<ServiceRegistrationU> RegisterServices(
+    const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+      services);
+
+  /**
+   * Unregisters several services at once. This is equivalent to calling
+   * ServiceRegistrationBase::Unregister for each element of
+   * <code>registrations</code>, except that the services are removed from
+   * the service registry together. Service events of type
+   * ServiceEvent#SERVICE_UNREGISTERING are fired in the order of
+   * <code>registrations</code>, after all services have been removed.
+   *
+   * @param registrations The registrations of the services to unregister.
+   *
+   * @throws std::runtime_error If this BundleContext is no longer valid.
+   * @throws std::logic_error If one of the registrations is invalid or
+   *         its service has already been unregistered. No service is
+   *         unregistered in that case.
+   * @throws std::invalid_argument If one of the services was registered with
+   *         a different framework.
+   *
+   * @see RegisterServices
+   */
+  void UnregisterServices(
+    const std::vector<ServiceRegistrationBase>& registrations);
+
   /**
    * Registers the specified service object with the specified properties
    * using the specified interfaces types with the framework.
@@ -1122,6 +1185,64 @@ public:
     const cppmicroservices::AnyMap& bundleManifest = cppmicroservices::AnyMap(
       cppmicroservices::any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
 
+  /**
+   * Installs all bundles from the bundle libraries at the specified locations.
+   *
+   * This is equivalent to calling InstallBundles(const std::string&, const AnyMap&)
+   * for each location in order, but the bundle files are opened and their
+   * manifests are read concurrently on up to
+   * Constants::FRAMEWORK_BUNDLE_INSTALL_THREADS threads. The bundles are added
+   * to the framework and the <code>BundleEvent::BUNDLE_INSTALLED</code> events
+   * are fired on the calling thread, in the order of <code>locations</code>.
+   *
+   * @remarks If installing the bundles at one location fails, the exception is
+   *          thrown and the remaining locations are not installed. Bundles
+   *          installed from preceding locations stay installed.
+   *
+   * @param locations The locations of the bundle libraries to install.
+   * @return The Bundle objects of the installed bundle libraries, in the order
+   *         of <code>locations</code>. The result is flattened: a library
+   *         which contains several bundles contributes all of them, and a
+   *         location given more than once contributes its bundles again.
+   * @throws std::runtime_error If the BundleContext is no longer valid, or if the installation failed.
+   * @throws std::logic_error If the framework instance is no longer active
+   * @throws std::invalid_argument If a location is not a valid UTF8 string
+   *
+   * @see InstallBundles(const std::string&, const AnyMap&)
+   */
+  std::vector<Bundle> InstallBundles(const std::vector<std::string>& locations);
+
+  /**
+   * Starts the specified bundles concurrently.
+   *
+   * Each bundle is started as with Bundle::Start(uint32_t), on one of up to
+   * Constants::FRAMEWORK_BUNDLE_START_THREADS threads, including the calling
+   * thread. A bundle is only started after the bundles listed in its
+   * Constants::BUNDLE_STARTDEPENDENCIES manifest header which are part of
+   * <code>bundles</code> have been started. The
+   * <code>BundleEvent::BUNDLE_STARTING</code> and
+   * <code>BundleEvent::BUNDLE_STARTED</code> events of a bundle are fired on
+   * the thread starting it.
+   *
+   * @remarks A bundle which fails to start does not stop the other bundles
+   *          from being started, but the bundles depending on it are not
+   *          started. The failures are reported in the returned results.
+   *
+   * @param bundles The bundles to start.
+   * @param options The options passed to Bundle::Start(uint32_t).
+   * @return The result of starting each bundle, in the order of
+   *         <code>bundles</code>.
+   * @throws std::runtime_error If the BundleContext is no longer valid.
+   * @throws std::invalid_argument If a bundle is invalid or has an invalid
+   *         start dependencies header, or if the start dependencies of the
+   *         bundles form a cycle.
+   *
+   * @see Bundle::Start(uint32_t)
+   */
+  std::vector<BundleStartResult> StartBundles(
+    const std::vector<Bundle>& bundles,
+    uint32_t options = 0);
+
 private:
   friend US_Framework_EXPORT BundleContext
   MakeBundleContext(BundleContextPrivate*);
@@ -36,6 +36,10 @@ namespace cppmicroservices {
 class BundleResourcePrivate;
 struct BundleArchive;
 
+namespace detail {
+class BundleResourceReader;
+}
+
 /**
 \defgroup gr_bundleresource BundleResource
 
@@ -316,7 +320,9 @@ private:
 
   std::size_t Hash() const;
 
-  std::unique_ptr<void, void (*)(void*)> GetData() const;
+  std::shared_ptr<const void> GetData() const;
+
+  std::unique_ptr<detail::BundleResourceReader> GetReader() const;
 
   std::shared_ptr<BundleResourcePrivate> d;
 };
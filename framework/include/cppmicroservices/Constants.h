@@ -212,6 +212,26 @@ US_Framework_EXPORT extern const std::string
  */
 US_Framework_EXPORT extern const std::string ACTIVATION_LAZY; // = "lazy";
 
+/**
+ * Manifest header listing the symbolic names of the bundles which must be
+ * started before this bundle, when bundles are started together with
+ * BundleContext::StartBundles. The value is a list of strings, or a single
+ * string:
+ *
+ * <pre>
+ *       bundle: { start_dependencies: ["org_me_logging", "org_me_config"] }
+ * </pre>
+ *
+ * Bundles which are not started by the same call are ignored.
+ *
+ * The header value may be retrieved from the \c AnyMap object
+ * returned by the \c Bundle::GetHeaders() method.
+ *
+ * @see BundleContext::StartBundles
+ */
+US_Framework_EXPORT extern const std::string
+  BUNDLE_STARTDEPENDENCIES; // = "bundle.start_dependencies";
+
 /**
  * Framework environment property identifying the Framework version.
  *
@@ -337,6 +357,130 @@ US_Framework_EXPORT extern const std::string
  */
 US_Framework_EXPORT extern const std::string FRAMEWORK_BUNDLE_VALIDATION_FUNC; // = "org.cppmicroservices.framework.bundle.validation.function"
 
+/**
+ * Framework launching property specifying the maximum number of threads
+ * used by BundleContext::InstallBundles(const std::vector<std::string>&)
+ * to open bundle files and read their manifests. The value must be of type
+ * <code>int</code> and defaults to the number of hardware threads. A value
+ * of 1 reads all bundle files on the calling thread.
+ *
+ * Without threading support the property is ignored.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_INSTALL_THREADS; // = "org.cppmicroservices.framework.bundle.install.threads";
+
+/**
+ * Framework launching property specifying the maximum number of threads
+ * used by BundleContext::StartBundles to start bundles. The value must be
+ * of type <code>int</code> and defaults to the number of hardware threads.
+ * A value of 1 starts all bundles on the calling thread.
+ *
+ * Without threading support the property is ignored.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_START_THREADS; // = "org.cppmicroservices.framework.bundle.start.threads";
+
+/**
+ * Framework launching property specifying whether the framework keeps a
+ * cache of bundle metadata in its persistent storage area (see
+ * #FRAMEWORK_STORAGE). The value must be of type <code>bool</code> and
+ * defaults to <code>false</code>.
+ *
+ * If enabled, the manifests and the resource index of an installed bundle
+ * file are written to the cache. Installing the same, unmodified file
+ * again, e.g. in a later process, reads them from the cache instead of
+ * parsing the embedded zip archive and the manifest.json files. A cache
+ * entry is only used if the path, size, modification time and file
+ * serial number (inode) of the bundle file match. Replacing a bundle file
+ * in place within the same second, with a file of the same size, is not
+ * detected.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_METADATA_CACHE; // = "org.cppmicroservices.framework.bundle.metadata.cache";
+
+/**
+ * Framework launching property specifying whether the framework records
+ * how long each bundle spends in the phases of being installed and
+ * started. The value must be of type <code>bool</code> and defaults to
+ * <code>false</code>. If disabled, no clock is read.
+ *
+ * @see Framework::GetBundlePhaseTimings()
+ * @see Framework::WriteBundlePhaseTimings(std::ostream&)
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_TIMING; // = "org.cppmicroservices.framework.bundle.timing";
+
+/**
+ * Framework launching property specifying how service events are delivered
+ * to service listeners. The value must be of type <code>std::string</code>:
+ *
+ * - "sync" - Listeners are called on the thread which fired the event,
+ *   before the method firing it returns. This is the default.
+ * - "async" - Events are queued per bundle owning the listener and delivered
+ *   on framework worker threads. Each listener receives the events of a
+ *   service in the order they were fired, but a listener may run after the
+ *   service was modified or unregistered again. Service event listener
+ *   hooks are still called synchronously.
+ *
+ * Asynchronous delivery requires threading support, the property is
+ * ignored otherwise.
+ *
+ * @see Framework::GetServiceEventDeliveryStatistics()
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_DELIVERY; // = "org.cppmicroservices.framework.service.event.delivery";
+
+/**
+ * Service event delivery configuration declaring that service events are
+ * delivered synchronously.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_DELIVERY_SYNC; // = "sync";
+
+/**
+ * Service event delivery configuration declaring that service events are
+ * delivered asynchronously.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_DELIVERY_ASYNC; // = "async";
+
+/**
+ * Framework launching property specifying the maximum number of service
+ * events queued for the listeners of a single bundle when service events
+ * are delivered asynchronously. The value must be of type <code>int</code>
+ * and defaults to 1024.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_QUEUE_DEPTH; // = "org.cppmicroservices.framework.service.event.queue.depth";
+
+/**
+ * Framework launching property specifying what happens when a service
+ * event is fired and a bundle's asynchronous delivery queue is full. The
+ * value must be of type <code>std::string</code>:
+ *
+ * - "block" - The thread firing the event waits until the queue has room.
+ *   This is the default.
+ * - "discard" - The event is not delivered to the listeners of that bundle.
+ *
+ * Events fired from within a listener are always queued.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_QUEUE_POLICY; // = "org.cppmicroservices.framework.service.event.queue.policy";
+
+/**
+ * Service event queue policy declaring that threads firing service events
+ * wait for room in full queues.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_QUEUE_BLOCK; // = "block";
+
+/**
+ * Service event queue policy declaring that service events are discarded
+ * for full queues.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_QUEUE_DISCARD; // = "discard";
+
 /*
  * Service properties.
  */
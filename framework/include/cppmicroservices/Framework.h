@@ -27,9 +27,13 @@
 #include "cppmicroservices/FrameworkConfig.h"
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace cppmicroservices {
 
@@ -63,6 +67,82 @@ class FrameworkPrivate;
 class US_Framework_EXPORT Framework : public Bundle
 {
 public:
+  /**
+   * Statistics about the asynchronous delivery of service events.
+   *
+   * @see Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY
+   */
+  struct ServiceEventDeliveryStatistics
+  {
+    /** Number of events queued for delivery to a listener. */
+    uint64_t queued = 0;
+    /** Number of queued events taken from the queue for delivery. */
+    uint64_t delivered = 0;
+    /** Number of events discarded because a queue was full. */
+    uint64_t discarded = 0;
+    /** Number of events currently waiting in the queues. */
+    std::size_t pending = 0;
+    /** Largest number of events which waited in a single queue. */
+    std::size_t maxQueueDepth = 0;
+    /** Mean time between queueing and delivering an event. */
+    std::chrono::microseconds averageLatency{ 0 };
+    /** Longest time between queueing and delivering an event. */
+    std::chrono::microseconds maxLatency{ 0 };
+  };
+
+  /**
+   * A phase of installing or starting a bundle.
+   *
+   * @see Constants::FRAMEWORK_BUNDLE_TIMING
+   */
+  enum class BundlePhase
+  {
+    /**
+     * Opening a bundle file and reading its resource index. This happens
+     * before the bundles in the file are created, so the timing only has
+     * the location of the file.
+     */
+    OpenResources,
+    /**
+     * Installing the bundle, from the start of installing its bundle file
+     * until the bundle was created. Includes ParseManifest.
+     */
+    Install,
+    /** Parsing the manifest.json file of the bundle. */
+    ParseManifest,
+    /** Resolving the bundle, including the resolved event listeners. */
+    Resolve,
+    /** Loading the shared library of the bundle. */
+    LoadLibrary,
+    /** Creating the bundle activator and calling its Start method. */
+    ActivatorStart,
+    /**
+     * Calling the listeners of the started event of the bundle. Extenders
+     * such as Declarative Services activate the components of the bundle
+     * here.
+     */
+    StartedListeners
+  };
+
+  /**
+   * The time a bundle spent in a BundlePhase.
+   */
+  struct BundlePhaseTiming
+  {
+    /** The id of the bundle, or -1 for BundlePhase::OpenResources. */
+    long bundleId = -1;
+    /** The symbolic name of the bundle, empty if bundleId is -1. */
+    std::string symbolicName;
+    /** The location of the bundle. */
+    std::string location;
+    BundlePhase phase = BundlePhase::Install;
+    /** When the phase began. */
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration duration{ 0 };
+    /** The thread which ran the phase. */
+    std::thread::id thread;
+  };
+
   /**
      * Convert a \c Bundle representing the system bundle to a
      * \c Framework instance.
@@ -133,6 +213,38 @@ public:
      */
   FrameworkEvent WaitForStop(const std::chrono::milliseconds& timeout);
 
+  /**
+   * Returns statistics about the asynchronous delivery of service events
+   * since this Framework was initialized. All values are zero if service
+   * events are delivered synchronously.
+   *
+   * @return The service event delivery statistics.
+   * @see Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY
+   */
+  ServiceEventDeliveryStatistics GetServiceEventDeliveryStatistics() const;
+
+  /**
+   * Returns the phase timings recorded for the bundles installed and
+   * started since this Framework was last initialized, ordered by the end
+   * of the phase. Empty unless Constants::FRAMEWORK_BUNDLE_TIMING is
+   * enabled.
+   *
+   * @return The recorded phase timings.
+   * @see Constants::FRAMEWORK_BUNDLE_TIMING
+   */
+  std::vector<BundlePhaseTiming> GetBundlePhaseTimings() const;
+
+  /**
+   * Writes the recorded phase timings (see GetBundlePhaseTimings()) as
+   * Chrome trace event JSON, which can be loaded into chrome://tracing or
+   * Perfetto. Each phase is a complete event, with microsecond timestamps
+   * relative to the earliest recorded phase.
+   *
+   * @param os The stream to write to.
+   * @see Constants::FRAMEWORK_BUNDLE_TIMING
+   */
+  void WriteBundlePhaseTimings(std::ostream& os) const;
+
   /**
      * Start this Framework.
      *
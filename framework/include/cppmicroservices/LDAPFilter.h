@@ -25,6 +25,8 @@
 
 #include "cppmicroservices/AnyMap.h"
 
+#include <cstdint>
+
 #ifdef _MSC_VER
 #  pragma warning(push)
 #  pragma warning(disable : 4251)
@@ -183,6 +185,32 @@ public:
 
   LDAPFilter& operator=(const LDAPFilter& filter);
 
+  /**
+   * Statistics of the process wide cache of parsed filter strings.
+   *
+   * The cache is shared by all <code>LDAPFilter</code> objects, service
+   * listeners and service queries which use a filter string.
+   */
+  struct CacheStatistics
+  {
+    /** Number of filter strings which were found in the cache. */
+    std::uint64_t hits;
+    /** Number of filter strings which had to be parsed. */
+    std::uint64_t misses;
+    /** Number of parsed filters currently held in the cache. */
+    std::size_t size;
+    /** Maximum number of parsed filters held in the cache. */
+    std::size_t capacity;
+  };
+
+  /**
+   * Returns the statistics of the process wide cache of parsed filter
+   * strings. The hit and miss counters are never reset.
+   *
+   * @return The current cache statistics.
+   */
+  static CacheStatistics GetCacheStatistics();
+
 protected:
   std::shared_ptr<LDAPFilterData> d;
 };
@@ -33,6 +33,7 @@ namespace cppmicroservices {
 namespace detail {
 
 class BundleResourceBufferPrivate;
+class BundleResourceReader;
 
 class US_Framework_EXPORT BundleResourceBuffer : public std::streambuf
 {
@@ -45,6 +46,25 @@ public:
                                 std::size_t size,
                                 std::ios_base::openmode mode);
 
+  /**
+   * Creates a buffer reading from <code>data</code>, which is not copied.
+   * The buffer shares ownership of the data, which may for example be a
+   * view into a memory mapped bundle file.
+   */
+  explicit BundleResourceBuffer(std::shared_ptr<const void> data,
+                                std::size_t size,
+                                std::ios_base::openmode mode);
+
+  /**
+   * Creates a buffer reading <code>size</code> bytes from
+   * <code>reader</code>. Data which the reader returns in several chunks
+   * is read on demand, one chunk at a time, and seeking backwards starts
+   * reading from the beginning again.
+   */
+  explicit BundleResourceBuffer(std::unique_ptr<BundleResourceReader> reader,
+                                std::size_t size,
+                                std::ios_base::openmode mode);
+
   ~BundleResourceBuffer() override;
 
 private:
@@ -54,6 +74,8 @@ private:
 
   int_type pbackfail(int_type ch) override;
 
+  std::streamsize xsgetn(char_type* s, std::streamsize count) override;
+
   std::streamsize showmanyc() override;
 
   pos_type seekoff(off_type off,
@@ -44,7 +44,7 @@ namespace {
 std::shared_ptr<BundlePrivate> GetAndCheckBundlePrivate(
   const std::shared_ptr<BundleContextPrivate>& d)
 {
-  auto b = (d->Lock(), d->bundle.lock());
+  auto b = d->bundle.lock();
   if (!b) {
     throw std::runtime_error("The bundle context is no longer valid");
   }
@@ -175,8 +175,10 @@ std::vector<Bundle> BundleContext::GetBundles() const
   d->CheckValid();
   auto b = GetAndCheckBundlePrivate(d);
 
+  auto snapshot = b->coreCtx->bundleRegistry.GetBundlesSnapshot();
   std::vector<Bundle> bus;
-  for (auto bu : b->coreCtx->bundleRegistry.GetBundles()) {
+  bus.reserve(snapshot->size());
+  for (auto const& bu : *snapshot) {
     bus.emplace_back(MakeBundle(bu));
   }
   b->coreCtx->bundleHooks.FilterBundles(*this, bus);
@@ -197,6 +199,34 @@ ServiceRegistrationU BundleContext::RegisterService(
   return b->coreCtx->services.RegisterService(b.get(), service, properties);
 }
 
+std::vector<ServiceRegistrationU> BundleContext::RegisterServices(
+  const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+    services)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  auto regs = b->coreCtx->services.RegisterServices(b.get(), services);
+  return std::vector<ServiceRegistrationU>(regs.begin(), regs.end());
+}
+
+void BundleContext::UnregisterServices(
+  const std::vector<ServiceRegistrationBase>& registrations)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  b->coreCtx->services.UnregisterServices(registrations);
+}
+
 std::vector<ServiceReferenceU> BundleContext::GetServiceReferences(
   const std::string& clazz,
   const std::string& filter)
@@ -484,4 +514,31 @@ std::vector<Bundle> BundleContext::InstallBundles(
   return b->coreCtx->bundleRegistry.Install(location, b.get(), bundleManifest);
 }
 
+std::vector<Bundle> BundleContext::InstallBundles(
+  const std::vector<std::string>& locations)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  return b->coreCtx->bundleRegistry.Install(locations, b.get());
+}
+
+std::vector<BundleStartResult> BundleContext::StartBundles(
+  const std::vector<Bundle>& bundles,
+  uint32_t options)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  return b->coreCtx->bundleRegistry.Start(bundles, options);
+}
+
 }
@@ -48,7 +48,11 @@ public:
 
   void Invalidate();
 
-  std::weak_ptr<BundlePrivate> bundle;
+  /**
+   * The bundle of this context. Not modified after construction, so it
+   * can be read without the lock.
+   */
+  const std::weak_ptr<BundlePrivate> bundle;
 
   /**
    * Is bundle context valid.
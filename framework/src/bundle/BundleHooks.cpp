@@ -63,6 +63,9 @@ void BundleHooks::FilterBundles(const BundleContext& context,
 {
   std::vector<ServiceRegistrationBase> srl;
   coreCtx->services.Get(us_service_interface_iid<BundleFindHook>(), srl);
+  if (srl.empty()) {
+    return;
+  }
   ShrinkableVector<Bundle> filtered(bundles);
 
   auto selfBundle = GetBundleContext().GetBundle();
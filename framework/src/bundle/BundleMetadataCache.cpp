@@ -0,0 +1,393 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "BundleMetadataCache.h"
+
+#include "cppmicroservices/util/FileSystem.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+  Layout of a cache entry file. All integers are stored in host byte
+  order; an entry written on a host with a different byte order fails
+  the magic number check. Strings are stored as a uint32 length followed
+  by the characters.
+
+    uint32  magic
+    uint32  format version
+    string  location of the bundle file
+    uint64  size of the bundle file
+    int64   modification time of the bundle file
+    uint64  file serial number (inode) of the bundle file
+    uint32  number of manifests
+            followed by (string symbolic name, value headers) pairs
+    uint32  number of zip entries
+            followed by (string name, int32 index) pairs
+
+  A value is a uint8 type tag followed by
+
+    bool    uint8
+    int     int32
+    double  the 8 bytes of the double
+    string  string
+    vector  uint32 size, followed by the values
+    map     uint8 map type, uint32 size, followed by (string, value) pairs
+*/
+
+namespace cppmicroservices {
+
+namespace {
+
+const uint32_t CacheMagic = 0x4d435355; // "USCM"
+const uint32_t CacheVersion = 2;
+
+enum ValueTag : uint8_t
+{
+  TagBool = 0,
+  TagInt,
+  TagDouble,
+  TagString,
+  TagVector,
+  TagMap
+};
+
+// 64-bit FNV-1a
+uint64_t Hash(const void* data, std::size_t size, uint64_t h)
+{
+  const auto* p = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    h = (h ^ p[i]) * 0x100000001b3ULL;
+  }
+  return h;
+}
+
+const uint64_t HashSeed = 0xcbf29ce484222325ULL;
+
+class Writer
+{
+public:
+  template<class T>
+  void Write(T value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be written");
+    m_Data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void WriteString(const std::string& str)
+  {
+    Write(static_cast<uint32_t>(str.size()));
+    m_Data.append(str);
+  }
+
+  void WriteValue(const Any& value)
+  {
+    const auto& type = value.Type();
+    if (type == typeid(bool)) {
+      Write(TagBool);
+      Write(static_cast<uint8_t>(ref_any_cast<bool>(value) ? 1 : 0));
+    } else if (type == typeid(int)) {
+      Write(TagInt);
+      Write(static_cast<int32_t>(ref_any_cast<int>(value)));
+    } else if (type == typeid(double)) {
+      Write(TagDouble);
+      Write(ref_any_cast<double>(value));
+    } else if (type == typeid(std::string)) {
+      Write(TagString);
+      WriteString(ref_any_cast<std::string>(value));
+    } else if (type == typeid(std::vector<Any>)) {
+      const auto& vec = ref_any_cast<std::vector<Any>>(value);
+      Write(TagVector);
+      Write(static_cast<uint32_t>(vec.size()));
+      for (auto const& v : vec) {
+        WriteValue(v);
+      }
+    } else if (type == typeid(AnyMap)) {
+      Write(TagMap);
+      WriteMap(ref_any_cast<AnyMap>(value));
+    } else {
+      throw std::invalid_argument(std::string("Cannot cache values of type ") +
+                                  value.Type().name());
+    }
+  }
+
+  void WriteMap(const AnyMap& map)
+  {
+    Write(static_cast<uint8_t>(map.GetType()));
+    Write(static_cast<uint32_t>(map.size()));
+    for (auto const& kv : map) {
+      WriteString(kv.first);
+      WriteValue(kv.second);
+    }
+  }
+
+  const std::string& GetData() const { return m_Data; }
+
+private:
+  std::string m_Data;
+};
+
+class Reader
+{
+public:
+  Reader(const char* data, std::size_t size)
+    : m_Pos(data)
+    , m_End(data + size)
+  {}
+
+  template<class T>
+  T Read()
+  {
+    T value;
+    std::memcpy(&value, Advance(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString()
+  {
+    auto size = Read<uint32_t>();
+    return std::string(Advance(size), size);
+  }
+
+  Any ReadValue()
+  {
+    switch (Read<uint8_t>()) {
+      case TagBool:
+        return Any(Read<uint8_t>() != 0);
+      case TagInt:
+        return Any(static_cast<int>(Read<int32_t>()));
+      case TagDouble:
+        return Any(Read<double>());
+      case TagString:
+        return Any(ReadString());
+      case TagVector: {
+        auto size = Read<uint32_t>();
+        Any any = std::vector<Any>();
+        auto& vec = ref_any_cast<std::vector<Any>>(any);
+        for (uint32_t i = 0; i < size; ++i) {
+          vec.push_back(ReadValue());
+        }
+        return any;
+      }
+      case TagMap: {
+        // Fill the map in place, Any would copy it otherwise.
+        Any any = AnyMap(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+        ReadMap(ref_any_cast<AnyMap>(any));
+        return any;
+      }
+      default:
+        throw std::runtime_error("Invalid value type");
+    }
+  }
+
+  void ReadMap(AnyMap& map)
+  {
+    auto type = Read<uint8_t>();
+    if (type > AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS) {
+      throw std::runtime_error("Invalid map type");
+    }
+    if (type != map.GetType()) {
+      map = AnyMap(static_cast<AnyMap::map_type>(type));
+    }
+    auto size = Read<uint32_t>();
+    for (uint32_t i = 0; i < size; ++i) {
+      auto key = ReadString();
+      map.emplace(std::move(key), ReadValue());
+    }
+  }
+
+  bool AtEnd() const { return m_Pos == m_End; }
+
+private:
+  const char* Advance(std::size_t n)
+  {
+    if (static_cast<std::size_t>(m_End - m_Pos) < n) {
+      throw std::runtime_error("Unexpected end of data");
+    }
+    const char* p = m_Pos;
+    m_Pos += n;
+    return p;
+  }
+
+  const char* m_Pos;
+  const char* const m_End;
+};
+
+}
+
+BundleMetadataCache::BundleMetadataCache(std::string dir)
+  : m_Dir(std::move(dir))
+{}
+
+bool BundleMetadataCache::Load(const std::string& location,
+                               Entry& entry) const
+{
+  try {
+    std::ifstream file(GetEntryPath(location), std::ios_base::binary);
+    if (!file) {
+      return false;
+    }
+    file.seekg(0, std::ios_base::end);
+    const auto length = file.tellg();
+    if (length < 0) {
+      return false;
+    }
+    std::vector<char> data(static_cast<std::size_t>(length));
+    file.seekg(0, std::ios_base::beg);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+      return false;
+    }
+
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    uint64_t fileId = 0;
+    if (!util::GetFileInfo(location, size, modifiedTime, fileId)) {
+      return false;
+    }
+
+    Reader reader(data.data(), data.size());
+    if (reader.Read<uint32_t>() != CacheMagic ||
+        reader.Read<uint32_t>() != CacheVersion ||
+        reader.ReadString() != location || reader.Read<uint64_t>() != size ||
+        reader.Read<int64_t>() != modifiedTime ||
+        reader.Read<uint64_t>() != fileId) {
+      return false;
+    }
+
+    Entry result;
+    auto manifestCount = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < manifestCount; ++i) {
+      auto symbolicName = reader.ReadString();
+      auto& headers = ref_any_cast<AnyMap>(
+        result.manifests
+          .emplace(std::move(symbolicName),
+                   AnyMap(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS))
+          .first->second);
+      reader.ReadMap(headers);
+    }
+    auto entryCount = reader.Read<uint32_t>();
+    result.entries.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+      auto name = reader.ReadString();
+      result.entries.emplace_back(std::move(name), reader.Read<int32_t>());
+    }
+    if (!reader.AtEnd() || result.manifests.empty()) {
+      return false;
+    }
+
+    entry = std::move(result);
+    return true;
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+bool BundleMetadataCache::Store(const std::string& location,
+                                const Entry& entry) const
+{
+  uint64_t size = 0;
+  int64_t modifiedTime = 0;
+  uint64_t fileId = 0;
+  if (!util::GetFileInfo(location, size, modifiedTime, fileId)) {
+    return false;
+  }
+
+  Writer writer;
+  try {
+    writer.Write(CacheMagic);
+    writer.Write(CacheVersion);
+    writer.WriteString(location);
+    writer.Write(size);
+    writer.Write(modifiedTime);
+    writer.Write(fileId);
+    writer.Write(static_cast<uint32_t>(entry.manifests.size()));
+    for (auto const& manifest : entry.manifests) {
+      writer.WriteString(manifest.first);
+      writer.WriteMap(ref_any_cast<AnyMap>(manifest.second));
+    }
+    writer.Write(static_cast<uint32_t>(entry.entries.size()));
+    for (auto const& e : entry.entries) {
+      writer.WriteString(e.first);
+      writer.Write(static_cast<int32_t>(e.second));
+    }
+  } catch (const std::exception&) {
+    return false;
+  }
+
+  try {
+    util::MakePath(m_Dir);
+  } catch (const std::exception&) {
+    return false;
+  }
+
+  // Write to a unique temporary file first and move it into place, so
+  // that readers never see a partially written entry.
+  static std::atomic<unsigned> tmpCounter{ 0 };
+  const std::string entryPath = GetEntryPath(location);
+  const std::string tmpPath =
+    entryPath + ".tmp" + std::to_string(tmpCounter++);
+  {
+    std::ofstream file(tmpPath, std::ios_base::binary | std::ios_base::trunc);
+    file.write(writer.GetData().data(),
+               static_cast<std::streamsize>(writer.GetData().size()));
+    if (!file) {
+      file.close();
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(tmpPath.c_str(), entryPath.c_str()) != 0) {
+    // std::rename does not replace existing files on all platforms.
+    std::remove(entryPath.c_str());
+    if (std::rename(tmpPath.c_str(), entryPath.c_str()) != 0) {
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string BundleMetadataCache::GetDirectory() const
+{
+  return m_Dir;
+}
+
+std::string BundleMetadataCache::GetEntryPath(
+  const std::string& location) const
+{
+  static const char hexDigits[] = "0123456789abcdef";
+  auto hash = Hash(location.data(), location.size(), HashSeed);
+  std::string name(16, '0');
+  for (auto i = name.size(); i > 0; --i, hash >>= 4) {
+    name[i - 1] = hexDigits[hash & 0xf];
+  }
+  return m_Dir + util::DIR_SEP + name + ".bin";
+}
+}
@@ -0,0 +1,94 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_BUNDLEMETADATACACHE_H
+#define CPPMICROSERVICES_BUNDLEMETADATACACHE_H
+
+#include "cppmicroservices/AnyMap.h"
+
+#include "BundleResourceContainer.h"
+
+#include <string>
+
+namespace cppmicroservices {
+
+/**
+ * An on-disk cache of the metadata read from bundle files.
+ *
+ * For each bundle file, the cache keeps the parsed manifests of all
+ * bundles in the file and the index of the embedded zip archive in a
+ * separate binary file in the cache directory. An entry is identified by
+ * the path, size, modification time and file serial number (inode) of the
+ * bundle file; it is ignored if any of them changed. The content of the
+ * bundle file is not hashed, so that loading an entry does not read the
+ * whole file.
+ *
+ * All functions are thread-safe. Entries are replaced atomically, so
+ * concurrent readers see either the old or the new entry.
+ */
+class BundleMetadataCache
+{
+public:
+  struct Entry
+  {
+    Entry()
+      : manifests(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS)
+    {}
+
+    /// The manifest headers, keyed by the symbolic name of the bundle.
+    AnyMap manifests;
+    BundleResourceContainer::EntryIndex entries;
+  };
+
+  /**
+   * @param dir The cache directory. It is created when the first entry
+   *        is stored.
+   */
+  explicit BundleMetadataCache(std::string dir);
+
+  /**
+   * Read the cached metadata of the bundle file at location.
+   *
+   * @return true if a valid entry for the current content of the file
+   *         exists, false otherwise.
+   */
+  bool Load(const std::string& location, Entry& entry) const;
+
+  /**
+   * Store the metadata of the bundle file at location, replacing an
+   * existing entry. Errors are reported with the return value only,
+   * because the cache is an optimization.
+   *
+   * @return true if the entry was written.
+   */
+  bool Store(const std::string& location, const Entry& entry) const;
+
+  std::string GetDirectory() const;
+
+private:
+  std::string GetEntryPath(const std::string& location) const;
+
+  const std::string m_Dir;
+};
+}
+
+#endif // CPPMICROSERVICES_BUNDLEMETADATACACHE_H
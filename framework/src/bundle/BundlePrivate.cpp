@@ -44,6 +44,7 @@
 #include "BundleArchive.h"
 #include "BundleContextPrivate.h"
 #include "BundleResourceContainer.h"
+#include "BundleTimings.h"
 #include "BundleUtils.h"
 #include "CoreBundleContext.h"
 #include "ServiceReferenceBasePrivate.h"
@@ -178,6 +179,8 @@ Bundle::State BundlePrivate::GetUpdatedState()
   if (state == Bundle::STATE_INSTALLED) {
     try {
       if (state == Bundle::STATE_INSTALLED) {
+        BundleTimings::Scope timing(
+          coreCtx->bundleTimings.get(), this, Framework::BundlePhase::Resolve);
         state = Bundle::STATE_RESOLVED;
         operation = OP_RESOLVING;
         coreCtx->listeners.BundleChanged(
@@ -452,6 +455,9 @@ std::exception_ptr BundlePrivate::Start0()
                                "Loading shared library for Bundle #" +
                                  util::ToString(id) + " (location=" + location +
                                  ")");
+          BundleTimings::Scope timing(coreCtx->bundleTimings.get(),
+                                      this,
+                                      Framework::BundlePhase::LoadLibrary);
           lib.Load(coreCtx->libraryLoadOptions);
           coreCtx->logger->Log(logservice::SeverityLevel::LOG_INFO,
                                "Finished loading shared library for Bundle #" +
@@ -498,6 +504,9 @@ std::exception_ptr BundlePrivate::Start0()
       }
 
       // get a BundleActivator instance
+      BundleTimings::Scope timing(coreCtx->bundleTimings.get(),
+                                  this,
+                                  Framework::BundlePhase::ActivatorStart);
       bactivator = std::unique_ptr<BundleActivator, DestroyActivatorHook>(
         createActivatorHook(), destroyActivatorHook);
       bactivator->Start(MakeBundleContext(ctx));
@@ -550,6 +559,9 @@ std::exception_ptr BundlePrivate::Start0()
   if (res == nullptr) {
     state = Bundle::STATE_ACTIVE;
     try {
+      BundleTimings::Scope timing(coreCtx->bundleTimings.get(),
+                                  this,
+                                  Framework::BundlePhase::StartedListeners);
       coreCtx->listeners.BundleChanged(BundleEvent(
         BundleEvent::BUNDLE_STARTED, MakeBundle(this->shared_from_this())));
     } catch (const cppmicroservices::SharedLibraryException& ex) {
@@ -631,6 +643,9 @@ BundlePrivate::BundlePrivate(CoreBundleContext* coreCtx,
       if (manifestRes) {
         BundleResourceStream manifestStream(manifestRes);
         try {
+          BundleTimings::Scope timing(coreCtx->bundleTimings.get(),
+                                      this,
+                                      Framework::BundlePhase::ParseManifest);
           bundleManifest.Parse(manifestStream);
         } catch (...) {
           throw std::runtime_error(
@@ -25,23 +25,41 @@
 #include "cppmicroservices/Bundle.h"
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleEvent.h"
+#include "cppmicroservices/BundleStartResult.h"
+#include "cppmicroservices/Constants.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/GetBundleContext.h"
+#include "cppmicroservices/detail/BundleResourceBuffer.h"
+#include "cppmicroservices/detail/Log.h"
 
 #include "cppmicroservices/util/Error.h"
 #include "cppmicroservices/util/String.h"
 
 #include "BundleContextPrivate.h"
+#include "BundleManifest.h"
+#include "BundleMetadataCache.h"
 #include "BundlePrivate.h"
 #include "BundleResourceContainer.h"
 #include "BundleStorage.h"
+#include "BundleTimings.h"
 #include "CoreBundleContext.h"
 #include "FrameworkPrivate.h"
+#include "Utils.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <functional>
+#include <istream>
 #include <map>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
 
 namespace {
 
@@ -70,8 +88,9 @@ BundleRegistry::~BundleRegistry() = default;
 
 void BundleRegistry::Init()
 {
-  bundles.v.insert(
-    std::make_pair(coreCtx->systemBundle->location, coreCtx->systemBundle));
+  auto l = bundles.Lock();
+  US_UNUSED(l);
+  InsertBundle(coreCtx->systemBundle->location, coreCtx->systemBundle);
 }
 
 void BundleRegistry::Clear()
@@ -79,6 +98,37 @@ void BundleRegistry::Clear()
   auto l = bundles.Lock();
   US_UNUSED(l);
   bundles.v.clear();
+  bundles.byId.clear();
+  bundles.bySymbolicName.clear();
+  bundlesSnapshot.Store(nullptr);
+}
+
+void BundleRegistry::InsertBundle(const std::string& location,
+                                  const std::shared_ptr<BundlePrivate>& bundle)
+{
+  bundles.v.insert(std::make_pair(location, bundle));
+  bundles.byId[bundle->id] = bundle;
+  bundles.bySymbolicName.insert(std::make_pair(bundle->symbolicName, bundle));
+  bundlesSnapshot.Store(nullptr);
+}
+
+void BundleRegistry::EraseBundle(BundleMap::iterator iter)
+{
+  auto bundle = iter->second;
+  bundles.v.erase(iter);
+
+  auto idIter = bundles.byId.find(bundle->id);
+  if (idIter != bundles.byId.end() && idIter->second == bundle) {
+    bundles.byId.erase(idIter);
+  }
+  auto range = bundles.bySymbolicName.equal_range(bundle->symbolicName);
+  for (auto nameIter = range.first; nameIter != range.second; ++nameIter) {
+    if (nameIter->second == bundle) {
+      bundles.bySymbolicName.erase(nameIter);
+      break;
+    }
+  }
+  bundlesSnapshot.Store(nullptr);
 }
 
 /*
@@ -142,6 +192,341 @@ std::vector<Bundle> BundleRegistry::Install(
   const std::string& location,
   BundlePrivate*,
   const cppmicroservices::AnyMap& bundleManifest)
+{
+  // Go through the metadata cache for bundle libraries which are not
+  // installed yet, unless the caller injects the manifests.
+  auto cache = coreCtx->metadataCache.get();
+  if (cache && bundleManifest.empty() &&
+      (bundles.Lock(), bundles.v.count(location) == 0)) {
+    auto prepared =
+      PrepareInstall(location, cache, coreCtx->bundleTimings.get());
+    if (prepared.resCont) {
+      return InstallLocation(location, prepared.manifests, prepared.resCont);
+    }
+  }
+  return InstallLocation(location, bundleManifest, nullptr);
+}
+
+std::vector<Bundle> BundleRegistry::Install(
+  const std::vector<std::string>& locations,
+  BundlePrivate*)
+{
+  CheckIllegalState();
+
+  // Only open the bundle files which are not installed yet, once.
+  std::vector<std::string> toPrepare;
+  {
+    std::unordered_set<std::string> seen;
+    auto l = bundles.Lock();
+    US_UNUSED(l);
+    for (auto const& location : locations) {
+      if (bundles.v.count(location) == 0 && seen.insert(location).second) {
+        toPrepare.push_back(location);
+      }
+    }
+  }
+
+  std::vector<PreparedInstall> prepared(toPrepare.size());
+  std::atomic<std::size_t> next(0);
+  auto cache = coreCtx->metadataCache.get();
+  auto timings = coreCtx->bundleTimings.get();
+  auto prepare = [&toPrepare, &prepared, &next, cache, timings]() {
+    for (std::size_t i = next++; i < toPrepare.size(); i = next++) {
+      prepared[i] = PrepareInstall(toPrepare[i], cache, timings);
+    }
+  };
+
+  RunConcurrently(
+    Constants::FRAMEWORK_BUNDLE_INSTALL_THREADS, toPrepare.size(), prepare);
+
+  std::unordered_map<std::string, PreparedInstall*> preparedByLocation;
+  for (std::size_t i = 0; i < toPrepare.size(); ++i) {
+    if (prepared[i].resCont) {
+      preparedByLocation.emplace(toPrepare[i], &prepared[i]);
+    }
+  }
+
+  // Install in the given order. Locations which could not be prepared are
+  // installed as usual, which reports their errors.
+  std::vector<Bundle> installedBundles;
+  for (auto const& location : locations) {
+    std::vector<Bundle> newBundles;
+    auto iter = preparedByLocation.find(location);
+    if (iter != preparedByLocation.end()) {
+      newBundles = InstallLocation(
+        location, iter->second->manifests, iter->second->resCont);
+      preparedByLocation.erase(iter);
+    } else {
+      newBundles = InstallLocation(
+        location, AnyMap(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS), nullptr);
+    }
+    installedBundles.insert(
+      installedBundles.end(), newBundles.begin(), newBundles.end());
+  }
+  return installedBundles;
+}
+
+void BundleRegistry::RunConcurrently(const std::string& threadCountProperty,
+                                     std::size_t maxThreads,
+                                     const std::function<void()>& work) const
+{
+#ifdef US_ENABLE_THREADING_SUPPORT
+  std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  const auto& props = coreCtx->frameworkProperties;
+  auto threads = props.find(threadCountProperty);
+  if (threads != props.end()) {
+    try {
+      threadCount =
+        static_cast<std::size_t>(std::max(any_cast<int>(threads->second), 1));
+    } catch (...) {
+      DIAG_LOG(*coreCtx->sink) << "Ignoring invalid value of "
+                               << threadCountProperty << ", using "
+                               << threadCount << " threads";
+    }
+  }
+  threadCount = std::min(threadCount, maxThreads);
+
+  // The calling thread does work too, so it makes progress even if no
+  // worker thread can be started.
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < threadCount; ++i) {
+    try {
+      workers.emplace_back(work);
+    } catch (const std::system_error&) {
+      break;
+    }
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+#else
+  US_UNUSED(threadCountProperty);
+  US_UNUSED(maxThreads);
+  work();
+#endif
+}
+
+namespace {
+
+// Reads the symbolic names listed in the bundle.start_dependencies header
+// of a bundle.
+std::vector<std::string> GetStartDependencies(const Bundle& bundle)
+{
+  std::vector<std::string> names;
+  auto const& headers = bundle.GetHeaders();
+  auto iter = headers.find(Constants::BUNDLE_STARTDEPENDENCIES);
+  if (iter == headers.end()) {
+    return names;
+  }
+
+  auto invalid = [&bundle]() {
+    return std::invalid_argument(
+      "The " + Constants::BUNDLE_STARTDEPENDENCIES + " header of bundle #" +
+      std::to_string(bundle.GetBundleId()) + " (" +
+      bundle.GetSymbolicName() +
+      ") must be a string or a list of strings");
+  };
+  auto const& value = iter->second;
+  if (value.Type() == typeid(std::string)) {
+    names.push_back(ref_any_cast<std::string>(value));
+  } else if (value.Type() == typeid(std::vector<Any>)) {
+    for (auto const& name : ref_any_cast<std::vector<Any>>(value)) {
+      if (name.Type() != typeid(std::string)) {
+        throw invalid();
+      }
+      names.push_back(ref_any_cast<std::string>(name));
+    }
+  } else {
+    throw invalid();
+  }
+  return names;
+}
+}
+
+std::vector<BundleStartResult> BundleRegistry::Start(
+  const std::vector<Bundle>& bundlesToStart,
+  uint32_t options)
+{
+  CheckIllegalState();
+
+  const std::size_t count = bundlesToStart.size();
+  std::vector<BundleStartResult> results(count);
+  std::unordered_map<std::string, std::vector<std::size_t>> indicesByName;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!bundlesToStart[i]) {
+      throw std::invalid_argument("Cannot start an invalid bundle");
+    }
+    results[i].bundle = bundlesToStart[i];
+    indicesByName[bundlesToStart[i].GetSymbolicName()].push_back(i);
+  }
+
+  // dependents[i] are the bundles waiting for bundle i to be started,
+  // pending[i] is the number of bundles which bundle i waits for.
+  std::vector<std::vector<std::size_t>> dependents(count);
+  std::vector<std::size_t> pending(count, 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    for (auto const& name : GetStartDependencies(bundlesToStart[i])) {
+      auto iter = indicesByName.find(name);
+      if (iter == indicesByName.end()) {
+        continue;
+      }
+      for (auto dependency : iter->second) {
+        if (dependency != i) {
+          dependents[dependency].push_back(i);
+          ++pending[i];
+        }
+      }
+    }
+  }
+
+  std::deque<std::size_t> ready;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (pending[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  // Reject cycles up front, they would leave bundles waiting forever.
+  {
+    std::vector<std::size_t> sorted(ready.begin(), ready.end());
+    auto remaining = pending;
+    for (std::size_t next = 0; next < sorted.size(); ++next) {
+      for (auto dependent : dependents[sorted[next]]) {
+        if (--remaining[dependent] == 0) {
+          sorted.push_back(dependent);
+        }
+      }
+    }
+    if (sorted.size() != count) {
+      std::string names;
+      for (std::size_t i = 0; i < count; ++i) {
+        if (remaining[i] != 0) {
+          names += (names.empty() ? "" : ", ") +
+                   bundlesToStart[i].GetSymbolicName();
+        }
+      }
+      throw std::invalid_argument(
+        "The start dependencies of the bundles " + names + " form a cycle");
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<bool> dependencyFailed(count, false);
+  std::size_t unfinished = count;
+  auto start = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      changed.wait(lock, [&] { return !ready.empty() || unfinished == 0; });
+      if (ready.empty()) {
+        return;
+      }
+      auto i = ready.front();
+      ready.pop_front();
+      bool skip = dependencyFailed[i];
+      lock.unlock();
+
+      auto& result = results[i];
+      if (skip) {
+        result.exception = std::make_exception_ptr(std::runtime_error(
+          "Bundle #" + std::to_string(result.bundle.GetBundleId()) + " (" +
+          result.bundle.GetSymbolicName() +
+          ") was not started because a start dependency failed to start"));
+      } else {
+        auto begin = std::chrono::steady_clock::now();
+        try {
+          result.bundle.Start(options);
+        } catch (...) {
+          result.exception = std::current_exception();
+        }
+        result.activationTime = std::chrono::steady_clock::now() - begin;
+      }
+
+      lock.lock();
+      for (auto dependent : dependents[i]) {
+        if (result.exception) {
+          dependencyFailed[dependent] = true;
+        }
+        if (--pending[dependent] == 0) {
+          ready.push_back(dependent);
+        }
+      }
+      --unfinished;
+      changed.notify_all();
+    }
+  };
+  RunConcurrently(Constants::FRAMEWORK_BUNDLE_START_THREADS, count, start);
+  return results;
+}
+
+BundleRegistry::PreparedInstall BundleRegistry::PrepareInstall(
+  const std::string& location,
+  const BundleMetadataCache* cache,
+  BundleTimings* timings)
+{
+  BundleTimings::Scope timing(
+    timings, location, Framework::BundlePhase::OpenResources);
+  PreparedInstall prepared;
+  try {
+    BundleMetadataCache::Entry cached;
+    if (cache && cache->Load(location, cached)) {
+      prepared.resCont = std::make_shared<BundleResourceContainer>(
+        location, cached.manifests, cached.entries);
+      prepared.manifests = std::move(cached.manifests);
+      return prepared;
+    }
+
+    auto resCont = std::make_shared<BundleResourceContainer>(
+      location, AnyMap(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
+
+    // Read the manifests the same way BundlePrivate does. Manifests which
+    // cannot be read are left to BundlePrivate, which reports the error.
+    for (auto const& symbolicName : resCont->GetTopLevelDirs()) {
+      BundleResourceContainer::Stat stat;
+      stat.filePath = symbolicName + "/manifest.json";
+      if (!resCont->GetStat(stat) || stat.isDir) {
+        continue;
+      }
+
+      detail::BundleResourceBuffer buffer(
+        resCont->GetData(stat.index),
+        static_cast<std::size_t>(stat.uncompressedSize),
+        std::ios_base::in);
+      std::istream manifestStream(&buffer);
+      BundleManifest manifest;
+      try {
+        manifest.Parse(manifestStream);
+      } catch (...) {
+        continue;
+      }
+      prepared.manifests.emplace(symbolicName, manifest.GetHeaders());
+    }
+
+    // Only cache bundle libraries where every bundle has a valid manifest,
+    // so that installing from the cache gives the same result.
+    if (cache && !prepared.manifests.empty() &&
+        prepared.manifests.size() == resCont->GetTopLevelDirs().size()) {
+      BundleMetadataCache::Entry entry;
+      entry.manifests = prepared.manifests;
+      entry.entries = resCont->GetEntryIndex();
+      cache->Store(location, entry);
+    }
+
+    if (OnlyContainsManifest(resCont)) {
+      resCont->CloseContainer();
+    }
+    prepared.resCont = std::move(resCont);
+  } catch (...) {
+    return PreparedInstall();
+  }
+  return prepared;
+}
+
+std::vector<Bundle> BundleRegistry::InstallLocation(
+  const std::string& location,
+  const cppmicroservices::AnyMap& bundleManifest,
+  const std::shared_ptr<BundleResourceContainer>& preparedContainer)
 {
   using namespace std::chrono_literals;
 
@@ -237,8 +622,14 @@ std::vector<Bundle> BundleRegistry::Install(
         });
 
         // Perform the install
-        auto resCont =
-          std::make_shared<BundleResourceContainer>(location, bundleManifest);
+        auto resCont = preparedContainer;
+        if (!resCont) {
+          BundleTimings::Scope timing(coreCtx->bundleTimings.get(),
+                                      location,
+                                      Framework::BundlePhase::OpenResources);
+          resCont =
+            std::make_shared<BundleResourceContainer>(location, bundleManifest);
+        }
         installedBundles = Install0(location, resCont, {}, bundleManifest);
       }
       return installedBundles;
@@ -314,6 +705,11 @@ std::vector<Bundle> BundleRegistry::Install0(
   std::vector<std::shared_ptr<BundleArchive>> barchives;
   std::unordered_set<std::string> exclude{ alreadyInstalled.begin(),
                                            alreadyInstalled.end() };
+  auto timings = coreCtx->bundleTimings.get();
+  BundleTimings::Clock::time_point installStart;
+  if (timings) {
+    installStart = BundleTimings::Clock::now();
+  }
   try {
     // Create a BundleArchive for each entry in the resource container... that is, top level entries
     // (symbolic names) in the zip file for the bundle at 'location'.
@@ -351,6 +747,9 @@ std::vector<Bundle> BundleRegistry::Install0(
     // that are returned, one for each BundlePrivate that's created.
     for (auto const& ba : barchives) {
       auto d = std::make_shared<BundlePrivate>(coreCtx, ba);
+      if (timings) {
+        timings->Record(d.get(), Framework::BundlePhase::Install, installStart);
+      }
       installedBundles.emplace_back(MakeBundle(d));
     }
 
@@ -360,7 +759,7 @@ std::vector<Bundle> BundleRegistry::Install0(
       auto l = bundles.Lock();
       US_UNUSED(l);
       for (auto& b : installedBundles) {
-        bundles.v.insert(std::make_pair(location, b.d));
+        InsertBundle(location, b.d);
       }
     }
 
@@ -388,7 +787,7 @@ void BundleRegistry::Remove(const std::string& location, long id)
   auto range = bundles.v.equal_range(location);
   for (auto iter = range.first; iter != range.second; ++iter) {
     if (iter->second->id == id) {
-      bundles.v.erase(iter);
+      EraseBundle(iter);
       return;
     }
   }
@@ -401,12 +800,8 @@ std::shared_ptr<BundlePrivate> BundleRegistry::GetBundle(long id) const
   auto l = bundles.Lock();
   US_UNUSED(l);
 
-  for (auto& m : bundles.v) {
-    if (m.second->id == id) {
-      return m.second;
-    }
-  }
-  return nullptr;
+  auto iter = bundles.byId.find(id);
+  return iter != bundles.byId.end() ? iter->second : nullptr;
 }
 
 std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles(
@@ -437,10 +832,10 @@ std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles(
   auto l = bundles.Lock();
   US_UNUSED(l);
 
-  for (auto& p : bundles.v) {
-    auto& b = p.second;
-    if (name == b->symbolicName && version == b->version) {
-      res.push_back(b);
+  auto range = bundles.bySymbolicName.equal_range(name);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (version == iter->second->version) {
+      res.push_back(iter->second);
     }
   }
 
@@ -449,15 +844,32 @@ std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles(
 
 std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles() const
 {
+  return *GetBundlesSnapshot();
+}
+
+std::shared_ptr<const std::vector<std::shared_ptr<BundlePrivate>>>
+BundleRegistry::GetBundlesSnapshot() const
+{
+  auto snapshot = bundlesSnapshot.Load();
+  if (snapshot) {
+    return snapshot;
+  }
+
   auto l = bundles.Lock();
   US_UNUSED(l);
-
-  std::vector<std::shared_ptr<BundlePrivate>> result;
-  std::transform(bundles.v.begin(),
-                 bundles.v.end(),
-                 std::back_inserter(result),
-                 [](const BundleMap::value_type& p) { return p.second; });
-  return result;
+  // Another thread may have rebuilt the snapshot in the meantime.
+  snapshot = bundlesSnapshot.Load();
+  if (!snapshot) {
+    auto result = std::make_shared<BundleList>();
+    result->reserve(bundles.v.size());
+    std::transform(bundles.v.begin(),
+                   bundles.v.end(),
+                   std::back_inserter(*result),
+                   [](const BundleMap::value_type& p) { return p.second; });
+    snapshot = std::move(result);
+    bundlesSnapshot.Store(snapshot);
+  }
+  return snapshot;
 }
 
 std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetActiveBundles()
@@ -466,12 +878,10 @@ std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetActiveBundles()
   CheckIllegalState();
   std::vector<std::shared_ptr<BundlePrivate>> result;
 
-  auto l = bundles.Lock();
-  US_UNUSED(l);
-  for (auto& b : bundles.v) {
-    auto s = b.second->state.load();
+  for (auto& b : *GetBundlesSnapshot()) {
+    auto s = b->state.load();
     if (s == Bundle::STATE_ACTIVE || s == Bundle::STATE_STARTING) {
-      result.push_back(b.second);
+      result.push_back(b);
     }
   }
   return result;
@@ -485,7 +895,9 @@ void BundleRegistry::Load()
   for (auto const& ba : bas) {
     try {
       auto impl = std::make_shared<BundlePrivate>(coreCtx, ba);
-      bundles.v.insert(std::make_pair(impl->location, impl));
+      auto bl = bundles.Lock();
+      US_UNUSED(bl);
+      InsertBundle(impl->location, impl);
     } catch (...) {
       ba->SetAutostartSetting(-1); // Do not start on launch
       std::cerr << "Failed to load bundle " << util::ToString(ba->GetBundleId())
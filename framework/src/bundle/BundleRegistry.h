@@ -26,10 +26,12 @@
 #include "cppmicroservices/AnyMap.h"
 #include "cppmicroservices/detail/Threads.h"
 #include <condition_variable>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "BundleResourceContainer.h"
@@ -39,9 +41,12 @@ namespace cppmicroservices {
 class CoreBundleContext;
 class Framework;
 class Bundle;
+class BundleMetadataCache;
+class BundleTimings;
 class BundlePrivate;
 class BundleVersion;
 struct BundleActivator;
+struct BundleStartResult;
 
 /**
  * Here we handle all the bundles that are known to the framework.
@@ -71,6 +76,37 @@ public:
     const cppmicroservices::AnyMap& bundleManifest = cppmicroservices::AnyMap(
       cppmicroservices::any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
 
+  /**
+   * Install several bundle libraries. The bundle files are opened and
+   * their manifests are read concurrently, the bundles are then installed
+   * on the calling thread in the order of <code>locations</code>.
+   *
+   * @param locations The locations to be installed
+   * @param caller The bundle performing the install
+   * @return A vector of bundles installed, in the order of
+   *         <code>locations</code>
+   */
+  std::vector<Bundle> Install(const std::vector<std::string>& locations,
+                              BundlePrivate* caller);
+
+  /**
+   * Start several bundles concurrently. A bundle is only started after
+   * the bundles named in its <code>bundle.start_dependencies</code>
+   * header which are part of <code>bundlesToStart</code> were started.
+   * Bundles depending on a bundle which failed to start are not started.
+   *
+   * @param bundlesToStart The bundles to be started
+   * @param options The options passed to Bundle::Start
+   * @return The result of starting each bundle, in the order of
+   *         <code>bundlesToStart</code>
+   * @throws std::invalid_argument If a bundle is invalid, has an invalid
+   *         start dependencies header, or if the start dependencies form
+   *         a cycle.
+   */
+  std::vector<BundleStartResult> Start(
+    const std::vector<Bundle>& bundlesToStart,
+    uint32_t options);
+
   /**
    * Remove bundle registration.
    *
@@ -115,6 +151,16 @@ public:
    */
   std::vector<std::shared_ptr<BundlePrivate>> GetBundles() const;
 
+  /**
+   * Get an immutable snapshot of all known bundles. Unless bundles were
+   * installed or uninstalled since the last call, this neither locks the
+   * registry nor copies the list.
+   *
+   * @return All bundles known at the time of the call.
+   */
+  std::shared_ptr<const std::vector<std::shared_ptr<BundlePrivate>>>
+  GetBundlesSnapshot() const;
+
   /**
    * Get all bundles currently in bundle state ACTIVE.
    *
@@ -133,11 +179,55 @@ public:
 
 private:
   using BundleMap = std::multimap<std::string, std::shared_ptr<BundlePrivate>>;
+  using BundleList = std::vector<std::shared_ptr<BundlePrivate>>;
 
   // don't allow copying the BundleRegistry.
   BundleRegistry(const BundleRegistry&) = delete;
   BundleRegistry& operator=(const BundleRegistry&) = delete;
 
+  /**
+   * A bundle library whose resource container was opened and whose
+   * manifests were read ahead of its installation.
+   */
+  struct PreparedInstall
+  {
+    std::shared_ptr<BundleResourceContainer> resCont;
+    /// Mapping of symbolic name to manifest, for the manifests which
+    /// could be read.
+    cppmicroservices::AnyMap manifests;
+
+    PreparedInstall()
+      : manifests(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS)
+    {}
+  };
+
+  /**
+   * Open the resource container of a bundle library and read the
+   * manifests of its bundles. This does not modify the registry and may
+   * be called concurrently.
+   *
+   * If <code>cache</code> is set, the manifests and the resource index
+   * are read from it if possible, without opening the container, and
+   * are stored in it otherwise. If <code>timings</code> is set, the time
+   * taken is recorded as Framework::BundlePhase::OpenResources.
+   *
+   * @return An empty resCont if the container could not be opened. The
+   *         error is reported when the location is installed.
+   */
+  static PreparedInstall PrepareInstall(const std::string& location,
+                                        const BundleMetadataCache* cache,
+                                        BundleTimings* timings);
+
+  /**
+   * Install a bundle library. If <code>preparedContainer</code> is set,
+   * it is used instead of opening a new resource container when the
+   * location is not installed yet.
+   */
+  std::vector<Bundle> InstallLocation(
+    const std::string& location,
+    const cppmicroservices::AnyMap& bundleManifest,
+    const std::shared_ptr<BundleResourceContainer>& preparedContainer);
+
   std::vector<Bundle> Install0(
     const std::string& location,
     const std::shared_ptr<BundleResourceContainer>& resCont,
@@ -146,6 +236,30 @@ private:
 
   void CheckIllegalState() const;
 
+  /**
+   * Run <code>work</code> on the calling thread and on additional worker
+   * threads. The number of threads is read from the framework property
+   * <code>threadCountProperty</code> and limited to <code>maxThreads</code>.
+   * Each invocation of <code>work</code> must keep taking tasks until
+   * there are none left.
+   */
+  void RunConcurrently(const std::string& threadCountProperty,
+                       std::size_t maxThreads,
+                       const std::function<void()>& work) const;
+
+  /**
+   * Add a bundle to the table of installed bundles and its indices.
+   * The caller must hold the lock of <code>bundles</code>.
+   */
+  void InsertBundle(const std::string& location,
+                    const std::shared_ptr<BundlePrivate>& bundle);
+
+  /**
+   * Remove a bundle from the table of installed bundles and its indices.
+   * The caller must hold the lock of <code>bundles</code>.
+   */
+  void EraseBundle(BundleMap::iterator iter);
+
   /** This function populates the res and alreadyInstalled vectors with the appropriate entries so
    * that they can be used by the Install0 call. This was extracted from Install() for convenience.
    *
@@ -198,7 +312,19 @@ private:
   struct : MultiThreaded<>
   {
     BundleMap v;
+    /// Index of the bundles in v by bundle id.
+    std::unordered_map<long, std::shared_ptr<BundlePrivate>> byId;
+    /// Index of the bundles in v by symbolic name.
+    std::unordered_multimap<std::string, std::shared_ptr<BundlePrivate>>
+      bySymbolicName;
   } bundles;
+
+  /**
+   * The values of <code>bundles.v</code>, in the same order, or nullptr
+   * if the table changed since the snapshot was taken. Only rebuilt and
+   * reset while holding the lock of <code>bundles</code>.
+   */
+  mutable detail::Atomic<std::shared_ptr<const BundleList>> bundlesSnapshot;
 };
 }
 
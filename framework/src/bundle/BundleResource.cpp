@@ -27,6 +27,7 @@
 
 #include "BundleArchive.h"
 #include "BundleResourceContainer.h"
+#include "BundleResourceReader.h"
 
 #include <atomic>
 #include <string>
@@ -123,7 +124,9 @@ BundleResource::BundleResource(
 
 void BundleResource::InitializeChildren()
 {
-  if (d->children.empty()) {
+  // Only directories have children. Files are not looked up in the
+  // entry index, which is built on first use.
+  if (d->children.empty() && d->stat.isDir) {
     d->archive->GetResourceContainer()->GetChildren(
       d->stat.filePath, true, d->children, d->childNodes);
   }
@@ -266,10 +269,10 @@ std::size_t BundleResource::Hash() const
                                   this->GetResourcePath());
 }
 
-std::unique_ptr<void, void (*)(void*)> BundleResource::GetData() const
+std::shared_ptr<const void> BundleResource::GetData() const
 {
   if (!IsValid()) {
-    return { nullptr, ::free };
+    return nullptr;
   }
 
   auto data = d->archive->GetResourceContainer()->GetData(d->stat.index);
@@ -283,6 +286,23 @@ std::unique_ptr<void, void (*)(void*)> BundleResource::GetData() const
   return data;
 }
 
+std::unique_ptr<detail::BundleResourceReader> BundleResource::GetReader() const
+{
+  if (!IsValid()) {
+    return nullptr;
+  }
+
+  auto reader = d->archive->GetResourceContainer()->GetReader(d->stat.index);
+  if (!reader) {
+    auto sink = GetBundleContext().GetLogSink();
+    DIAG_LOG(*sink) << "Error uncompressing resource data for "
+                    << this->GetResourcePath() << " from "
+                    << d->archive->GetBundleLocation();
+  }
+
+  return reader;
+}
+
 std::ostream& operator<<(std::ostream& os, const BundleResource& resource)
 {
   return os << resource.GetResourcePath();
@@ -22,9 +22,13 @@
 
 #include "cppmicroservices/detail/BundleResourceBuffer.h"
 
+#include "BundleResourceReader.h"
+
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <memory>
 
@@ -43,7 +47,7 @@ namespace detail {
 class BundleResourceBufferPrivate
 {
 public:
-  BundleResourceBufferPrivate(std::unique_ptr<void, void (*)(void*)> data,
+  BundleResourceBufferPrivate(std::shared_ptr<const void> data,
                               std::size_t size,
                               const char* begin,
                               std::ios_base::openmode mode)
@@ -51,20 +55,46 @@ public:
     , end(begin + size)
     , current(begin)
     , mode(mode)
-    , uncompressedData(reinterpret_cast<unsigned char*>(data.release()),
-                       data.get_deleter())
+    , data(std::move(data))
+    , size(size)
+    , chunkOffset(0)
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
     , pos(0)
 #endif
   {}
 
-  const char* const begin;
-  const char* const end;
+  /// Makes chunk the current chunk, which follows the previous one.
+  /// Returns false if the chunk is empty.
+  bool SetChunk(const char* chunk, std::size_t chunkSize);
+
+  /// Reads the next chunk from the reader. Returns false at the end of
+  /// the data.
+  bool NextChunk();
+
+  /// Moves the current position to offset, reading chunks from the reader
+  /// as necessary. Returns false if offset is beyond the end of the data.
+  bool Seek(std::size_t offset);
+
+  /// The offset of the current position in the data.
+  std::size_t Tell() const { return chunkOffset + (current - begin); }
+
+  // The current chunk of the data, which is all of the data unless it
+  // is read from a reader.
+  const char* begin;
+  const char* end;
   const char* current;
 
   const std::ios_base::openmode mode;
 
-  std::unique_ptr<unsigned char, void (*)(void*)> uncompressedData;
+  // Either owns the uncompressed data or keeps the memory it points
+  // into alive.
+  std::shared_ptr<const void> data;
+
+  // Reads the data chunk by chunk, if it is not available as a whole.
+  std::unique_ptr<BundleResourceReader> reader;
+  // The size of the data, and the offset of the current chunk in it.
+  std::size_t size;
+  std::size_t chunkOffset;
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   // records the stream position ignoring CR characters
@@ -72,41 +102,151 @@ public:
 #endif
 };
 
-BundleResourceBuffer::BundleResourceBuffer(
-  std::unique_ptr<void, void (*)(void*)> data,
+bool BundleResourceBufferPrivate::SetChunk(const char* chunk,
+                                           std::size_t chunkSize)
+{
+  chunkOffset += end - begin;
+  std::size_t available = std::min(chunkSize, size - chunkOffset);
+
+#ifdef REMOVE_LAST_NEWLINE_IN_TEXT_MODE
+  if (!(mode & std::ios_base::binary) && available > 0 &&
+      chunkOffset + chunkSize == size && chunk[available - 1] == '\n') {
+    --available;
+    --size;
+  }
+#endif
+
+  begin = chunk;
+  end = chunk + available;
+  current = begin;
+  return available > 0;
+}
+
+bool BundleResourceBufferPrivate::NextChunk()
+{
+  if (!reader) {
+    return false;
+  }
+  const char* chunk = nullptr;
+  std::size_t chunkSize = reader->Read(chunk);
+  return chunkSize > 0 && SetChunk(chunk, chunkSize);
+}
+
+bool BundleResourceBufferPrivate::Seek(std::size_t offset)
+{
+  if (offset > size) {
+    return false;
+  }
+  if (offset < chunkOffset) {
+    // The reader cannot go backwards.
+    reader->Rewind();
+    begin = end = current = nullptr;
+    chunkOffset = 0;
+  }
+  while (offset > chunkOffset + (end - begin)) {
+    if (!NextChunk() && offset > chunkOffset + (end - begin)) {
+      return false;
+    }
+  }
+  current = begin + (offset - chunkOffset);
+  return true;
+}
+
+namespace {
+
+std::unique_ptr<BundleResourceBufferPrivate> MakeBufferPrivate(
+  std::shared_ptr<const void> data,
   std::size_t _size,
   std::ios_base::openmode mode)
-  : d(nullptr)
 {
   assert(_size <
          static_cast<std::size_t>(std::numeric_limits<uint32_t>::max()));
 
-  auto* begin = reinterpret_cast<char*>(data.get());
+  auto* begin = static_cast<const char*>(data.get());
   std::size_t size = begin ? _size : 0;
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
-  if (begin != nullptr && !(mode & std::ios_base::binary) && begin[0] == '\r') {
+  if (size > 0 && !(mode & std::ios_base::binary) && begin[0] == '\r') {
     ++begin;
     --size;
   }
 #endif
 
 #ifdef REMOVE_LAST_NEWLINE_IN_TEXT_MODE
-  if (begin != nullptr && !(mode & std::ios_base::binary) &&
+  if (size > 0 && !(mode & std::ios_base::binary) &&
       begin[size - 1] == '\n') {
     --size;
   }
 #endif
 
-  d = std::make_unique<BundleResourceBufferPrivate>(
+  return std::make_unique<BundleResourceBufferPrivate>(
     std::move(data), size, begin, mode);
 }
+}
+
+BundleResourceBuffer::BundleResourceBuffer(
+  std::unique_ptr<void, void (*)(void*)> data,
+  std::size_t size,
+  std::ios_base::openmode mode)
+  : BundleResourceBuffer(std::shared_ptr<const void>(std::move(data)),
+                         size,
+                         mode)
+{}
+
+BundleResourceBuffer::BundleResourceBuffer(std::shared_ptr<const void> data,
+                                           std::size_t size,
+                                           std::ios_base::openmode mode)
+  : d(MakeBufferPrivate(std::move(data), size, mode))
+{}
+
+BundleResourceBuffer::BundleResourceBuffer(
+  std::unique_ptr<BundleResourceReader> reader,
+  std::size_t size,
+  std::ios_base::openmode mode)
+  : d(nullptr)
+{
+  const char* chunk = nullptr;
+  std::size_t chunkSize = reader ? reader->Read(chunk) : 0;
+
+  bool readAll = !reader || chunkSize >= size;
+#ifdef DATA_NEEDS_NEWLINE_CONVERSION
+  // Newlines are converted on the data as a whole.
+  readAll = readAll || !(mode & std::ios_base::binary);
+#endif
+
+  if (!readAll) {
+    d = std::make_unique<BundleResourceBufferPrivate>(
+      nullptr, 0, nullptr, mode);
+    d->reader = std::move(reader);
+    d->size = size;
+    d->SetChunk(chunk, chunkSize);
+  } else if (!reader || chunkSize >= size) {
+    std::shared_ptr<const void> data;
+    if (reader) {
+      data = std::shared_ptr<const void>(
+        std::shared_ptr<BundleResourceReader>(std::move(reader)), chunk);
+    }
+    d = MakeBufferPrivate(std::move(data), size, mode);
+  } else {
+    std::shared_ptr<char> data(static_cast<char*>(std::malloc(size)), ::free);
+    std::size_t dataSize = 0;
+    for (; data && chunkSize > 0 && chunkSize <= size - dataSize;
+         chunkSize = reader->Read(chunk)) {
+      std::memcpy(data.get() + dataSize, chunk, chunkSize);
+      dataSize += chunkSize;
+    }
+    if (dataSize != size) {
+      data.reset();
+    }
+    d = MakeBufferPrivate(std::move(data), size, mode);
+  }
+}
 
 BundleResourceBuffer::~BundleResourceBuffer() = default;
 
 BundleResourceBuffer::int_type BundleResourceBuffer::underflow()
 {
-  if (d->current == d->end)
+  if (d->current == d->end && !d->NextChunk())
     return traits_type::eof();
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
@@ -127,7 +267,7 @@ BundleResourceBuffer::int_type BundleResourceBuffer::underflow()
 
 BundleResourceBuffer::int_type BundleResourceBuffer::uflow()
 {
-  if (d->current == d->end)
+  if (d->current == d->end && !d->NextChunk())
     return traits_type::eof();
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
@@ -148,6 +288,19 @@ BundleResourceBuffer::int_type BundleResourceBuffer::uflow()
 
 BundleResourceBuffer::int_type BundleResourceBuffer::pbackfail(int_type ch)
 {
+  if (d->reader && d->current == d->begin && d->chunkOffset > 0) {
+    // The previous character is in the previous chunk.
+    const std::size_t offset = d->chunkOffset;
+    if (!d->Seek(offset - 1)) {
+      return traits_type::eof();
+    }
+    if (ch != traits_type::eof() && ch != *d->current) {
+      d->Seek(offset);
+      return traits_type::eof();
+    }
+    return traits_type::to_int_type(*d->current);
+  }
+
   int backOffset = -1;
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   if (!(d->mode & std::ios_base::binary)) {
@@ -167,10 +320,35 @@ BundleResourceBuffer::int_type BundleResourceBuffer::pbackfail(int_type ch)
   return traits_type::to_int_type(*d->current);
 }
 
+std::streamsize BundleResourceBuffer::xsgetn(char_type* s,
+                                             std::streamsize count)
+{
+#ifdef DATA_NEEDS_NEWLINE_CONVERSION
+  if (!(d->mode & std::ios_base::binary)) {
+    return std::streambuf::xsgetn(s, count);
+  }
+#endif
+
+  // Copy whole chunks instead of reading character by character.
+  std::streamsize copied = 0;
+  while (copied < count && (d->current != d->end || d->NextChunk())) {
+    const auto n =
+      std::min<std::streamsize>(count - copied, d->end - d->current);
+    std::memcpy(s + copied, d->current, static_cast<std::size_t>(n));
+    d->current += n;
+    copied += n;
+  }
+  return copied;
+}
+
 std::streamsize BundleResourceBuffer::showmanyc()
 {
   assert(d->current <= d->end);
 
+  if (d->reader) {
+    return d->current != d->end || d->NextChunk() ? d->end - d->current : 0;
+  }
+
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   std::streamsize ssize = 0;
   std::size_t chunkSize = d->end - d->current;
@@ -190,6 +368,23 @@ std::streambuf::pos_type BundleResourceBuffer::seekoff(
   std::ios_base::seekdir way,
   std::ios_base::openmode /*which*/)
 {
+  if (d->reader) {
+    std::streambuf::off_type base = 0;
+    if (way == std::ios_base::cur) {
+      base = static_cast<std::streambuf::off_type>(d->Tell());
+    } else if (way == std::ios_base::end) {
+      // The size is final once all chunks were read.
+      while (d->NextChunk()) {
+      }
+      base = static_cast<std::streambuf::off_type>(d->size);
+    }
+    if (base + off < 0 ||
+        !d->Seek(static_cast<std::size_t>(base + off))) {
+      return std::streambuf::pos_type(std::streambuf::off_type(-1));
+    }
+    return base + off;
+  }
+
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   std::streambuf::off_type step = 1;
   if (way == std::ios_base::beg) {
@@ -231,21 +426,26 @@ std::streambuf::pos_type BundleResourceBuffer::seekoff(
       }
     }
   } else {
+    if (off < d->begin - d->current || off > d->end - d->current) {
+      return std::streambuf::pos_type(std::streambuf::off_type(-1));
+    }
     d->current += off;
     d->pos = d->current - d->begin;
   }
   return d->pos;
 #else
+  const char* base = d->current;
   if (way == std::ios_base::beg) {
-    d->current = d->begin + off;
-    return off;
-  } else if (way == std::ios_base::cur) {
-    d->current += off;
-    return d->current - d->begin;
-  } else {
-    d->current = d->end + off;
-    return d->current - d->begin;
+    base = d->begin;
+  } else if (way == std::ios_base::end) {
+    base = d->end;
+  }
+  // Seeking outside of the resource fails and keeps the position.
+  if (off < d->begin - base || off > d->end - base) {
+    return std::streambuf::pos_type(std::streambuf::off_type(-1));
   }
+  d->current = base + off;
+  return d->current - d->begin;
 #endif
 }
 
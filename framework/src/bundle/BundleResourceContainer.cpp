@@ -21,6 +21,7 @@
 =============================================================================*/
 
 #include "BundleResourceContainer.h"
+#include "BundleResourceReader.h"
 #include "cppmicroservices/util/BundleObjFactory.h"
 #include "cppmicroservices/util/BundleObjFile.h"
 #include "cppmicroservices/util/FileSystem.h"
@@ -29,22 +30,219 @@
 #include "cppmicroservices/GetBundleContext.h"
 #include "cppmicroservices/detail/Log.h"
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 
 namespace cppmicroservices {
 
+namespace {
+
+/// Compares names ignoring the case of ASCII letters, like miniz does.
+bool LessIgnoreCase(std::string_view name1, std::string_view name2)
+{
+  auto toLower = [](char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  return std::lexicographical_compare(
+    name1.begin(),
+    name1.end(),
+    name2.begin(),
+    name2.end(),
+    [&toLower](char c1, char c2) { return toLower(c1) < toLower(c2); });
+}
+
+/// Inflates the deflated data of an entry to the heap and checks its size
+/// and CRC. Returns nullptr if the data is corrupt.
+std::shared_ptr<const void> InflateData(const unsigned char* entryData,
+                                        const mz_zip_archive_file_stat& stat)
+{
+  const auto size = static_cast<std::size_t>(stat.m_uncomp_size);
+  std::shared_ptr<void> data(std::malloc(size ? size : 1), ::free);
+  if (!data) {
+    return nullptr;
+  }
+  if (tinfl_decompress_mem_to_mem(data.get(),
+                                  size,
+                                  entryData,
+                                  static_cast<std::size_t>(stat.m_comp_size),
+                                  0) != size ||
+      mz_crc32(MZ_CRC32_INIT, static_cast<const mz_uint8*>(data.get()),
+               size) != stat.m_crc32) {
+    return nullptr;
+  }
+  return data;
+}
+
+/// A file pattern of FindNodes(), compiled once for matching many names.
+/// A name matches if it contains the parts of the pattern between the
+/// wildcards ('*') in the same order.
+class FilePattern
+{
+public:
+  explicit FilePattern(const std::string& pattern)
+    : m_MinLength(0)
+  {
+    std::size_t begin = 0;
+    while (begin < pattern.size()) {
+      std::size_t end = std::min(pattern.find('*', begin), pattern.size());
+      if (end > begin) {
+        m_Parts.push_back(pattern.substr(begin, end - begin));
+        m_MinLength += end - begin;
+      }
+      begin = end + 1;
+    }
+  }
+
+  bool Matches(std::string_view name) const
+  {
+    if (name.size() < m_MinLength) {
+      return false;
+    }
+    std::size_t pos = 0;
+    for (auto const& part : m_Parts) {
+      pos = name.find(part, pos);
+      if (pos == std::string_view::npos) {
+        return false;
+      }
+      pos += part.size();
+    }
+    return true;
+  }
+
+private:
+  std::vector<std::string> m_Parts;
+  std::size_t m_MinLength;
+};
+
+/// Reads data which was extracted as a whole in a single chunk.
+class MemoryReader : public detail::BundleResourceReader
+{
+public:
+  MemoryReader(std::shared_ptr<const void> data, std::size_t size)
+    : m_Data(std::move(data))
+    , m_Size(size)
+    , m_Read(false)
+  {}
+
+  std::size_t Read(const char*& chunk) override
+  {
+    if (m_Read) {
+      return 0;
+    }
+    m_Read = true;
+    chunk = static_cast<const char*>(m_Data.get());
+    return m_Size;
+  }
+
+  void Rewind() override { m_Read = false; }
+
+private:
+  const std::shared_ptr<const void> m_Data;
+  const std::size_t m_Size;
+  bool m_Read;
+};
+
+/// Inflates the deflated data of an entry in a memory mapped archive into
+/// the window of the inflater, one chunk at a time. Each reader has its
+/// own inflater state, so readers can be used concurrently.
+class InflatingReader : public detail::BundleResourceReader
+{
+public:
+  InflatingReader(std::shared_ptr<RawBundleResources> rawData,
+                  const unsigned char* entryData,
+                  const mz_zip_archive_file_stat& stat)
+    : m_RawData(std::move(rawData))
+    , m_EntryData(entryData)
+    , m_CompressedSize(static_cast<std::size_t>(stat.m_comp_size))
+    , m_UncompressedSize(static_cast<std::size_t>(stat.m_uncomp_size))
+    , m_Crc32(stat.m_crc32)
+    , m_Window(new mz_uint8[TINFL_LZ_DICT_SIZE])
+  {
+    Rewind();
+  }
+
+  std::size_t Read(const char*& chunk) override
+  {
+    if (m_Status != TINFL_STATUS_HAS_MORE_OUTPUT) {
+      return 0;
+    }
+
+    // The window is the dictionary of the inflater, it wraps around
+    // after TINFL_LZ_DICT_SIZE bytes.
+    mz_uint8* next = m_Window.get() + (m_Produced & (TINFL_LZ_DICT_SIZE - 1));
+    std::size_t inSize = m_CompressedSize - m_Consumed;
+    std::size_t outSize =
+      TINFL_LZ_DICT_SIZE - (m_Produced & (TINFL_LZ_DICT_SIZE - 1));
+    auto status = tinfl_decompress(&m_Inflater,
+                                   m_EntryData + m_Consumed,
+                                   &inSize,
+                                   m_Window.get(),
+                                   next,
+                                   &outSize,
+                                   0);
+    m_Consumed += inSize;
+    m_Produced += outSize;
+    m_CurrentCrc32 =
+      static_cast<mz_uint32>(mz_crc32(m_CurrentCrc32, next, outSize));
+
+    // All input is available, so anything but more output or the end
+    // of the data is an error.
+    if ((status != TINFL_STATUS_HAS_MORE_OUTPUT &&
+         status != TINFL_STATUS_DONE) ||
+        m_Produced > m_UncompressedSize ||
+        (status == TINFL_STATUS_DONE &&
+         (m_Produced != m_UncompressedSize || m_CurrentCrc32 != m_Crc32))) {
+      m_Status = TINFL_STATUS_FAILED;
+      return 0;
+    }
+
+    m_Status = status;
+    chunk = reinterpret_cast<const char*>(next);
+    return outSize;
+  }
+
+  void Rewind() override
+  {
+    tinfl_init(&m_Inflater);
+    m_Status = TINFL_STATUS_HAS_MORE_OUTPUT;
+    m_Consumed = 0;
+    m_Produced = 0;
+    m_CurrentCrc32 = MZ_CRC32_INIT;
+  }
+
+private:
+  // Keeps the memory mapped archive alive.
+  const std::shared_ptr<RawBundleResources> m_RawData;
+  const unsigned char* const m_EntryData;
+  const std::size_t m_CompressedSize;
+  const std::size_t m_UncompressedSize;
+  const mz_uint32 m_Crc32;
+
+  std::unique_ptr<mz_uint8[]> m_Window;
+  tinfl_decompressor m_Inflater;
+  tinfl_status m_Status;
+  std::size_t m_Consumed;
+  std::size_t m_Produced;
+  mz_uint32 m_CurrentCrc32;
+};
+}
+
 BundleResourceContainer::BundleResourceContainer(
   const std::string& location,
   const ManifestT& bundleManifest)
   : m_Location(location)
   , m_ZipArchive()
   , m_ObjFile()
+  , m_HasSortedEntries(false)
+  , m_CentralDirectoryScans(0)
+  , m_HasZipToplevelDirs(false)
+  , m_OnlyContainsManifests(true)
   , m_ZipFileMutex()
   , m_IsContainerOpen(false)
 {
@@ -61,7 +259,7 @@ BundleResourceContainer::BundleResourceContainer(
     // If bundleManifest is not empty, we should pull the top level entries out of it, store them in
     // m_SortedTopLevelDirs, and leave this object with m_IsContainerOpen=false, never reading the
     // zip info out.
-    for (auto b : bundleManifest) {
+    for (auto const& b : bundleManifest) {
       m_SortedToplevelDirs.insert(b.first);
     }
   } else {
@@ -69,6 +267,25 @@ BundleResourceContainer::BundleResourceContainer(
   }
 }
 
+BundleResourceContainer::BundleResourceContainer(
+  const std::string& location,
+  const ManifestT& bundleManifest,
+  const EntryIndex& entries)
+  : BundleResourceContainer(location, bundleManifest)
+{
+  for (auto const& entry : entries) {
+    m_SortedEntries.entries.push_back(
+      { static_cast<uint32_t>(m_SortedEntries.names.size()),
+        static_cast<uint32_t>(entry.first.size()),
+        entry.second });
+    m_SortedEntries.names += entry.first;
+    AddToplevelDir(entry.first);
+  }
+  SortEntries(m_SortedEntries);
+  m_HasSortedEntries = true;
+  m_HasZipToplevelDirs = true;
+}
+
 BundleResourceContainer::~BundleResourceContainer()
 {
   try {
@@ -88,14 +305,45 @@ std::vector<std::string> BundleResourceContainer::GetTopLevelDirs() const
                                    m_SortedToplevelDirs.end() };
 }
 
+BundleResourceContainer::EntryIndex BundleResourceContainer::GetEntryIndex()
+  const
+{
+  const auto& sorted = GetSortedEntries();
+  EntryIndex entries;
+  entries.reserve(sorted.entries.size());
+  for (auto const& entry : sorted.entries) {
+    entries.emplace_back(sorted.GetName(entry), entry.index);
+  }
+  return entries;
+}
+
+bool BundleResourceContainer::HasEntryIndex() const
+{
+  return m_HasSortedEntries.load(std::memory_order_acquire);
+}
+
+bool BundleResourceContainer::HasEntry(const std::string& name) const
+{
+  OpenAndInitializeContainer();
+  if (m_HasSortedEntries.load(std::memory_order_acquire)) {
+    return FindSortedEntry(name) >= 0;
+  }
+  return mz_zip_reader_locate_file(const_cast<mz_zip_archive*>(&m_ZipArchive),
+                                   name.c_str(),
+                                   nullptr,
+                                   MZ_ZIP_FLAG_CASE_SENSITIVE) >= 0;
+}
+
+bool BundleResourceContainer::OnlyContainsManifests() const
+{
+  OpenAndInitializeContainer();
+  return m_OnlyContainsManifests;
+}
+
 bool BundleResourceContainer::GetStat(BundleResourceContainer::Stat& stat)
 {
   OpenAndInitializeContainer();
-  int fileIndex =
-    mz_zip_reader_locate_file(const_cast<mz_zip_archive*>(&m_ZipArchive),
-                              stat.filePath.c_str(),
-                              nullptr,
-                              0);
+  int fileIndex = LocateEntry(stat.filePath);
   if (fileIndex >= 0) {
     return GetStat(fileIndex, stat);
   }
@@ -132,39 +380,152 @@ bool BundleResourceContainer::GetStat(int index,
   return false;
 }
 
-std::unique_ptr<void, void (*)(void*)> BundleResourceContainer::GetData(
-  int index)
+std::shared_ptr<const void> BundleResourceContainer::GetData(int index)
 {
-  OpenAndInitializeContainer();
+  auto rawData = OpenAndInitializeContainer();
+  if (rawData) {
+    // Entries are read from the mapped archive without touching the
+    // stream state, so they do not serialize on the zip stream lock.
+    mz_zip_archive_file_stat zipStat;
+    if (const unsigned char* entryData =
+          GetEntryData(*rawData, index, zipStat)) {
+      if (zipStat.m_method == 0) {
+        // Stored entries are handed out without copying.
+        return { std::move(rawData), entryData };
+      }
+      return InflateData(entryData, zipStat);
+    }
+  }
+
   std::unique_lock<std::mutex> l(m_ZipFileStreamMutex);
   void* data = mz_zip_reader_extract_to_heap(
     const_cast<mz_zip_archive*>(&m_ZipArchive), index, nullptr, 0);
   return { data, ::free };
 }
 
+std::unique_ptr<detail::BundleResourceReader>
+BundleResourceContainer::GetReader(int index)
+{
+  auto rawData = OpenAndInitializeContainer();
+  if (rawData) {
+    mz_zip_archive_file_stat zipStat;
+    const unsigned char* entryData = GetEntryData(*rawData, index, zipStat);
+    if (entryData && zipStat.m_method == 0) {
+      // Stored entries are read directly from the mapped archive.
+      const auto size = static_cast<std::size_t>(zipStat.m_uncomp_size);
+      return std::make_unique<MemoryReader>(
+        std::shared_ptr<const void>(std::move(rawData), entryData), size);
+    }
+    // Small entries are extracted as a whole, which needs less memory
+    // than the dictionary of an inflater.
+    if (entryData && zipStat.m_method == MZ_DEFLATED &&
+        zipStat.m_uncomp_size > TINFL_LZ_DICT_SIZE) {
+      return std::make_unique<InflatingReader>(
+        std::move(rawData), entryData, zipStat);
+    }
+  }
+
+  auto data = GetData(index);
+  if (!data) {
+    return nullptr;
+  }
+  mz_zip_archive_file_stat zipStat;
+  if (!mz_zip_reader_file_stat(&m_ZipArchive, index, &zipStat)) {
+    return nullptr;
+  }
+  return std::make_unique<MemoryReader>(
+    std::move(data), static_cast<std::size_t>(zipStat.m_uncomp_size));
+}
+
+const unsigned char* BundleResourceContainer::GetEntryData(
+  const RawBundleResources& rawData,
+  int index,
+  mz_zip_archive_file_stat& zipStat) const
+{
+  // Offsets and sizes of the zip local file header, see the zip file
+  // format specification (APPNOTE.TXT, section 4.3.7).
+  const std::size_t localHeaderSize = 30;
+  const std::size_t fileNameLengthOffset = 26;
+  const std::size_t extraFieldLengthOffset = 28;
+  const uint32_t localHeaderSignature = 0x04034b50;
+
+  if (index < 0) {
+    return nullptr;
+  }
+
+  // Reading the central directory does not touch the stream state.
+  if (!mz_zip_reader_file_stat(&m_ZipArchive, index, &zipStat) ||
+      zipStat.m_is_directory || zipStat.m_is_encrypted) {
+    return nullptr;
+  }
+  if (zipStat.m_method == 0
+        ? zipStat.m_comp_size != zipStat.m_uncomp_size
+        : zipStat.m_method != MZ_DEFLATED) {
+    return nullptr;
+  }
+
+  auto readLE = [](const unsigned char* p, std::size_t n) {
+    uint32_t value = 0;
+    for (std::size_t i = n; i > 0; --i) {
+      value = (value << 8) | p[i - 1];
+    }
+    return value;
+  };
+
+  const auto* archive = static_cast<const unsigned char*>(rawData.GetData());
+  const std::size_t archiveSize = rawData.GetSize();
+  const uint64_t headerOffset =
+    m_ZipArchive.m_archive_file_ofs + zipStat.m_local_header_ofs;
+  if (headerOffset + localHeaderSize > archiveSize) {
+    return nullptr;
+  }
+
+  const unsigned char* header = archive + headerOffset;
+  if (readLE(header, 4) != localHeaderSignature) {
+    return nullptr;
+  }
+
+  const uint64_t dataOffset = headerOffset + localHeaderSize +
+                              readLE(header + fileNameLengthOffset, 2) +
+                              readLE(header + extraFieldLengthOffset, 2);
+  if (dataOffset + zipStat.m_comp_size > archiveSize) {
+    return nullptr;
+  }
+
+  return archive + dataOffset;
+}
+
 void BundleResourceContainer::GetChildren(const std::string& resourcePath,
                                           bool relativePaths,
                                           std::vector<std::string>& names,
                                           std::vector<uint32_t>& indices) const
 {
-  auto iter = m_SortedEntries.find(std::make_pair(resourcePath, 0));
-  if (iter == m_SortedEntries.end()) {
+  const auto& sorted = GetSortedEntries();
+  auto iter = std::lower_bound(
+    sorted.entries.begin(),
+    sorted.entries.end(),
+    resourcePath,
+    [&sorted](const SortedEntries::Entry& entry, const std::string& name) {
+      return sorted.GetName(entry) < name;
+    });
+  if (iter == sorted.entries.end() || sorted.GetName(*iter) != resourcePath) {
     return;
   }
 
-  for (++iter; iter != m_SortedEntries.end(); ++iter) {
-    if (resourcePath.size() > iter->first.size())
+  // All entries starting with resourcePath follow it.
+  for (++iter; iter != sorted.entries.end(); ++iter) {
+    auto name = sorted.GetName(*iter);
+    if (name.compare(0, resourcePath.size(), resourcePath) != 0) {
       break;
-    if (iter->first.compare(0, resourcePath.size(), resourcePath) == 0) {
-      std::size_t pos = iter->first.find_first_of('/', resourcePath.size());
-      if (pos == std::string::npos || pos == iter->first.size() - 1) {
-        if (relativePaths) {
-          names.push_back(iter->first.substr(resourcePath.size()));
-        } else {
-          names.push_back(iter->first);
-        }
-        indices.push_back(iter->second);
+    }
+    std::size_t pos = name.find_first_of('/', resourcePath.size());
+    if (pos == std::string_view::npos || pos == name.size() - 1) {
+      if (relativePaths) {
+        names.emplace_back(name.substr(resourcePath.size()));
+      } else {
+        names.emplace_back(name);
       }
+      indices.push_back(iter->index);
     }
   }
 }
@@ -176,22 +537,71 @@ void BundleResourceContainer::FindNodes(
   bool recurse,
   std::vector<BundleResource>& resources) const
 {
-  std::vector<std::string> names;
-  std::vector<uint32_t> indices;
+  const FilePattern pattern(filePattern);
+  const auto& sorted = GetSortedEntries();
+  auto iter = std::lower_bound(
+    sorted.entries.begin(),
+    sorted.entries.end(),
+    path,
+    [&sorted](const SortedEntries::Entry& entry, const std::string& name) {
+      return sorted.GetName(entry) < name;
+    });
+  if (iter == sorted.entries.end() || sorted.GetName(*iter) != path) {
+    return;
+  }
 
-  OpenAndInitializeContainer();
+  struct Directory
+  {
+    std::string_view path;
+    int index;
+    bool matches;
+  };
+
+  // The directories below path containing the current entry. Like the
+  // entries below path, they are visited in sorted order, and reported
+  // after their contents. Entries in directories without an entry of
+  // their own are not visited.
+  std::vector<Directory> directories;
+  auto leaveDirectory = [&]() {
+    if (directories.back().matches) {
+      resources.push_back(BundleResource(directories.back().index, archive));
+    }
+    directories.pop_back();
+  };
 
-  this->GetChildren(path, true, names, indices);
+  // All entries starting with path follow it.
+  for (++iter; iter != sorted.entries.end(); ++iter) {
+    auto name = sorted.GetName(*iter);
+    if (name.compare(0, path.size(), path) != 0) {
+      break;
+    }
+    auto relativePath = name.substr(path.size());
+    while (!directories.empty() &&
+           relativePath.compare(0,
+                                directories.back().path.size(),
+                                directories.back().path) != 0) {
+      leaveDirectory();
+    }
 
-  for (std::size_t i = 0, s = names.size(); i < s; ++i) {
-    if (*names[i].rbegin() == '/' && recurse) {
-      this->FindNodes(
-        archive, path + names[i], filePattern, recurse, resources);
+    // Only direct children of path or of the current directory are
+    // visited. The name of a directory ends with '/'.
+    auto childName = relativePath.substr(
+      directories.empty() ? 0 : directories.back().path.size());
+    std::size_t pos = childName.find_first_of('/');
+    if (pos != std::string_view::npos && pos != childName.size() - 1) {
+      continue;
     }
-    if (this->Matches(names[i], filePattern)) {
-      resources.push_back(BundleResource(indices[i], archive));
+
+    bool matches = pattern.Matches(childName);
+    if (pos != std::string_view::npos && recurse) {
+      directories.push_back({ relativePath, iter->index, matches });
+    } else if (matches) {
+      resources.push_back(BundleResource(iter->index, archive));
     }
   }
+  while (!directories.empty()) {
+    leaveDirectory();
+  }
 }
 
 void BundleResourceContainer::InitMiniz() const
@@ -200,6 +610,10 @@ void BundleResourceContainer::InitMiniz() const
   // If this assumption is false, fall back to reading the meta-data in a
   // less than optimal way, in terms of memory utilization.
   std::shared_ptr<RawBundleResources> rawBundleResourceData;
+
+  // Sorting the central directory is the most expensive part of opening
+  // large archives. Lookups use the entry index instead.
+  const mz_uint flags = MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY;
   try {
     m_ObjFile = BundleObjFactory().CreateBundleFileObj(m_Location);
     rawBundleResourceData = m_ObjFile->GetRawBundleResourceContainer();
@@ -209,76 +623,195 @@ void BundleResourceContainer::InitMiniz() const
                     << ex.what();
   }
 
-  if (!rawBundleResourceData || !rawBundleResourceData->GetData() ||
-      !mz_zip_reader_init_mem(&m_ZipArchive,
-                              rawBundleResourceData->GetData(),
-                              rawBundleResourceData->GetSize(),
-                              0)) {
-    if (!mz_zip_reader_init_file(&m_ZipArchive, m_Location.c_str(), 0)) {
-      throw std::runtime_error("Could not init zip archive for bundle at " +
-                               m_Location);
+  if (rawBundleResourceData && rawBundleResourceData->GetData() &&
+      mz_zip_reader_init_mem(&m_ZipArchive,
+                             rawBundleResourceData->GetData(),
+                             rawBundleResourceData->GetSize(),
+                             flags)) {
+    m_RawData = std::move(rawBundleResourceData);
+  } else if (!mz_zip_reader_init_file(
+               &m_ZipArchive, m_Location.c_str(), flags)) {
+    throw std::runtime_error("Could not init zip archive for bundle at " +
+                             m_Location);
+  }
+}
+
+void BundleResourceContainer::SortEntries(SortedEntries& sorted)
+{
+  auto less = [&sorted](const SortedEntries::Entry& e1,
+                        const SortedEntries::Entry& e2) {
+    return sorted.GetName(e1) < sorted.GetName(e2);
+  };
+  if (!std::is_sorted(sorted.entries.begin(), sorted.entries.end(), less)) {
+    std::stable_sort(sorted.entries.begin(), sorted.entries.end(), less);
+  }
+  sorted.entries.erase(
+    std::unique(sorted.entries.begin(),
+                sorted.entries.end(),
+                [&sorted](const SortedEntries::Entry& e1,
+                          const SortedEntries::Entry& e2) {
+                  return sorted.GetName(e1) == sorted.GetName(e2);
+                }),
+    sorted.entries.end());
+  sorted.entries.shrink_to_fit();
+  sorted.names.shrink_to_fit();
+
+  sorted.folded.resize(sorted.entries.size());
+  for (std::size_t i = 0; i < sorted.folded.size(); ++i) {
+    sorted.folded[i] = static_cast<uint32_t>(i);
+  }
+  std::stable_sort(sorted.folded.begin(),
+                   sorted.folded.end(),
+                   [&sorted](uint32_t i1, uint32_t i2) {
+                     return LessIgnoreCase(sorted.GetName(sorted.entries[i1]),
+                                           sorted.GetName(sorted.entries[i2]));
+                   });
+}
+
+int BundleResourceContainer::FindSortedEntry(const std::string& name) const
+{
+  auto iter = std::lower_bound(
+    m_SortedEntries.entries.begin(),
+    m_SortedEntries.entries.end(),
+    name,
+    [this](const SortedEntries::Entry& entry, const std::string& n) {
+      return m_SortedEntries.GetName(entry) < n;
+    });
+  if (iter == m_SortedEntries.entries.end() ||
+      m_SortedEntries.GetName(*iter) != name) {
+    return -1;
+  }
+  return iter->index;
+}
+
+int BundleResourceContainer::FindSortedEntryIgnoreCase(
+  const std::string& name) const
+{
+  const auto& sorted = m_SortedEntries;
+  auto iter = std::lower_bound(
+    sorted.folded.begin(),
+    sorted.folded.end(),
+    name,
+    [&sorted](uint32_t i, const std::string& n) {
+      return LessIgnoreCase(sorted.GetName(sorted.entries[i]), n);
+    });
+  if (iter == sorted.folded.end() ||
+      LessIgnoreCase(name, sorted.GetName(sorted.entries[*iter]))) {
+    return -1;
+  }
+  return sorted.entries[*iter].index;
+}
+
+int BundleResourceContainer::LocateEntry(const std::string& name) const
+{
+  // Build the entry index once it pays off. Until then, entries are
+  // found by scanning the central directory.
+  const unsigned int maxCentralDirectoryScans = 16;
+  if (!m_HasSortedEntries.load(std::memory_order_acquire) &&
+      ++m_CentralDirectoryScans > maxCentralDirectoryScans) {
+    GetSortedEntries();
+  }
+
+  // An exact match is preferred over case variants of the name.
+  if (m_HasSortedEntries.load(std::memory_order_acquire)) {
+    int index = FindSortedEntry(name);
+    return index >= 0 ? index : FindSortedEntryIgnoreCase(name);
+  }
+
+  // The central directory is not sorted, so these are linear scans.
+  auto zipArchive = const_cast<mz_zip_archive*>(&m_ZipArchive);
+  int index = mz_zip_reader_locate_file(
+    zipArchive, name.c_str(), nullptr, MZ_ZIP_FLAG_CASE_SENSITIVE);
+  return index >= 0
+           ? index
+           : mz_zip_reader_locate_file(zipArchive, name.c_str(), nullptr, 0);
+}
+
+const BundleResourceContainer::SortedEntries&
+BundleResourceContainer::GetSortedEntries() const
+{
+  if (!m_HasSortedEntries.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(m_ZipFileMutex);
+    if (!m_HasSortedEntries.load(std::memory_order_relaxed)) {
+      OpenAndInitializeContainer_unlocked();
+      InitSortedEntries();
+      m_HasSortedEntries.store(true, std::memory_order_release);
     }
   }
+  return m_SortedEntries;
 }
 
 void BundleResourceContainer::InitSortedEntries() const
 {
   mz_uint numFiles =
     mz_zip_reader_get_num_files(const_cast<mz_zip_archive*>(&m_ZipArchive));
+  m_SortedEntries.entries.reserve(numFiles);
   for (mz_uint fileIndex = 0; fileIndex < numFiles; ++fileIndex) {
     char fileName[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
-    if (mz_zip_reader_get_filename(&m_ZipArchive,
-                                   fileIndex,
-                                   fileName,
-                                   MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE)) {
-      std::string strFileName = fileName;
-      m_SortedEntries.insert(std::make_pair(strFileName, fileIndex));
-      std::size_t pos = strFileName.find_first_of('/');
-      if (pos != std::string::npos) {
-        m_SortedToplevelDirs.insert(strFileName.substr(0, pos));
-      }
+    if (mz_uint size = mz_zip_reader_get_filename(
+          &m_ZipArchive, fileIndex, fileName, sizeof fileName)) {
+      m_SortedEntries.entries.push_back(
+        { static_cast<uint32_t>(m_SortedEntries.names.size()),
+          size - 1,
+          static_cast<int>(fileIndex) });
+      m_SortedEntries.names.append(fileName, size - 1);
     }
   }
+  SortEntries(m_SortedEntries);
 }
 
-bool BundleResourceContainer::Matches(const std::string& name,
-                                      const std::string& filePattern) const
+void BundleResourceContainer::AddToplevelDir(std::string_view name) const
 {
-  // short-cut
-  if (filePattern == "*") {
-    return true;
+  std::size_t pos = name.find_first_of('/');
+  if (pos == std::string_view::npos) {
+    return;
   }
-
-  std::stringstream ss(filePattern);
-  std::string tok;
-  std::size_t pos = 0;
-  while (std::getline(ss, tok, '*')) {
-    std::size_t index = name.find(tok, pos);
-    if (index == std::string::npos) {
-      return false;
-    }
-    pos = index + tok.size();
+  m_SortedToplevelDirs.insert(std::string(name.substr(0, pos)));
+  auto child = name.substr(pos + 1);
+  if (!child.empty() && child != "manifest.json") {
+    m_OnlyContainsManifests = false;
   }
-  return true;
 }
 
-void BundleResourceContainer::OpenAndInitializeContainer() const
+std::shared_ptr<RawBundleResources>
+BundleResourceContainer::OpenAndInitializeContainer() const
 {
   std::lock_guard<std::mutex> lock(m_ZipFileMutex);
+  return OpenAndInitializeContainer_unlocked();
+}
+
+std::shared_ptr<RawBundleResources>
+BundleResourceContainer::OpenAndInitializeContainer_unlocked() const
+{
   if (!m_IsContainerOpen) {
     InitMiniz();
 
-    InitSortedEntries();
+    // The top-level directories and the entry index are kept when the
+    // container is closed, and may have been read from the bundle
+    // metadata cache.
+    if (!m_HasZipToplevelDirs) {
+      mz_uint numFiles = mz_zip_reader_get_num_files(&m_ZipArchive);
+      for (mz_uint fileIndex = 0; fileIndex < numFiles; ++fileIndex) {
+        char fileName[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
+        if (mz_uint size = mz_zip_reader_get_filename(
+              &m_ZipArchive, fileIndex, fileName, sizeof fileName)) {
+          AddToplevelDir(std::string_view(fileName, size - 1));
+        }
+      }
+      m_HasZipToplevelDirs = true;
+    }
     if (m_SortedToplevelDirs.empty()) {
       // This is not a file containing a valid bundle
       // so make sure we clean up and close the file handle.
       mz_zip_reader_end(&m_ZipArchive);
       m_ObjFile.reset();
+      m_RawData.reset();
       throw std::runtime_error("Invalid zip archive layout for bundle at " +
                                m_Location);
     }
     m_IsContainerOpen = true;
   }
+  return m_RawData;
 }
 
 void BundleResourceContainer::CloseContainer()
@@ -287,6 +820,8 @@ void BundleResourceContainer::CloseContainer()
   if (m_IsContainerOpen) {
     mz_zip_reader_end(&m_ZipArchive);
     m_ObjFile.reset();
+    // Data handed out for stored entries keeps the mapping alive.
+    m_RawData.reset();
     m_IsContainerOpen = false;
   }
 }
@@ -28,11 +28,13 @@
 
 #include "miniz.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cppmicroservices {
@@ -40,13 +42,27 @@ namespace cppmicroservices {
 struct BundleArchive;
 class BundleResource;
 
+namespace detail {
+class BundleResourceReader;
+}
+
 class BundleResourceContainer
   : public std::enable_shared_from_this<BundleResourceContainer>
 {
 
 public:
   using ManifestT = cppmicroservices::AnyMap;
+  /// The names of all entries in the zip archive with their indices.
+  using EntryIndex = std::vector<std::pair<std::string, int>>;
+
   BundleResourceContainer(const std::string& location, const ManifestT&);
+
+  /// Creates a container for an injected manifest together with a
+  /// previously read entry index (see GetEntryIndex()), so that opening
+  /// the zip archive later does not need to rebuild the index.
+  BundleResourceContainer(const std::string& location,
+                          const ManifestT&,
+                          const EntryIndex& entries);
   ~BundleResourceContainer();
 
   struct Stat
@@ -73,16 +89,62 @@ public:
 
   std::vector<std::string> GetTopLevelDirs() const;
 
+  /// Get the names and indices of all entries, sorted by name.
+  /// Opens the zip archive and builds the entry index if necessary.
+  EntryIndex GetEntryIndex() const;
+
+  /// Returns true once the entry index was built.
+  bool HasEntryIndex() const;
+
+  /// Returns true if the zip archive contains an entry with exactly the
+  /// given name. This does not build the entry index.
+  bool HasEntry(const std::string& name) const;
+
+  /// Returns true if the top-level directories of the zip archive contain
+  /// nothing but a manifest.json file. This does not build the entry index.
+  bool OnlyContainsManifests() const;
+
+  /// Looks up the entry stat.filePath. Names are matched ignoring the
+  /// case of ASCII letters, preferring an exact match.
   bool GetStat(Stat& stat);
   bool GetStat(int index, Stat& stat);
 
-  std::unique_ptr<void, void (*)(void*)> GetData(int index);
-
+  /**
+   * Get the uncompressed data of an entry.
+   *
+   * Entries which are stored without compression in a memory mapped
+   * bundle are not copied: the returned pointer refers to the mapping
+   * and keeps it alive. All other entries are extracted to the heap.
+   * Entries of a memory mapped bundle are extracted without locking,
+   * so that several threads can extract resources concurrently.
+   *
+   * @param index The index of the entry.
+   * @return The data or <code>nullptr</code> if it could not be read.
+   */
+  std::shared_ptr<const void> GetData(int index);
+
+  /**
+   * Get a reader for the uncompressed data of an entry.
+   *
+   * Large compressed entries of a memory mapped bundle are inflated
+   * incrementally by the reader. The data of all other entries is
+   * obtained from GetData().
+   *
+   * @param index The index of the entry.
+   * @return The reader or <code>nullptr</code> if the data could not be
+   *         read.
+   */
+  std::unique_ptr<detail::BundleResourceReader> GetReader(int index);
+
+  /// Get the direct children of the directory entry resourcePath.
+  /// The entry index is built the first time this is called.
   void GetChildren(const std::string& resourcePath,
                    bool relativePaths,
                    std::vector<std::string>& names,
                    std::vector<uint32_t>& indices) const;
 
+  /// Find the entries below the directory entry path whose names match
+  /// filePattern, in a single pass over the entry index.
   void FindNodes(const std::shared_ptr<const BundleArchive>& archive,
                  const std::string& path,
                  const std::string& filePattern,
@@ -96,20 +158,53 @@ public:
   void CloseContainer();
 
 private:
-  using NameIndexPair = std::pair<std::string, int>;
-
-  struct PairComp
+  /// The entry names sorted by name, backed by a single string pool.
+  struct SortedEntries
   {
-    inline bool operator()(const NameIndexPair& p1,
-                           const NameIndexPair& p2) const
+    struct Entry
     {
-      return p1.first < p2.first;
+      uint32_t nameOffset;
+      uint32_t nameLength;
+      int index;
+    };
+
+    std::string_view GetName(const Entry& entry) const
+    {
+      return { names.data() + entry.nameOffset, entry.nameLength };
     }
+
+    std::string names;
+    std::vector<Entry> entries;
+    /// Positions in entries, sorted by name ignoring case.
+    std::vector<uint32_t> folded;
   };
 
+  /// Sort the entries by name and remove entries with duplicate names,
+  /// keeping the first one. Then sort their positions by name ignoring
+  /// case.
+  static void SortEntries(SortedEntries& sorted);
+
+  /// Returns the entry index, building it from the zip archive on
+  /// first use. This function is thread-safe.
+  const SortedEntries& GetSortedEntries() const;
+
   void InitSortedEntries() const;
 
-  bool Matches(const std::string& name, const std::string& filePattern) const;
+  /// Returns the index of the entry with exactly the given name in the
+  /// entry index, or -1.
+  int FindSortedEntry(const std::string& name) const;
+
+  /// Returns the index of an entry whose name equals the given name
+  /// ignoring case in the entry index, or -1.
+  int FindSortedEntryIgnoreCase(const std::string& name) const;
+
+  /// Returns the index of the entry with the given name, ignoring case,
+  /// or -1. Until the entry index was built, this scans the central
+  /// directory.
+  int LocateEntry(const std::string& name) const;
+
+  /// Add the top-level directory of the entry name.
+  void AddToplevelDir(std::string_view name) const;
 
   /// Initialize miniz with the resource zip file information.
   /// throws std::runtime_error if the underlying zip file cannot be opened or read.
@@ -117,19 +212,41 @@ private:
 
   /// Opens the zip file so that data can be accessed.
   /// This function is thread-safe.
+  /// Returns the memory the zip archive is read from, or nullptr if
+  /// it is read through a file stream.
   /// Throws std::runtime_error if the underlying zip file cannot be opened.
-  void OpenAndInitializeContainer() const;
+  std::shared_ptr<RawBundleResources> OpenAndInitializeContainer() const;
+  std::shared_ptr<RawBundleResources> OpenAndInitializeContainer_unlocked()
+    const;
+
+  /// Returns a pointer to the stored or deflated data of an entry in
+  /// rawData and its statistics in zipStat, or nullptr if the entry
+  /// cannot be referenced directly.
+  const unsigned char* GetEntryData(const RawBundleResources& rawData,
+                                    int index,
+                                    mz_zip_archive_file_stat& zipStat) const;
 
   const std::string m_Location;
   mutable mz_zip_archive m_ZipArchive;
   mutable std::unique_ptr<BundleObjFile> m_ObjFile;
+  // The memory mapped zip archive, if the archive is read from memory.
+  // Data handed out for stored entries shares ownership of it.
+  mutable std::shared_ptr<RawBundleResources> m_RawData;
+
+  // Built on demand, because most bundles only read their manifest.
+  mutable SortedEntries m_SortedEntries;
+  mutable std::atomic<bool> m_HasSortedEntries;
+  mutable std::atomic<unsigned int> m_CentralDirectoryScans;
 
-  mutable std::set<NameIndexPair, PairComp> m_SortedEntries;
   mutable std::set<std::string> m_SortedToplevelDirs;
+  // Set after the top-level directories of the zip archive were read.
+  mutable bool m_HasZipToplevelDirs;
+  mutable bool m_OnlyContainsManifests;
 
   // This is used to synchronize miniz file stream API calls.
   // Working with file streams is stateful (e.g. current read position)
-  // and hence not thread-safe.
+  // and hence not thread-safe. Memory mapped bundles are read without
+  // it.
   mutable std::mutex m_ZipFileStreamMutex;
 
   // Synchronize opening/closing the underlying zip file. Only one thread
@@ -0,0 +1,59 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_BUNDLERESOURCEREADER_H
+#define CPPMICROSERVICES_BUNDLERESOURCEREADER_H
+
+#include <cstddef>
+
+namespace cppmicroservices {
+
+namespace detail {
+
+/**
+ * Reads the uncompressed data of a bundle resource in chunks, so that
+ * large resources can be streamed without extracting them as a whole.
+ */
+class BundleResourceReader
+{
+public:
+  virtual ~BundleResourceReader() = default;
+
+  /**
+   * Reads the next chunk of data.
+   *
+   * @param chunk Set to the start of the chunk, which stays valid until
+   *        the next call to Read() or Rewind().
+   * @return The size of the chunk, or 0 at the end of the data and if
+   *         the data could not be read.
+   */
+  virtual std::size_t Read(const char*& chunk) = 0;
+
+  /// Start reading from the beginning of the data again.
+  virtual void Rewind() = 0;
+};
+
+} // namespace detail
+
+} // namespace cppmicroservices
+
+#endif // CPPMICROSERVICES_BUNDLERESOURCEREADER_H
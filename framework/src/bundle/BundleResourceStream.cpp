@@ -24,6 +24,8 @@
 
 #include "cppmicroservices/BundleResource.h"
 
+#include "BundleResourceReader.h"
+
 // 'this' used in base member initializer list
 US_MSVC_PUSH_DISABLE_WARNING(4355)
 
@@ -31,7 +33,7 @@ namespace cppmicroservices {
 
 BundleResourceStream::BundleResourceStream(const BundleResource& resource,
                                            std::ios_base::openmode mode)
-  : BundleResourceBuffer(resource.GetData(),
+  : BundleResourceBuffer(resource.GetReader(),
                          resource.GetSize(),
                          mode | std::ios_base::in)
   , std::istream(this)
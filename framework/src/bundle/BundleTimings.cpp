@@ -0,0 +1,177 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "BundleTimings.h"
+
+#include "cppmicroservices/Any.h"
+
+#include "BundlePrivate.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace cppmicroservices {
+
+namespace {
+
+const char* GetPhaseName(Framework::BundlePhase phase)
+{
+  switch (phase) {
+    case Framework::BundlePhase::OpenResources:
+      return "OpenResources";
+    case Framework::BundlePhase::Install:
+      return "Install";
+    case Framework::BundlePhase::ParseManifest:
+      return "ParseManifest";
+    case Framework::BundlePhase::Resolve:
+      return "Resolve";
+    case Framework::BundlePhase::LoadLibrary:
+      return "LoadLibrary";
+    case Framework::BundlePhase::ActivatorStart:
+      return "ActivatorStart";
+    case Framework::BundlePhase::StartedListeners:
+      return "StartedListeners";
+  }
+  return "Unknown";
+}
+}
+
+BundleTimings::Scope::Scope(BundleTimings* timings,
+                            const BundlePrivate* bundle,
+                            Framework::BundlePhase phase)
+  : timings(timings)
+  , bundle(bundle)
+  , location(nullptr)
+  , phase(phase)
+{
+  if (timings) {
+    start = Clock::now();
+  }
+}
+
+BundleTimings::Scope::Scope(BundleTimings* timings,
+                            const std::string& location,
+                            Framework::BundlePhase phase)
+  : timings(timings)
+  , bundle(nullptr)
+  , location(&location)
+  , phase(phase)
+{
+  if (timings) {
+    start = Clock::now();
+  }
+}
+
+BundleTimings::Scope::~Scope()
+{
+  if (timings) {
+    if (bundle) {
+      timings->Record(bundle, phase, start);
+    } else {
+      timings->Record(*location, phase, start);
+    }
+  }
+}
+
+void BundleTimings::Record(const BundlePrivate* bundle,
+                           Framework::BundlePhase phase,
+                           Clock::time_point start)
+{
+  Framework::BundlePhaseTiming timing;
+  timing.bundleId = bundle->id;
+  timing.symbolicName = bundle->symbolicName;
+  timing.location = bundle->location;
+  timing.phase = phase;
+  timing.start = start;
+  timing.duration = Clock::now() - start;
+  Record(std::move(timing));
+}
+
+void BundleTimings::Record(const std::string& location,
+                           Framework::BundlePhase phase,
+                           Clock::time_point start)
+{
+  Framework::BundlePhaseTiming timing;
+  timing.location = location;
+  timing.phase = phase;
+  timing.start = start;
+  timing.duration = Clock::now() - start;
+  Record(std::move(timing));
+}
+
+void BundleTimings::Record(Framework::BundlePhaseTiming&& timing)
+{
+  timing.thread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex);
+  timings.push_back(std::move(timing));
+}
+
+std::vector<Framework::BundlePhaseTiming> BundleTimings::GetTimings() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return timings;
+}
+
+void BundleTimings::WriteTrace(std::ostream& os) const
+{
+  using Micros = std::chrono::duration<double, std::micro>;
+
+  auto events = GetTimings();
+  Clock::time_point origin;
+  if (!events.empty()) {
+    origin = std::min_element(events.begin(),
+                              events.end(),
+                              [](const Framework::BundlePhaseTiming& a,
+                                 const Framework::BundlePhaseTiming& b) {
+                                return a.start < b.start;
+                              })
+               ->start;
+  }
+
+  // Number the threads in the order they first appear.
+  std::map<std::thread::id, std::size_t> threadIds;
+  auto flags = os.flags();
+  os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    auto const& event = events[i];
+    auto tid = threadIds.emplace(event.thread, threadIds.size() + 1).first;
+    os << (i ? ",\n" : "\n") << "{\"name\":\"" << GetPhaseName(event.phase)
+       << "\",\"cat\":\"bundle\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+       << tid->second
+       << ",\"ts\":" << Micros(event.start - origin).count()
+       << ",\"dur\":" << Micros(event.duration).count() << ",\"args\":{";
+    if (event.bundleId >= 0) {
+      os << "\"bundle.id\":" << event.bundleId << ",\"bundle.symbolic_name\":";
+      any_value_to_json(os, event.symbolicName, 0, 0);
+      os << ",";
+    }
+    os << "\"bundle.location\":";
+    any_value_to_json(os, event.location, 0, 0);
+    os << "}}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  os.flags(flags);
+}
+}
@@ -0,0 +1,108 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_BUNDLETIMINGS_H
+#define CPPMICROSERVICES_BUNDLETIMINGS_H
+
+#include "cppmicroservices/Framework.h"
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cppmicroservices {
+
+class BundlePrivate;
+
+/**
+ * Records the time bundles spend in the phases of being installed and
+ * started. Only created if Constants::FRAMEWORK_BUNDLE_TIMING is enabled,
+ * the code measuring a phase checks for a null BundleTimings first.
+ *
+ * All functions are thread-safe.
+ */
+class BundleTimings
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Measures a phase of a bundle, or of a bundle file, from its
+   * construction to its destruction. Does nothing if <code>timings</code>
+   * is null.
+   */
+  class Scope
+  {
+  public:
+    Scope(BundleTimings* timings,
+          const BundlePrivate* bundle,
+          Framework::BundlePhase phase);
+    Scope(BundleTimings* timings,
+          const std::string& location,
+          Framework::BundlePhase phase);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    BundleTimings* const timings;
+    const BundlePrivate* const bundle;
+    const std::string* const location;
+    const Framework::BundlePhase phase;
+    Clock::time_point start;
+  };
+
+  /**
+   * Record that <code>bundle</code> spent the time from <code>start</code>
+   * until now in <code>phase</code>.
+   */
+  void Record(const BundlePrivate* bundle,
+              Framework::BundlePhase phase,
+              Clock::time_point start);
+
+  /**
+   * Record a phase of a bundle file which is not associated with a
+   * bundle yet.
+   */
+  void Record(const std::string& location,
+              Framework::BundlePhase phase,
+              Clock::time_point start);
+
+  std::vector<Framework::BundlePhaseTiming> GetTimings() const;
+
+  /**
+   * Write the recorded timings as Chrome trace event JSON.
+   */
+  void WriteTrace(std::ostream& os) const;
+
+private:
+  void Record(Framework::BundlePhaseTiming&& timing);
+
+  mutable std::mutex mutex;
+  std::vector<Framework::BundlePhaseTiming> timings;
+};
+}
+
+#endif // CPPMICROSERVICES_BUNDLETIMINGS_H
@@ -42,6 +42,7 @@ const std::string BUNDLE_SYMBOLICNAME = "bundle.symbolic_name";
 const std::string BUNDLE_MANIFESTVERSION = "bundle.manifest_version";
 const std::string BUNDLE_ACTIVATIONPOLICY = "bundle.activation_policy";
 const std::string ACTIVATION_LAZY = "lazy";
+const std::string BUNDLE_STARTDEPENDENCIES = "bundle.start_dependencies";
 const std::string FRAMEWORK_VERSION = "org.cppmicroservices.framework.version";
 const std::string FRAMEWORK_VENDOR = "org.cppmicroservices.framework.vendor";
 const std::string FRAMEWORK_STORAGE = "org.cppmicroservices.framework.storage";
@@ -58,6 +59,24 @@ const std::string FRAMEWORK_WORKING_DIR =
   "org.cppmicroservices.framework.working.dir";
 const std::string FRAMEWORK_BUNDLE_VALIDATION_FUNC = 
     "org.cppmicroservices.framework.bundle.validation.function";
+const std::string FRAMEWORK_BUNDLE_INSTALL_THREADS =
+  "org.cppmicroservices.framework.bundle.install.threads";
+const std::string FRAMEWORK_BUNDLE_START_THREADS =
+  "org.cppmicroservices.framework.bundle.start.threads";
+const std::string FRAMEWORK_BUNDLE_METADATA_CACHE =
+  "org.cppmicroservices.framework.bundle.metadata.cache";
+const std::string FRAMEWORK_BUNDLE_TIMING =
+  "org.cppmicroservices.framework.bundle.timing";
+const std::string FRAMEWORK_SERVICE_EVENT_DELIVERY =
+  "org.cppmicroservices.framework.service.event.delivery";
+const std::string FRAMEWORK_SERVICE_EVENT_DELIVERY_SYNC = "sync";
+const std::string FRAMEWORK_SERVICE_EVENT_DELIVERY_ASYNC = "async";
+const std::string FRAMEWORK_SERVICE_EVENT_QUEUE_DEPTH =
+  "org.cppmicroservices.framework.service.event.queue.depth";
+const std::string FRAMEWORK_SERVICE_EVENT_QUEUE_POLICY =
+  "org.cppmicroservices.framework.service.event.queue.policy";
+const std::string FRAMEWORK_SERVICE_EVENT_QUEUE_BLOCK = "block";
+const std::string FRAMEWORK_SERVICE_EVENT_QUEUE_DISCARD = "discard";
 const std::string OBJECTCLASS = "objectclass";
 const std::string SERVICE_ID = "service.id";
 const std::string SERVICE_PID = "service.pid";
@@ -34,7 +34,9 @@ US_MSVC_DISABLE_WARNING(4355)
 #include "cppmicroservices/util/String.h"
 
 #include "BundleContextPrivate.h"
+#include "BundleMetadataCache.h"
 #include "BundleStorageMemory.h"
+#include "BundleTimings.h"
 #include "BundleUtils.h"
 #include "FrameworkPrivate.h"
 
@@ -161,12 +163,43 @@ void CoreBundleContext::Init()
                     << "' from the GetPersistentStoragePath function.\n";
   }
 
+  auto metadataCacheProp =
+    frameworkProperties.find(Constants::FRAMEWORK_BUNDLE_METADATA_CACHE);
+  if (metadataCacheProp != frameworkProperties.end()) {
+    try {
+      if (any_cast<bool>(metadataCacheProp->second)) {
+        auto cacheDir =
+          GetPersistentStoragePath(this, "metadata", /*create=*/false);
+        if (!cacheDir.empty()) {
+          metadataCache = std::make_unique<BundleMetadataCache>(cacheDir);
+        }
+      }
+    } catch (const std::exception& e) {
+      DIAG_LOG(*sink) << "Bundle metadata cache disabled: " << e.what();
+    }
+  }
+
+  bundleTimings.reset();
+  auto timingProp =
+    frameworkProperties.find(Constants::FRAMEWORK_BUNDLE_TIMING);
+  if (timingProp != frameworkProperties.end()) {
+    try {
+      if (any_cast<bool>(timingProp->second)) {
+        bundleTimings = std::make_unique<BundleTimings>();
+      }
+    } catch (const std::exception& e) {
+      DIAG_LOG(*sink) << "Bundle phase timing disabled: " << e.what();
+    }
+  }
+
   auto bundleValidationFunc =
     frameworkProperties.find(Constants::FRAMEWORK_BUNDLE_VALIDATION_FUNC);
   if (bundleValidationFunc != frameworkProperties.end()) {
     validationFunc = any_cast<std::function<bool(const cppmicroservices::Bundle&)>>(bundleValidationFunc->second);
   }
 
+  listeners.Init();
+
   systemBundle->InitSystemBundle();
   _us_set_bundle_context_instance_system_bundle(
     systemBundle->bundleContext.Load().get());
@@ -236,6 +269,7 @@ void CoreBundleContext::Uninit1()
   resolver.Clear();
 
   dataStorage.clear();
+  metadataCache.reset();
   storage->Close();
 }
 
@@ -60,6 +60,8 @@ as specified in the OSGi R4.2 specifications.
 
 namespace cppmicroservices {
 
+class BundleMetadataCache;
+class BundleTimings;
 struct BundleStorage;
 class FrameworkPrivate;
 
@@ -115,6 +117,18 @@ public:
    */
   std::string dataStorage;
 
+  /**
+   * The bundle metadata cache, or nullptr if it is disabled.
+   */
+  std::unique_ptr<BundleMetadataCache> metadataCache;
+
+  /**
+   * The phase timings of the bundles, or nullptr if recording them is
+   * disabled. Kept after the framework stopped, until it is initialized
+   * again.
+   */
+  std::unique_ptr<BundleTimings> bundleTimings;
+
   /**
    * All listeners in this framework.
    */
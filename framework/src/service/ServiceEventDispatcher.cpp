@@ -0,0 +1,184 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ServiceEventDispatcher.h"
+
+#include "cppmicroservices/BundleContext.h"
+
+#include "BundleContextPrivate.h"
+
+#include <algorithm>
+
+namespace cppmicroservices {
+
+namespace {
+
+// Set on worker threads of any dispatcher
+thread_local bool isDispatcherThread = false;
+}
+
+ServiceEventDispatcher::ServiceEventDispatcher(Delivery deliver,
+                                               std::size_t maxQueueDepth,
+                                               QueuePolicy policy,
+                                               std::size_t threadCount)
+  : deliver(std::move(deliver))
+  , maxQueueDepth(std::max<std::size_t>(maxQueueDepth, 1))
+  , policy(policy)
+  , stopping(false)
+  , queuedCount(0)
+  , deliveredCount(0)
+  , discardedCount(0)
+  , pendingCount(0)
+  , maxDepth(0)
+  , totalLatency(std::chrono::steady_clock::duration::zero())
+  , maxLatency(std::chrono::steady_clock::duration::zero())
+{
+  threadCount = std::max<std::size_t>(threadCount, 1);
+  workers.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; ++i) {
+    workers.emplace_back(&ServiceEventDispatcher::Run, this);
+  }
+}
+
+ServiceEventDispatcher::~ServiceEventDispatcher()
+{
+  Stop();
+}
+
+bool ServiceEventDispatcher::Enqueue(const ServiceListenerEntry& listener,
+                                     const ServiceEvent& evt)
+{
+  auto context = GetPrivate(listener.GetBundleContext());
+
+  std::unique_lock<std::mutex> l(mutex);
+  if (stopping) {
+    // No worker may be left to process the queue, deliver in place
+    l.unlock();
+    deliver(listener, evt);
+    return true;
+  }
+
+  auto* queue = &queues[context];
+  if (queue->events.size() >= maxQueueDepth && !isDispatcherThread) {
+    if (policy == QueuePolicy::DISCARD) {
+      ++discardedCount;
+      return false;
+    }
+    spaceAvailable.wait(l, [&] {
+      // the queue may have been removed while waiting
+      queue = &queues[context];
+      return stopping || queue->events.size() < maxQueueDepth;
+    });
+    if (stopping) {
+      l.unlock();
+      deliver(listener, evt);
+      return true;
+    }
+  }
+
+  queue->events.push_back(
+    QueuedEvent{ listener, evt, std::chrono::steady_clock::now() });
+  ++queuedCount;
+  ++pendingCount;
+  maxDepth = std::max(maxDepth, queue->events.size());
+  if (!queue->scheduled) {
+    queue->scheduled = true;
+    ready.push_back(context);
+    workAvailable.notify_one();
+  }
+  return true;
+}
+
+void ServiceEventDispatcher::Stop()
+{
+  {
+    std::lock_guard<std::mutex> l(mutex);
+    if (stopping) {
+      return;
+    }
+    stopping = true;
+  }
+  workAvailable.notify_all();
+  spaceAvailable.notify_all();
+
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+Framework::ServiceEventDeliveryStatistics ServiceEventDispatcher::GetStatistics()
+  const
+{
+  using namespace std::chrono;
+
+  std::lock_guard<std::mutex> l(mutex);
+  Framework::ServiceEventDeliveryStatistics stats;
+  stats.queued = queuedCount;
+  stats.delivered = deliveredCount;
+  stats.discarded = discardedCount;
+  stats.pending = pendingCount;
+  stats.maxQueueDepth = maxDepth;
+  stats.averageLatency =
+    deliveredCount ? duration_cast<microseconds>(totalLatency / deliveredCount)
+                   : microseconds::zero();
+  stats.maxLatency = duration_cast<microseconds>(maxLatency);
+  return stats;
+}
+
+void ServiceEventDispatcher::Run()
+{
+  isDispatcherThread = true;
+
+  std::unique_lock<std::mutex> l(mutex);
+  while (true) {
+    // Pending events are still delivered after Stop() was called.
+    workAvailable.wait(l, [this] { return stopping || !ready.empty(); });
+    if (ready.empty()) {
+      return;
+    }
+
+    auto context = std::move(ready.front());
+    ready.pop_front();
+    auto it = queues.find(context);
+    while (!it->second.events.empty()) {
+      QueuedEvent next = std::move(it->second.events.front());
+      it->second.events.pop_front();
+      --pendingCount;
+      spaceAvailable.notify_all();
+
+      auto latency = std::chrono::steady_clock::now() - next.queued;
+      totalLatency += latency;
+      maxLatency = std::max(maxLatency, latency);
+      ++deliveredCount;
+
+      l.unlock();
+      deliver(next.listener, next.event);
+      l.lock();
+      // the map may have been rehashed while the lock was released
+      it = queues.find(context);
+    }
+    queues.erase(it);
+  }
+}
+}
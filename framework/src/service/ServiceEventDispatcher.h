@@ -0,0 +1,145 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_SERVICEEVENTDISPATCHER_H
+#define CPPMICROSERVICES_SERVICEEVENTDISPATCHER_H
+
+#include "cppmicroservices/Framework.h"
+#include "cppmicroservices/ServiceEvent.h"
+
+#include "ServiceListenerEntry.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cppmicroservices {
+
+class BundleContextPrivate;
+
+/**
+ * Delivers service events asynchronously on a small pool of worker threads.
+ *
+ * Events are queued per bundle which registered the listener. A bundle's
+ * queue is processed by at most one worker at a time, so each listener
+ * receives the events of a service in the order they were fired. A slow
+ * listener only delays the listeners of its own bundle.
+ */
+class ServiceEventDispatcher
+{
+public:
+  /**
+   * What to do when an event is fired for a bundle whose queue is full.
+   */
+  enum class QueuePolicy
+  {
+    /** Block the thread firing the event until the queue has room. */
+    BLOCK,
+    /** Discard the event. */
+    DISCARD
+  };
+
+  using Delivery =
+    std::function<void(const ServiceListenerEntry&, const ServiceEvent&)>;
+
+  ServiceEventDispatcher(Delivery deliver,
+                         std::size_t maxQueueDepth,
+                         QueuePolicy policy,
+                         std::size_t threadCount);
+
+  ServiceEventDispatcher(const ServiceEventDispatcher&) = delete;
+  ServiceEventDispatcher& operator=(const ServiceEventDispatcher&) = delete;
+
+  ~ServiceEventDispatcher();
+
+  /**
+   * Queues <code>evt</code> for delivery to <code>listener</code>.
+   *
+   * Events fired from a worker thread, i.e. from within a listener, are
+   * always queued, even if the queue is full. Blocking there could
+   * deadlock the worker on its own queue. Events fired after Stop() was
+   * called are delivered on the calling thread.
+   *
+   * @return <code>false</code> if the event was discarded.
+   */
+  bool Enqueue(const ServiceListenerEntry& listener, const ServiceEvent& evt);
+
+  /**
+   * Delivers all queued events and stops the worker threads. Must not be
+   * called from within a listener.
+   */
+  void Stop();
+
+  Framework::ServiceEventDeliveryStatistics GetStatistics() const;
+
+private:
+  struct QueuedEvent
+  {
+    ServiceListenerEntry listener;
+    ServiceEvent event;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  struct BundleQueue
+  {
+    std::deque<QueuedEvent> events;
+    bool scheduled = false;
+  };
+
+  using BundleQueues =
+    std::unordered_map<std::shared_ptr<BundleContextPrivate>, BundleQueue>;
+
+  void Run();
+
+  const Delivery deliver;
+  const std::size_t maxQueueDepth;
+  const QueuePolicy policy;
+
+  mutable std::mutex mutex;
+  std::condition_variable workAvailable;
+  std::condition_variable spaceAvailable;
+
+  BundleQueues queues;
+  /* Bundles with queued events which no worker is processing */
+  std::deque<std::shared_ptr<BundleContextPrivate>> ready;
+  bool stopping;
+
+  uint64_t queuedCount;
+  uint64_t deliveredCount;
+  uint64_t discardedCount;
+  std::size_t pendingCount;
+  std::size_t maxDepth;
+  std::chrono::steady_clock::duration totalLatency;
+  std::chrono::steady_clock::duration maxLatency;
+
+  std::vector<std::thread> workers;
+};
+}
+
+#endif // CPPMICROSERVICES_SERVICEEVENTDISPATCHER_H
@@ -117,8 +117,7 @@ void ServiceHooks::FilterServiceReferences(
   std::vector<ServiceReferenceBase>& refs)
 {
   std::vector<ServiceRegistrationBase> srl;
-  coreCtx->services.Get_unlocked(us_service_interface_iid<ServiceFindHook>(),
-                                 srl);
+  coreCtx->services.Get(us_service_interface_iid<ServiceFindHook>(), srl);
   if (!srl.empty()) {
     ShrinkableVector<ServiceReferenceBase> filtered(refs);
 
@@ -149,6 +148,14 @@ void ServiceHooks::FilterServiceReferences(
   }
 }
 
+bool ServiceHooks::HasServiceEventListenerHooks() const
+{
+  std::vector<ServiceRegistrationBase> eventListenerHooks;
+  coreCtx->services.Get(us_service_interface_iid<ServiceEventListenerHook>(),
+                        eventListenerHooks);
+  return !eventListenerHooks.empty();
+}
+
 void ServiceHooks::FilterServiceEventReceivers(
   const ServiceEvent& evt,
   ServiceListeners::ServiceListenerEntries& receivers)
@@ -67,6 +67,12 @@ public:
                                const std::string& filter,
                                std::vector<ServiceReferenceBase>& refs);
 
+  /**
+   * Returns <code>true</code> if any ServiceEventListenerHook services
+   * are registered.
+   */
+  bool HasServiceEventListenerHooks() const;
+
   void FilterServiceEventReceivers(
     const ServiceEvent& evt,
     ServiceListeners::ServiceListenerEntries& receivers);
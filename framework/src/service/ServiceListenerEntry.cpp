@@ -27,6 +27,7 @@ US_MSVC_PUSH_DISABLE_WARNING(
 
 #include "ServiceListenerEntry.h"
 
+#include "LDAPExprCache.h"
 #include "ServiceListenerHookPrivate.h"
 
 #include <cassert>
@@ -59,7 +60,7 @@ public:
     , hashValue(0)
   {
     if (!filter.empty()) {
-      ldap = LDAPExpr(filter);
+      ldap = LDAPExprCache::Instance().Get(filter);
     }
   }
 
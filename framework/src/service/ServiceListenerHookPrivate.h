@@ -27,6 +27,8 @@
 
 #include "ServiceListenerEntry.h"
 
+#include <atomic>
+
 namespace cppmicroservices {
 
 class ServiceListenerHook::ListenerInfoData
@@ -45,7 +47,8 @@ public:
   void* data;
   ListenerTokenId tokenId;
   std::string filter;
-  bool bRemoved;
+  //! Set on removal, read by threads delivering service events
+  std::atomic<bool> bRemoved;
 };
 }
 
@@ -42,30 +42,176 @@ US_MSVC_PUSH_DISABLE_WARNING(
 #include "Properties.h"
 #include "ServiceReferenceBasePrivate.h"
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
 namespace cppmicroservices {
 
+namespace {
+
+// The number of listeners in a chunk of a ServiceListenerBucket, which
+// is the number of listeners copied when a listener is added.
+const std::size_t ListenersPerChunk = 64;
+
+ServiceListeners::ServiceListenerBucket AddToBucket(
+  const ServiceListeners::ServiceListenerBucket& bucket,
+  const ServiceListenerEntry& sle)
+{
+  auto chunks =
+    bucket
+      ? std::make_shared<std::vector<ServiceListeners::ServiceListenerChunk>>(
+          *bucket)
+      : std::make_shared<std::vector<ServiceListeners::ServiceListenerChunk>>();
+  if (chunks->empty() || chunks->back()->size() >= ListenersPerChunk) {
+    auto chunk = std::make_shared<std::vector<ServiceListenerEntry>>();
+    chunk->reserve(ListenersPerChunk);
+    chunk->push_back(sle);
+    chunks->push_back(std::move(chunk));
+  } else {
+    auto chunk =
+      std::make_shared<std::vector<ServiceListenerEntry>>(*chunks->back());
+    chunk->push_back(sle);
+    chunks->back() = std::move(chunk);
+  }
+  return chunks;
+}
+
+/**
+ * Returns a copy of <code>bucket</code> without <code>sle</code>, or an
+ * empty pointer if no other listener remains. Only the chunk containing
+ * <code>sle</code> is copied; it is dropped if it becomes empty.
+ */
+ServiceListeners::ServiceListenerBucket RemoveFromBucket(
+  const ServiceListeners::ServiceListenerBucket& bucket,
+  const ServiceListenerEntry& sle)
+{
+  if (!bucket) {
+    return bucket;
+  }
+  for (std::size_t i = 0; i < bucket->size(); ++i) {
+    const auto& chunk = *(*bucket)[i];
+    if (std::find(chunk.begin(), chunk.end(), sle) == chunk.end()) {
+      continue;
+    }
+    auto chunks =
+      std::make_shared<std::vector<ServiceListeners::ServiceListenerChunk>>(
+        *bucket);
+    if (chunk.size() == 1) {
+      chunks->erase(chunks->begin() + static_cast<std::ptrdiff_t>(i));
+      if (chunks->empty()) {
+        return nullptr;
+      }
+    } else {
+      auto entries = std::make_shared<std::vector<ServiceListenerEntry>>();
+      entries->reserve(chunk.size() - 1);
+      std::copy_if(
+        chunk.begin(),
+        chunk.end(),
+        std::back_inserter(*entries),
+        [&sle](const ServiceListenerEntry& e) { return !(e == sle); });
+      (*chunks)[i] = std::move(entries);
+    }
+    return chunks;
+  }
+  return bucket;
+}
+
+/**
+ * Adds the values of a hashed service property to <code>values</code>.
+ * Returns <code>false</code> if the value has a type whose LDAP comparison
+ * does not reduce to string equality, in which case all listeners cached
+ * for the key have to be evaluated.
+ */
+bool GetHashedValues(const Any& value, std::vector<std::string>& values)
+{
+  if (value.Empty()) {
+    return true;
+  }
+  if (value.Type() == typeid(std::string)) {
+    values.push_back(ref_any_cast<std::string>(value));
+    return true;
+  }
+  if (value.Type() == typeid(std::vector<std::string>)) {
+    const auto& v = ref_any_cast<std::vector<std::string>>(value);
+    values.insert(values.end(), v.begin(), v.end());
+    return true;
+  }
+  return false;
+}
+}
+
 ServiceListeners::ServiceListeners(CoreBundleContext* coreCtx)
   : listenerId(0)
+  , hashedServiceKeys{ Constants::OBJECTCLASS,
+                       Constants::SERVICE_ID,
+                       Constants::SERVICE_PID }
   , coreCtx(coreCtx)
+{}
+
+void ServiceListeners::Init()
 {
-  hashedServiceKeys.push_back(Constants::OBJECTCLASS);
-  hashedServiceKeys.push_back(Constants::SERVICE_ID);
+#ifdef US_ENABLE_THREADING_SUPPORT
+  const auto& props = coreCtx->frameworkProperties;
+  auto delivery = props.find(Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY);
+  if (delivery == props.end() ||
+      delivery->second.ToStringNoExcept() !=
+        Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY_ASYNC) {
+    return;
+  }
+
+  std::size_t queueDepth = 1024;
+  auto depth = props.find(Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_DEPTH);
+  if (depth != props.end()) {
+    try {
+      queueDepth = static_cast<std::size_t>(
+        std::max(any_cast<int>(depth->second), 1));
+    } catch (...) {
+      DIAG_LOG(*coreCtx->sink)
+        << "Ignoring invalid service event queue depth, using "
+        << queueDepth;
+    }
+  }
+
+  auto queuePolicy = ServiceEventDispatcher::QueuePolicy::BLOCK;
+  auto policy = props.find(Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_POLICY);
+  if (policy != props.end() &&
+      policy->second.ToStringNoExcept() ==
+        Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_DISCARD) {
+    queuePolicy = ServiceEventDispatcher::QueuePolicy::DISCARD;
+  }
+
+  const std::size_t threadCount =
+    std::min(std::max(std::thread::hardware_concurrency(), 1u), 4u);
+  dispatcher.Store(std::make_shared<ServiceEventDispatcher>(
+    [this](const ServiceListenerEntry& l, const ServiceEvent& evt) {
+      if (!l.IsRemoved()) {
+        CallServiceListener(l, evt);
+      }
+    },
+    queueDepth,
+    queuePolicy,
+    threadCount));
+#endif
 }
 
 void ServiceListeners::Clear()
 {
+  // Deliver the queued events before the listeners are dropped
+  if (auto d = dispatcher.Exchange(nullptr)) {
+    d->Stop();
+  }
+
   bundleListenerMap.Lock(), bundleListenerMap.value.clear();
   {
     auto l = this->Lock();
     US_UNUSED(l);
     serviceSet.clear();
-    hashedServiceKeys.clear();
-    complicatedListeners.clear();
-    cache[0].clear();
-    cache[1].clear();
+    complicatedListeners.reset();
+    for (int i = 0; i < HASHED_KEYS_COUNT; ++i) {
+      cache[i].clear();
+      conjunctionCache[i].clear();
+    }
   }
 
   frameworkListenerMap.Lock(), frameworkListenerMap.value.clear();
@@ -349,6 +495,7 @@ void ServiceListeners::RemoveAllListeners(
     US_UNUSED(l);
     for (auto it = serviceSet.begin(); it != serviceSet.end();) {
       if (GetPrivate(it->GetBundleContext()) == context) {
+        it->SetRemoved(true);
         RemoveFromCache_unlocked(*it);
         serviceSet.erase(it++);
       } else {
@@ -397,74 +544,213 @@ void ServiceListeners::ServiceChanged(ServiceListenerEntries& receivers,
                                       const ServiceEvent& evt,
                                       ServiceListenerEntries& matchBefore)
 {
-  int n = 0;
-
   if (!matchBefore.empty()) {
     for (auto& l : receivers) {
       matchBefore.erase(l);
     }
   }
 
+  auto asyncDispatcher = dispatcher.Load();
   for (auto const& l : receivers) {
     if (!l.IsRemoved()) {
-      try {
-        ++n;
-        l.CallDelegate(evt);
-      } catch (...) {
-        std::string message("Service listener in " +
-                            l.GetBundleContext().GetBundle().GetSymbolicName() +
-                            " threw an exception!");
-        SendFrameworkEvent(FrameworkEvent(FrameworkEvent::Type::FRAMEWORK_ERROR,
-                                          l.GetBundleContext().GetBundle(),
-                                          message,
-                                          std::current_exception()));
+      if (asyncDispatcher) {
+        asyncDispatcher->Enqueue(l, evt);
+      } else {
+        CallServiceListener(l, evt);
       }
     }
   }
 }
 
+void ServiceListeners::CallServiceListener(const ServiceListenerEntry& l,
+                                           const ServiceEvent& evt)
+{
+  try {
+    l.CallDelegate(evt);
+  } catch (...) {
+    std::string message("Service listener in " +
+                        l.GetBundleContext().GetBundle().GetSymbolicName() +
+                        " threw an exception!");
+    SendFrameworkEvent(FrameworkEvent(FrameworkEvent::Type::FRAMEWORK_ERROR,
+                                      l.GetBundleContext().GetBundle(),
+                                      message,
+                                      std::current_exception()));
+  }
+}
+
 void ServiceListeners::GetMatchingServiceListeners(const ServiceEvent& evt,
                                                    ServiceListenerEntries& set)
 {
-  // Filter the original set of listeners
-  ServiceListenerEntries receivers = (this->Lock(), serviceSet);
-  // This must not be called with any locks held
-  coreCtx->serviceHooks.FilterServiceEventReceivers(evt, receivers);
+  // Event listener hooks may filter the receivers. They get to see all
+  // listeners, so the set is only copied if such hooks are registered.
+  ServiceListenerEntries receivers;
+  const bool filterReceivers =
+    coreCtx->serviceHooks.HasServiceEventListenerHooks();
+  if (filterReceivers) {
+    receivers = (this->Lock(), serviceSet);
+    // This must not be called with any locks held
+    coreCtx->serviceHooks.FilterServiceEventReceivers(evt, receivers);
+  }
 
   // Get a copy of the service reference and keep it until we are
   // done with its properties.
   auto ref = evt.GetServiceReference();
   auto props = ref.d.load()->GetProperties();
 
+  HashedServiceValues values;
+  GetHashedServiceValues(props, values);
+
+  std::vector<ServiceListenerBucket> exact;
+  std::vector<ServiceListenerBucket> candidates;
   {
     auto l = this->Lock();
     US_UNUSED(l);
-    // Check complicated or empty listener filters
-    for (auto& sse : complicatedListeners) {
-      if (receivers.count(sse) == 0)
-        continue;
-      const LDAPExpr& ldapExpr = sse.GetLDAPExpr();
-      if (ldapExpr.IsNull() || ldapExpr.Evaluate(props, false)) {
-        set.insert(sse);
-      }
+    GetCachedListeners_unlocked(values, exact, candidates);
+  }
+
+  AddMatchingListeners(
+    exact, candidates, props, filterReceivers ? &receivers : nullptr, set);
+}
+
+void ServiceListeners::ServiceChanged(const std::vector<ServiceEvent>& events)
+{
+  if (events.empty()) {
+    return;
+  }
+
+  struct PendingEvent
+  {
+    HashedServiceValues values;
+    std::vector<ServiceListenerBucket> exact;
+    std::vector<ServiceListenerBucket> candidates;
+  };
+
+  const bool filterReceivers =
+    coreCtx->serviceHooks.HasServiceEventListenerHooks();
+
+  // Keep the service references alive until all events have been
+  // delivered. The service properties are only locked while they are
+  // read, listeners may access them while an event is delivered.
+  std::vector<ServiceReferenceBase> refs;
+  std::vector<PendingEvent> pending(events.size());
+  refs.reserve(events.size());
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    refs.push_back(events[i].GetServiceReference());
+    GetHashedServiceValues(refs.back().d.load()->GetProperties(),
+                           pending[i].values);
+  }
+
+  // Collect the cached listeners of all services with one lock acquisition
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+    for (auto& p : pending) {
+      GetCachedListeners_unlocked(p.values, p.exact, p.candidates);
+    }
+  }
+
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    ServiceListenerEntries receivers;
+    if (filterReceivers) {
+      receivers = (this->Lock(), serviceSet);
+      // This must not be called with any locks held
+      coreCtx->serviceHooks.FilterServiceEventReceivers(events[i], receivers);
+    }
+
+    ServiceListenerEntries listeners;
+    AddMatchingListeners(pending[i].exact,
+                         pending[i].candidates,
+                         refs[i].d.load()->GetProperties(),
+                         filterReceivers ? &receivers : nullptr,
+                         listeners);
+    ServiceChanged(listeners, events[i]);
+  }
+}
+
+void ServiceListeners::GetHashedServiceValues(const PropertiesHandle& props,
+                                              HashedServiceValues& values) const
+{
+  for (int i = 0; i < HASHED_KEYS_COUNT; ++i) {
+    if (i == SERVICE_ID_IX) {
+      auto service_id =
+        any_cast<long>(props->Value_unlocked(Constants::SERVICE_ID));
+      values.values[i].push_back(cppmicroservices::util::ToString(service_id));
+      values.hashable[i] = true;
+    } else {
+      values.hashable[i] = GetHashedValues(
+        props->Value_unlocked(props->Find_unlocked(hashedServiceKeys[i])),
+        values.values[i]);
     }
+  }
+}
+
+void ServiceListeners::GetCachedListeners_unlocked(
+  const HashedServiceValues& values,
+  std::vector<ServiceListenerBucket>& exact,
+  std::vector<ServiceListenerBucket>& candidates) const
+{
+  // Listeners in "exact" match by their cache key alone, the filters of
+  // listeners in "candidates" still need to be evaluated.
+  if (complicatedListeners) {
+    candidates.push_back(complicatedListeners);
+  }
 
-    // Check the cache
-    const auto c = any_cast<std::vector<std::string>>(
-      props->Value_unlocked(Constants::OBJECTCLASS));
-    for (auto& objClass : c) {
-      AddToSet_unlocked(set, receivers, OBJECTCLASS_IX, objClass);
+  for (int i = 0; i < HASHED_KEYS_COUNT; ++i) {
+    if (!values.hashable[i]) {
+      for (auto& entry : cache[i]) {
+        candidates.push_back(entry.second);
+      }
+      for (auto& entry : conjunctionCache[i]) {
+        candidates.push_back(entry.second);
+      }
+      continue;
+    }
+    for (auto& val : values.values[i]) {
+      AddToBuckets_unlocked(exact, candidates, i, val);
     }
+  }
+}
 
-    auto service_id =
-      any_cast<long>(props->Value_unlocked(Constants::SERVICE_ID));
-    AddToSet_unlocked(set,
-                      receivers,
-                      SERVICE_ID_IX,
-                      cppmicroservices::util::ToString((service_id)));
+void ServiceListeners::AddMatchingListeners(
+  const std::vector<ServiceListenerBucket>& exact,
+  const std::vector<ServiceListenerBucket>& candidates,
+  const PropertiesHandle& props,
+  const ServiceListenerEntries* receivers,
+  ServiceListenerEntries& set) const
+{
+  // The buckets are immutable, no lock is needed to evaluate the filters.
+  for (auto& bucket : exact) {
+    for (auto& chunk : *bucket) {
+      for (auto& sle : *chunk) {
+        if (!receivers || receivers->count(sle)) {
+          set.insert(sle);
+        }
+      }
+    }
+  }
+  for (auto& bucket : candidates) {
+    for (auto& chunk : *bucket) {
+      for (auto& sle : *chunk) {
+        if (set.count(sle) || (receivers && receivers->count(sle) == 0)) {
+          continue;
+        }
+        const LDAPExpr& ldapExpr = sle.GetLDAPExpr();
+        if (ldapExpr.IsNull() || ldapExpr.Evaluate(props, false)) {
+          set.insert(sle);
+        }
+      }
+    }
   }
 }
 
+Framework::ServiceEventDeliveryStatistics
+ServiceListeners::GetServiceEventDeliveryStatistics() const
+{
+  auto asyncDispatcher = dispatcher.Load();
+  return asyncDispatcher ? asyncDispatcher->GetStatistics()
+                         : Framework::ServiceEventDeliveryStatistics();
+}
+
 std::vector<ServiceListenerHook::ListenerInfo>
 ServiceListeners::GetListenerInfoCollection() const
 {
@@ -480,62 +766,72 @@ ServiceListeners::GetListenerInfoCollection() const
 
 void ServiceListeners::RemoveFromCache_unlocked(const ServiceListenerEntry& sle)
 {
-  if (!sle.GetLocalCache().empty()) {
-    for (std::size_t i = 0; i < hashedServiceKeys.size(); ++i) {
-      CacheType& keymap = cache[i];
-      std::vector<std::string>& filters = sle.GetLocalCache()[i];
-      for (auto const& filter : filters) {
-        std::set<ServiceListenerEntry>& sles = keymap[filter];
-        sles.erase(sle);
-        if (sles.empty()) {
-          keymap.erase(filter);
+  const LDAPExpr::LocalCache& local_cache = sle.GetLocalCache();
+  if (!local_cache.empty()) {
+    const auto keyCount = std::min(local_cache.size(),
+                                   static_cast<std::size_t>(HASHED_KEYS_COUNT));
+    for (std::size_t i = 0; i < keyCount; ++i) {
+      for (CacheType* keymap : { &cache[i], &conjunctionCache[i] }) {
+        for (auto const& filter : local_cache[i]) {
+          auto it = keymap->find(filter);
+          if (it == keymap->end()) {
+            continue;
+          }
+          it->second = RemoveFromBucket(it->second, sle);
+          if (!it->second) {
+            keymap->erase(it);
+          }
         }
       }
     }
   } else {
-    complicatedListeners.remove(sle);
+    complicatedListeners = RemoveFromBucket(complicatedListeners, sle);
   }
 }
 
 void ServiceListeners::CheckSimple_unlocked(const ServiceListenerEntry& sle)
 {
-  if (sle.GetLDAPExpr().IsNull()) {
-    complicatedListeners.push_back(sle);
-  } else {
-    LDAPExpr::LocalCache local_cache;
-    if (sle.GetLDAPExpr().IsSimple(hashedServiceKeys, local_cache, false)) {
-      sle.GetLocalCache() = local_cache;
-      for (std::size_t i = 0; i < hashedServiceKeys.size(); ++i) {
-        for (std::vector<std::string>::const_iterator it =
-               local_cache[i].begin();
-             it != local_cache[i].end();
-             ++it) {
-          std::set<ServiceListenerEntry>& sles = cache[i][*it];
-          sles.insert(sle);
-        }
-      }
-    } else {
-      complicatedListeners.push_back(sle);
+  const LDAPExpr& ldapExpr = sle.GetLDAPExpr();
+  if (ldapExpr.IsNull()) {
+    complicatedListeners = AddToBucket(complicatedListeners, sle);
+    return;
+  }
+
+  LDAPExpr::LocalCache local_cache;
+  CacheType* keymaps = cache;
+  if (!ldapExpr.IsSimple(hashedServiceKeys, local_cache, false)) {
+    local_cache.clear();
+    if (!ldapExpr.IsSimpleConjunction(hashedServiceKeys, local_cache, false)) {
+      complicatedListeners = AddToBucket(complicatedListeners, sle);
+      return;
+    }
+    keymaps = conjunctionCache;
+  }
+
+  sle.GetLocalCache() = local_cache;
+  const auto keyCount = std::min(local_cache.size(),
+                                 static_cast<std::size_t>(HASHED_KEYS_COUNT));
+  for (std::size_t i = 0; i < keyCount; ++i) {
+    for (auto const& val : local_cache[i]) {
+      ServiceListenerBucket& bucket = keymaps[i][val];
+      bucket = AddToBucket(bucket, sle);
     }
   }
 }
 
-void ServiceListeners::AddToSet_unlocked(
-  ServiceListenerEntries& set,
-  const ServiceListenerEntries& receivers,
+void ServiceListeners::AddToBuckets_unlocked(
+  std::vector<ServiceListenerBucket>& exact,
+  std::vector<ServiceListenerBucket>& candidates,
   int cache_ix,
-  const std::string& val)
+  const std::string& val) const
 {
-  const auto cacheItr = cache[cache_ix].find(val);
+  auto cacheItr = cache[cache_ix].find(val);
   if (cacheItr != cache[cache_ix].end()) {
-    std::set<ServiceListenerEntry>& l = cache[cache_ix][val];
-    if (!l.empty()) {
-      for (const ServiceListenerEntry& entry : l) {
-        if (receivers.count(entry)) {
-          set.insert(entry);
-        }
-      }
-    }
+    exact.push_back(cacheItr->second);
+  }
+  cacheItr = conjunctionCache[cache_ix].find(val);
+  if (cacheItr != conjunctionCache[cache_ix].end()) {
+    candidates.push_back(cacheItr->second);
   }
 }
 }
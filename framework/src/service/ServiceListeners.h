@@ -26,20 +26,22 @@
 #include "cppmicroservices/GlobalConfig.h"
 #include "cppmicroservices/detail/Threads.h"
 
+#include "ServiceEventDispatcher.h"
 #include "ServiceListenerEntry.h"
 
-#include <list>
+#include <memory>
 #include <mutex>
-#include <set>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace cppmicroservices {
 
 class CoreBundleContext;
 class BundleContextPrivate;
+class PropertiesHandle;
 
 /**
  * Here we handle all listeners that bundles have registered.
@@ -59,8 +61,18 @@ public:
     BundleListenerMap value;
   } bundleListenerMap;
 
-  using CacheType =
-    std::unordered_map<std::string, std::set<ServiceListenerEntry>>;
+  /**
+   * An immutable list of service listeners, split into immutable chunks.
+   * Adding or removing a listener replaces the affected lists, so a list
+   * obtained while dispatching a service event can be used without
+   * holding the lock. The new list shares all chunks but one with the
+   * old list, so that adding a listener does not copy all listeners.
+   */
+  using ServiceListenerChunk =
+    std::shared_ptr<const std::vector<ServiceListenerEntry>>;
+  using ServiceListenerBucket =
+    std::shared_ptr<const std::vector<ServiceListenerChunk>>;
+  using CacheType = std::unordered_map<std::string, ServiceListenerBucket>;
   using ServiceListenerEntries = std::unordered_set<ServiceListenerEntry>;
 
   using FrameworkListenerEntry = std::tuple<FrameworkListener, void*>;
@@ -76,23 +88,48 @@ private:
     FrameworkListenerMap value;
   } frameworkListenerMap;
 
-  std::vector<std::string> hashedServiceKeys;
+  const std::vector<std::string> hashedServiceKeys;
   static const int OBJECTCLASS_IX = 0;
   static const int SERVICE_ID_IX = 1;
+  static const int SERVICE_PID_IX = 2;
+  static const int HASHED_KEYS_COUNT = 3;
+
+  /* The values of a service's hashed keys, used for cache look-ups */
+  struct HashedServiceValues
+  {
+    std::vector<std::string> values[HASHED_KEYS_COUNT];
+    bool hashable[HASHED_KEYS_COUNT];
+  };
 
   /* Service listeners with complicated or empty filters */
-  std::list<ServiceListenerEntry> complicatedListeners;
+  ServiceListenerBucket complicatedListeners;
 
   /* Service listeners with "simple" filters are cached. */
-  CacheType cache[2];
+  CacheType cache[HASHED_KEYS_COUNT];
+
+  /*
+   * Service listeners whose filters are a conjunction containing a "simple"
+   * operand are cached by the values of that operand. Their filters still
+   * need to be evaluated for each candidate service.
+   */
+  CacheType conjunctionCache[HASHED_KEYS_COUNT];
 
   ServiceListenerEntries serviceSet;
 
   CoreBundleContext* coreCtx;
 
+  /* Set if service events are delivered asynchronously */
+  detail::Atomic<std::shared_ptr<ServiceEventDispatcher>> dispatcher;
+
 public:
   ServiceListeners(CoreBundleContext* coreCtx);
 
+  /**
+   * Configures the delivery of service events from the framework
+   * properties.
+   */
+  void Init();
+
   void Clear();
 
   /**
@@ -221,16 +258,33 @@ public:
                       const ServiceEvent& evt);
 
   /**
-   *
-   *
+   * Collects the service listeners whose filters match the service of the
+   * given event. Only the listeners cached for the service's object classes,
+   * id and pid, and the listeners with complicated filters, are examined.
    */
   void GetMatchingServiceListeners(const ServiceEvent& evt,
                                    ServiceListenerEntries& listeners);
 
+  /**
+   * Delivers a sequence of service events, in order. The cached listeners
+   * of all affected services are collected with a single acquisition of
+   * the listener lock.
+   */
+  void ServiceChanged(const std::vector<ServiceEvent>& events);
+
   std::vector<ServiceListenerHook::ListenerInfo> GetListenerInfoCollection()
     const;
 
+  Framework::ServiceEventDeliveryStatistics GetServiceEventDeliveryStatistics()
+    const;
+
 private:
+  /**
+   * Calls a service listener, reporting exceptions as framework events.
+   */
+  void CallServiceListener(const ServiceListenerEntry& l,
+                           const ServiceEvent& evt);
+
   /**
    * Factory method that returns an unique ListenerToken object.
    * Called by methods which add listeners.
@@ -249,10 +303,41 @@ private:
    */
   void CheckSimple_unlocked(const ServiceListenerEntry& sle);
 
-  void AddToSet_unlocked(ServiceListenerEntries& set,
-                         const ServiceListenerEntries& receivers,
-                         int cache_ix,
-                         const std::string& val);
+  /**
+   * Reads the values of the hashed keys from the given service properties.
+   */
+  void GetHashedServiceValues(const PropertiesHandle& props,
+                              HashedServiceValues& values) const;
+
+  /**
+   * Collects the cached listener lists matching the given values, and the
+   * listeners with complicated filters.
+   */
+  void GetCachedListeners_unlocked(
+    const HashedServiceValues& values,
+    std::vector<ServiceListenerBucket>& exact,
+    std::vector<ServiceListenerBucket>& candidates) const;
+
+  /**
+   * Adds the listeners in <code>exact</code>, and the listeners in
+   * <code>candidates</code> whose filters match <code>props</code>, to
+   * <code>set</code>. If <code>receivers</code> is not null, only
+   * listeners contained in it are added.
+   */
+  void AddMatchingListeners(const std::vector<ServiceListenerBucket>& exact,
+                            const std::vector<ServiceListenerBucket>& candidates,
+                            const PropertiesHandle& props,
+                            const ServiceListenerEntries* receivers,
+                            ServiceListenerEntries& set) const;
+
+  /**
+   * Collects the cached listener lists for the value <code>val</code> of
+   * the hashed key with index <code>cache_ix</code>.
+   */
+  void AddToBuckets_unlocked(std::vector<ServiceListenerBucket>& exact,
+                             std::vector<ServiceListenerBucket>& candidates,
+                             int cache_ix,
+                             const std::string& val) const;
 
   /**
    * Removes service listeners registered using the legacy
@@ -54,7 +54,7 @@ void ServiceReferenceBase::SetInterfaceId(const std::string& interfaceId)
     --d.load()->ref;
     d = new ServiceReferenceBasePrivate(d.load()->registration);
   }
-  d.load()->interfaceId = interfaceId;
+  d.load()->SetInterfaceId(interfaceId);
 }
 
 ServiceReferenceBase::operator bool() const
@@ -211,7 +211,8 @@ bool ServiceReferenceBase::IsConvertibleTo(const std::string& interfaceId) const
 
 std::string ServiceReferenceBase::GetInterfaceId() const
 {
-  return d.load()->interfaceId;
+  auto interned = d.load()->interfaceId;
+  return interned ? interned->name : std::string();
 }
 
 std::size_t ServiceReferenceBase::Hash() const
@@ -49,6 +49,7 @@ ServiceReferenceBasePrivate::ServiceReferenceBasePrivate(
   ServiceRegistrationBasePrivate* reg)
   : ref(1)
   , registration(reg)
+  , interfaceId(nullptr)
 {
   if (registration)
     ++registration->ref;
@@ -145,12 +146,14 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetPrototypeService(
   InterfaceMapConstPtr s;
   {
     if (registration->available) {
-      auto factory = std::static_pointer_cast<ServiceFactory>(
-        registration->GetService("org.cppmicroservices.factory"));
-      s = GetServiceFromFactory(GetPrivate(bundle).get(), factory);
-      registration->Lock(),
-        registration->prototypeServiceInstances[GetPrivate(bundle).get()]
-          .push_back(s);
+      auto factory = (registration->Lock(),
+                      registration->GetServiceFactory_unlocked());
+      auto b = GetPrivate(bundle).get();
+      s = GetServiceFromFactory(b, factory);
+      auto l = registration->Lock();
+      US_UNUSED(l);
+      registration->prototypeServiceInstances[b].push_back(s);
+      b->coreCtx->services.AddServiceUser(b, registration);
     }
   }
   return s;
@@ -159,11 +162,25 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetPrototypeService(
 std::shared_ptr<void> ServiceReferenceBasePrivate::GetService(
   BundlePrivate* bundle)
 {
-  return ExtractInterface(GetServiceInterfaceMap(bundle), interfaceId);
+  std::shared_ptr<void> registered;
+  auto s = GetServiceInterfaceMap(bundle, &registered);
+  if (registered || !s) {
+    return registered;
+  }
+  // The objects of service factories are looked up by name, and a
+  // reference without interface id returns any interface of the service.
+  return ExtractInterface(s, interfaceId ? interfaceId->name : std::string());
 }
 
 InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
   BundlePrivate* bundle)
+{
+  return GetServiceInterfaceMap(bundle, nullptr);
+}
+
+InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
+  BundlePrivate* bundle,
+  std::shared_ptr<void>* registeredInterface)
 {
   /*
    * Detect recursive service factory calls. For each thread, this
@@ -183,6 +200,13 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
   InterfaceMapConstPtr s;
   if (!registration->available)
     return s;
+
+  // Repeated gets of a service which is not created by a factory only
+  // increment the use count of the bundle.
+  s = registration->TryGetService(bundle, interfaceId, registeredInterface);
+  if (s) {
+    return s;
+  }
   std::shared_ptr<ServiceFactory> serviceFactory;
 
   std::unordered_set<ServiceRegistrationBasePrivate*>* marks = nullptr;
@@ -204,17 +228,23 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
     US_UNUSED(l);
     if (!registration->available)
       return s;
-    serviceFactory = std::static_pointer_cast<ServiceFactory>(
-      registration->GetService_unlocked("org.cppmicroservices.factory"));
+    serviceFactory = registration->GetServiceFactory_unlocked();
 
-    auto res = registration->dependents.insert(std::make_pair(bundle, 0));
-    auto& depCounter = res.first->second;
+    bool inserted = false;
+    auto& depCounter = registration->AddDependent_unlocked(bundle, inserted);
+    if (inserted) {
+      bundle->coreCtx->services.AddServiceUser(bundle, registration);
+    }
 
     // No service factory, just return the registered service directly.
     if (!serviceFactory) {
       s = registration->service;
       if (s && !s->empty()) {
         ++depCounter;
+        if (registeredInterface && interfaceId) {
+          *registeredInterface =
+            registration->GetService_unlocked(interfaceId->id);
+        }
       }
       return s;
     }
@@ -257,7 +287,11 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
   auto l = registration->Lock();
   US_UNUSED(l);
 
-  registration->dependents.insert(std::make_pair(bundle, 0));
+  bool inserted = false;
+  auto& depCounter = registration->AddDependent_unlocked(bundle, inserted);
+  if (inserted) {
+    bundle->coreCtx->services.AddServiceUser(bundle, registration);
+  }
 
   if (s && !s->empty()) {
     // Insert a cached service object instance only if one isn't already cached. If another thread
@@ -266,14 +300,14 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
     auto insertResultPair =
       registration->bundleServiceInstance.insert(std::make_pair(bundle, s));
     s = insertResultPair.first->second;
-    ++registration->dependents.at(bundle);
+    ++depCounter;
   } else {
     // If the service factory returned an invalid service object check the cache and return a valid one
     // if it exists.
     if (registration->bundleServiceInstance.end() !=
         registration->bundleServiceInstance.find(bundle)) {
       s = registration->bundleServiceInstance.at(bundle);
-      ++registration->dependents.at(bundle);
+      ++depCounter;
     }
   }
   return s;
@@ -295,8 +329,7 @@ bool ServiceReferenceBasePrivate::UngetPrototypeService(
     }
 
     prototypeServiceMaps = iter->second;
-    sf = std::static_pointer_cast<ServiceFactory>(
-      registration->GetService_unlocked("org.cppmicroservices.factory"));
+    sf = registration->GetServiceFactory_unlocked();
   }
 
   if (!sf)
@@ -332,6 +365,10 @@ bool ServiceReferenceBasePrivate::UngetPrototypeService(
         iter->second.erase(serviceIter);
       if (iter->second.empty()) {
         registration->prototypeServiceInstances.erase(iter);
+        if (registration->dependents.count(bundle.get()) == 0) {
+          bundle->coreCtx->services.RemoveServiceUser(bundle.get(),
+                                                      registration);
+        }
       }
       return true;
     }
@@ -349,6 +386,11 @@ bool ServiceReferenceBasePrivate::UngetService(
   InterfaceMapConstPtr sfi;
   std::shared_ptr<ServiceFactory> sf;
 
+  if (checkRefCounter &&
+      registration->TryRemoveDependentReference(bundle.get())) {
+    return false;
+  }
+
   {
     auto l = registration->Lock();
     US_UNUSED(l);
@@ -357,18 +399,17 @@ bool ServiceReferenceBasePrivate::UngetService(
       return hadReferences && removeService;
     }
 
-    int& count = depIter->second;
-    if (count > 0) {
-      hadReferences = true;
-    }
-
+    // Lock-free gets may increment the count concurrently, but never
+    // from zero.
+    auto& counter = *depIter->second;
     if (checkRefCounter) {
-      if (count > 1) {
-        --count;
-      } else if (count == 1) {
-        removeService = true;
+      auto count = counter.load();
+      while (count > 0 && !counter.compare_exchange_weak(count, count - 1)) {
       }
+      hadReferences = count > 0;
+      removeService = count == 1;
     } else {
+      hadReferences = counter.exchange(0) > 0;
       removeService = true;
     }
 
@@ -379,11 +420,14 @@ bool ServiceReferenceBasePrivate::UngetService(
       }
 
       if (sfi && !sfi->empty()) {
-        sf = std::static_pointer_cast<ServiceFactory>(
-          registration->GetService_unlocked("org.cppmicroservices.factory"));
+        sf = registration->GetServiceFactory_unlocked();
       }
       registration->bundleServiceInstance.erase(bundle.get());
       registration->dependents.erase(bundle.get());
+      if (registration->prototypeServiceInstances.count(bundle.get()) == 0) {
+        bundle->coreCtx->services.RemoveServiceUser(bundle.get(),
+                                                    registration);
+      }
     }
   }
 
@@ -424,4 +468,19 @@ bool ServiceReferenceBasePrivate::IsConvertibleTo(
   }
   return false;
 }
+
+void ServiceReferenceBasePrivate::SetInterfaceId(
+  const std::string& interfaceId)
+{
+  const InternedInterface* interned = nullptr;
+  if (!interfaceId.empty()) {
+    if (registration) {
+      interned = registration->interfaces.FindInterned(interfaceId);
+    }
+    if (!interned) {
+      interned = InterfaceIdTable::Instance().Intern(interfaceId);
+    }
+  }
+  this->interfaceId = interned;
+}
 }
@@ -25,6 +25,8 @@
 
 #include "cppmicroservices/ServiceInterface.h"
 
+#include "InterfaceIdTable.h"
+
 #include <atomic>
 #include <string>
 
@@ -101,6 +103,13 @@ public:
 
   bool IsConvertibleTo(const std::string& interfaceId) const;
 
+  /**
+   * Set the interned interface id of this reference. The interfaces of the
+   * service were interned when it was registered, so this only interns
+   * <code>interfaceId</code> if it is not one of them.
+   */
+  void SetInterfaceId(const std::string& interfaceId);
+
   /**
    * Reference count for implicitly shared private implementation.
    */
@@ -112,11 +121,22 @@ public:
   ServiceRegistrationBasePrivate* const registration;
 
   /**
-   * The service interface id for this reference.
+   * The interned service interface id for this reference, or nullptr if
+   * the reference has no interface id.
    */
-  std::string interfaceId;
+  const InternedInterface* interfaceId;
 
 private:
+  /**
+   * Get the service object map for <code>bundle</code>. If the service is
+   * not created by a service factory, <code>registeredInterface</code> is
+   * set to the object registered for <code>interfaceId</code>, looked up
+   * by its interned id.
+   */
+  InterfaceMapConstPtr GetServiceInterfaceMap(
+    BundlePrivate* bundle,
+    std::shared_ptr<void>* registeredInterface);
+
   InterfaceMapConstPtr GetServiceFromFactory(
     BundlePrivate* bundle,
     const std::shared_ptr<ServiceFactory>& factory);
@@ -23,8 +23,6 @@
 #include "cppmicroservices/ServiceRegistrationBase.h"
 
 #include "cppmicroservices/Bundle.h"
-#include "cppmicroservices/FrameworkEvent.h"
-#include "cppmicroservices/ServiceFactory.h"
 
 #include "BundlePrivate.h"
 #include "CoreBundleContext.h"
@@ -177,9 +175,8 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
     d->properties = Properties(std::move(propsCopy));
   }
   if (old_rank != new_rank) {
-    auto classes = any_cast<std::vector<std::string>>(objectClasses);
     if (auto bundle = d->bundle.lock()) {
-      bundle->coreCtx->services.UpdateServiceRegistrationOrder(classes);
+      bundle->coreCtx->services.UpdateServiceRegistrationOrder(*this);
     }
   }
 
@@ -233,84 +230,7 @@ void ServiceRegistrationBase::Unregister()
     coreContext->listeners.ServiceChanged(listeners, unregisteringEvent);
   }
 
-  std::shared_ptr<ServiceFactory> serviceFactory;
-  ServiceRegistrationBasePrivate::BundleToServicesMap prototypeServiceInstances;
-  ServiceRegistrationBasePrivate::BundleToServiceMap bundleServiceInstance;
-
-  {
-    auto l = d->Lock();
-    US_UNUSED(l);
-    d->available = false;
-    auto factoryIter = d->service->find("org.cppmicroservices.factory");
-    if (auto bundle = d->bundle.lock() && factoryIter != d->service->end()) {
-      if (bundle) {
-        serviceFactory =
-          std::static_pointer_cast<ServiceFactory>(factoryIter->second);
-      }
-    }
-    if (serviceFactory) {
-      prototypeServiceInstances = d->prototypeServiceInstances;
-      bundleServiceInstance = d->bundleServiceInstance;
-    }
-  }
-
-  if (serviceFactory) {
-    // unget all prototype services
-    for (auto const& i : prototypeServiceInstances) {
-      for (auto const& service : i.second) {
-        try {
-          serviceFactory->UngetService(
-            MakeBundle(i.first->shared_from_this()), *this, service);
-        } catch (const std::exception& ex) {
-          std::string message(
-            "ServiceFactory UngetService implementation threw an exception");
-          if (auto bundle = d->bundle.lock()) {
-            bundle->coreCtx->listeners.SendFrameworkEvent(FrameworkEvent(
-              FrameworkEvent::Type::FRAMEWORK_ERROR,
-              MakeBundle(bundle->shared_from_this()),
-              message,
-              std::make_exception_ptr(ServiceException(
-                ex.what(), ServiceException::Type::FACTORY_EXCEPTION))));
-          }
-        }
-      }
-    }
-
-    // unget bundle scope services
-    for (auto const& i : bundleServiceInstance) {
-      try {
-        serviceFactory->UngetService(
-          MakeBundle(i.first->shared_from_this()), *this, i.second);
-      } catch (const std::exception& ex) {
-        std::string message(
-          "ServiceFactory UngetService implementation threw an exception");
-        if (auto bundle = d->bundle.lock()) {
-          bundle->coreCtx->listeners.SendFrameworkEvent(FrameworkEvent(
-            FrameworkEvent::Type::FRAMEWORK_ERROR,
-            MakeBundle(bundle->shared_from_this()),
-            message,
-            std::make_exception_ptr(ServiceException(
-              ex.what(), ServiceException::Type::FACTORY_EXCEPTION))));
-        }
-      }
-    }
-  }
-
-  {
-    auto l = d->Lock();
-    US_UNUSED(l);
-
-    d->bundle.reset();
-    d->dependents.clear();
-    d->service.reset();
-    d->prototypeServiceInstances.clear();
-    d->bundleServiceInstance.clear();
-    // increment the reference count, since "d->reference" was used originally
-    // to keep d alive.
-    ++d->ref;
-    d->reference = nullptr;
-    d->unregistering = false;
-  }
+  d->FinishUnregister(*this);
 }
 
 bool ServiceRegistrationBase::operator<(const ServiceRegistrationBase& o) const
@@ -22,7 +22,14 @@
 
 #include "ServiceRegistrationBasePrivate.h"
 #include "BundlePrivate.h"
+#include "CoreBundleContext.h"
 
+#include "cppmicroservices/Bundle.h"
+#include "cppmicroservices/FrameworkEvent.h"
+#include "cppmicroservices/ServiceException.h"
+#include "cppmicroservices/ServiceFactory.h"
+
+#include <thread>
 #include <utility>
 
 #ifdef _MSC_VER
@@ -38,7 +45,13 @@ ServiceRegistrationBasePrivate::ServiceRegistrationBasePrivate(
   Properties&& props)
   : ref(0)
   , service(std::move(service))
+  , interfaces(this->service ? FlatInterfaceMap(*this->service)
+                             : FlatInterfaceMap())
+  , dependentSlots(nullptr)
+  , lockFreeReaders(0)
+  , isFactory(interfaces.Contains(InterfaceIdTable::FACTORY_ID))
   , bundle(bundle_->shared_from_this())
+  , coreCtx(bundle_->coreCtx)
   , reference(this)
   , properties(std::move(props))
   , available(true)
@@ -51,6 +64,11 @@ ServiceRegistrationBasePrivate::ServiceRegistrationBasePrivate(
 ServiceRegistrationBasePrivate::~ServiceRegistrationBasePrivate()
 {
   properties.Lock(), properties.Clear_unlocked();
+  for (auto slot = dependentSlots.load(); slot;) {
+    auto next = slot->next;
+    delete slot;
+    slot = next;
+  }
 }
 
 bool ServiceRegistrationBasePrivate::IsUsedByBundle(BundlePrivate* bundle) const
@@ -73,11 +91,209 @@ std::shared_ptr<void> ServiceRegistrationBasePrivate::GetService(
   return this->Lock(), GetService_unlocked(interfaceId);
 }
 
+void ServiceRegistrationBasePrivate::FinishUnregister(
+  const ServiceRegistrationBase& registration)
+{
+  std::shared_ptr<ServiceFactory> serviceFactory;
+  BundleToServicesMap prototypeInstances;
+  BundleToServiceMap bundleInstance;
+
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+    available = false;
+    if (bundle.lock()) {
+      serviceFactory = GetServiceFactory_unlocked();
+    }
+    if (serviceFactory) {
+      prototypeInstances = prototypeServiceInstances;
+      bundleInstance = bundleServiceInstance;
+    }
+  }
+
+  auto reportUngetError = [this](const std::exception& ex) {
+    std::string message(
+      "ServiceFactory UngetService implementation threw an exception");
+    if (auto b = bundle.lock()) {
+      b->coreCtx->listeners.SendFrameworkEvent(FrameworkEvent(
+        FrameworkEvent::Type::FRAMEWORK_ERROR,
+        MakeBundle(b->shared_from_this()),
+        message,
+        std::make_exception_ptr(ServiceException(
+          ex.what(), ServiceException::Type::FACTORY_EXCEPTION))));
+    }
+  };
+
+  if (serviceFactory) {
+    // unget all prototype services
+    for (auto const& i : prototypeInstances) {
+      for (auto const& instance : i.second) {
+        try {
+          serviceFactory->UngetService(
+            MakeBundle(i.first->shared_from_this()), registration, instance);
+        } catch (const std::exception& ex) {
+          reportUngetError(ex);
+        }
+      }
+    }
+
+    // unget bundle scope services
+    for (auto const& i : bundleInstance) {
+      try {
+        serviceFactory->UngetService(
+          MakeBundle(i.first->shared_from_this()), registration, i.second);
+      } catch (const std::exception& ex) {
+        reportUngetError(ex);
+      }
+    }
+  }
+
+  std::vector<BundlePrivate*> users;
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+
+    for (auto& dependent : dependents) {
+      users.push_back(dependent.first);
+    }
+    for (auto& instances : prototypeServiceInstances) {
+      if (dependents.count(instances.first) == 0) {
+        users.push_back(instances.first);
+      }
+    }
+
+    bundle.reset();
+    for (auto& dependent : dependents) {
+      *dependent.second = 0;
+    }
+    dependents.clear();
+    // available is false, so new lock-free readers back off
+    while (lockFreeReaders != 0) {
+      std::this_thread::yield();
+    }
+    service.reset();
+    interfaces.Clear();
+    prototypeServiceInstances.clear();
+    bundleServiceInstance.clear();
+    // increment the reference count, since "reference" was used originally
+    // to keep this object alive.
+    ++ref;
+    reference = nullptr;
+    unregistering = false;
+  }
+
+  // The used-service entries must go even if the registering bundle is
+  // already gone, otherwise they keep pointing at this registration.
+  for (auto user : users) {
+    coreCtx->services.RemoveServiceUser(user, this);
+  }
+}
+
 std::shared_ptr<void> ServiceRegistrationBasePrivate::GetService_unlocked(
   const std::string& interfaceId) const
 {
   return ExtractInterface(service, interfaceId);
 }
+
+std::shared_ptr<void> ServiceRegistrationBasePrivate::GetService_unlocked(
+  InterfaceId interfaceId) const
+{
+  return interfaces.Find(interfaceId);
+}
+
+std::shared_ptr<ServiceFactory>
+ServiceRegistrationBasePrivate::GetServiceFactory_unlocked() const
+{
+  return std::static_pointer_cast<ServiceFactory>(
+    interfaces.Find(InterfaceIdTable::FACTORY_ID));
+}
+
+InterfaceMapConstPtr ServiceRegistrationBasePrivate::TryGetService(
+  BundlePrivate* bundle,
+  const InternedInterface* interfaceId,
+  std::shared_ptr<void>* registeredInterface)
+{
+  if (isFactory) {
+    return nullptr;
+  }
+
+  // Announce the read before checking availability, so that either
+  // FinishUnregister waits for this reader or this reader sees the
+  // service as unavailable.
+  ++lockFreeReaders;
+  struct Release
+  {
+    ~Release() { --r; }
+    std::atomic<int>& r;
+  } release{ lockFreeReaders };
+  US_UNUSED(release);
+
+  if (!available) {
+    return nullptr;
+  }
+
+  for (auto slot = dependentSlots.load(); slot; slot = slot->next) {
+    if (slot->bundle != bundle) {
+      continue;
+    }
+    // A zero count is only incremented under the lock, because the
+    // bundle may have to be (re-)added to the dependents.
+    auto count = slot->count.load();
+    while (count > 0) {
+      if (slot->count.compare_exchange_weak(count, count + 1)) {
+        if (registeredInterface && interfaceId) {
+          *registeredInterface = interfaces.Find(interfaceId->id);
+        }
+        return service;
+      }
+    }
+    return nullptr;
+  }
+  return nullptr;
+}
+
+bool ServiceRegistrationBasePrivate::TryRemoveDependentReference(
+  BundlePrivate* bundle)
+{
+  for (auto slot = dependentSlots.load(); slot; slot = slot->next) {
+    if (slot->bundle != bundle) {
+      continue;
+    }
+    auto count = slot->count.load();
+    while (count > 1) {
+      if (slot->count.compare_exchange_weak(count, count - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
+std::atomic<int>& ServiceRegistrationBasePrivate::AddDependent_unlocked(
+  BundlePrivate* bundle,
+  bool& inserted)
+{
+  auto iter = dependents.find(bundle);
+  inserted = (iter == dependents.end());
+  if (!inserted) {
+    return *iter->second;
+  }
+
+  // Reuse the slot of a bundle which used this service before. Its count
+  // is zero, since the bundle was removed from the dependents.
+  auto head = dependentSlots.load();
+  auto slot = head;
+  while (slot && slot->bundle != bundle) {
+    slot = slot->next;
+  }
+  if (!slot) {
+    slot = new DependentSlot(bundle, head);
+    dependentSlots = slot;
+  }
+  dependents.emplace(bundle, &slot->count);
+  return slot->count;
+}
 }
 
 #ifdef _MSC_VER
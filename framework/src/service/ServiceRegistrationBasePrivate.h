@@ -27,6 +27,7 @@
 #include "cppmicroservices/ServiceReference.h"
 #include "cppmicroservices/detail/Threads.h"
 
+#include "InterfaceIdTable.h"
 #include "Properties.h"
 
 #include <atomic>
@@ -34,6 +35,7 @@
 namespace cppmicroservices {
 
 class BundlePrivate;
+class CoreBundleContext;
 class ServiceRegistrationBase;
 
 /**
@@ -62,8 +64,50 @@ protected:
    */
   InterfaceMapConstPtr service;
 
+  /**
+   * The entries of <code>service</code>, by interned interface id. Empty
+   * once <code>service</code> was reset.
+   */
+  FlatInterfaceMap interfaces;
+
+  /**
+   * The use count of a bundle which got this service. Slots are prepended
+   * to a list under the lock and are not deleted before this object, so
+   * that they can be read without the lock.
+   */
+  struct DependentSlot
+  {
+    DependentSlot(BundlePrivate* bundle, DependentSlot* next)
+      : bundle(bundle)
+      , count(0)
+      , next(next)
+    {}
+
+    BundlePrivate* const bundle;
+    std::atomic<int> count;
+    DependentSlot* const next;
+  };
+
+  /**
+   * Head of the list of dependent slots, one per bundle.
+   */
+  std::atomic<DependentSlot*> dependentSlots;
+
+  /**
+   * Number of threads reading <code>service</code> and
+   * <code>interfaces</code> without the lock. FinishUnregister waits for
+   * them before releasing the service object.
+   */
+  std::atomic<int> lockFreeReaders;
+
+  /**
+   * Is <code>service</code> created by a ServiceFactory.
+   */
+  const bool isFactory;
+
 public:
-  using BundleToRefsMap = std::unordered_map<BundlePrivate*, int>;
+  using BundleToRefsMap =
+    std::unordered_map<BundlePrivate*, std::atomic<int>*>;
   using BundleToServiceMap =
     std::unordered_map<BundlePrivate*, InterfaceMapConstPtr>;
   using BundleToServicesMap =
@@ -75,8 +119,9 @@ public:
     const ServiceRegistrationBasePrivate&) = delete;
 
   /**
-   * Bundles dependent on this service. Integer is used as
-   * reference counter, counting number of unbalanced getService().
+   * Bundles dependent on this service. The counter counts the number of
+   * unbalanced getService() calls and is zero whenever the bundle is not
+   * a dependent, so that TryAddDependentReference() cannot revive it.
    */
   BundleToRefsMap dependents;
 
@@ -95,6 +140,13 @@ public:
    */
   std::weak_ptr<BundlePrivate> bundle;
 
+  /**
+   * Framework this service is registered with. Unlike the registering
+   * bundle it stays valid until the registration has been unregistered,
+   * which always happens before the framework is destroyed.
+   */
+  CoreBundleContext* const coreCtx;
+
   /**
    * Reference object to this service registration.
    */
@@ -132,12 +184,69 @@ public:
    */
   bool IsUsedByBundle(BundlePrivate* bundle) const;
 
+  /**
+   * Releases the service objects of an unregistered service. Must be
+   * called after the SERVICE_UNREGISTERING event was delivered.
+   *
+   * @param registration The registration this object belongs to.
+   */
+  void FinishUnregister(const ServiceRegistrationBase& registration);
+
   InterfaceMapConstPtr GetInterfaces() const;
 
   std::shared_ptr<void> GetService(const std::string& interfaceId) const;
 
   std::shared_ptr<void> GetService_unlocked(
     const std::string& interfaceId) const;
+
+  /**
+   * Get the service object registered for an interned interface id.
+   * The caller must hold the lock of this object.
+   */
+  std::shared_ptr<void> GetService_unlocked(InterfaceId interfaceId) const;
+
+  /**
+   * Get the ServiceFactory of this registration, or nullptr if the
+   * service object is not created by a factory. The caller must hold the
+   * lock of this object.
+   */
+  std::shared_ptr<ServiceFactory> GetServiceFactory_unlocked() const;
+
+  /**
+   * Get the service object of a service which is not created by a
+   * ServiceFactory, without locking, for a bundle which already uses it.
+   * Increments the use count of the bundle on success.
+   *
+   * @param bundle The bundle getting the service.
+   * @param interfaceId The interface to look up, or nullptr.
+   * @param registeredInterface Receives the object registered for
+   *        <code>interfaceId</code>, if both are not nullptr.
+   * @return The service object, or nullptr if the caller must get the
+   *         service under the lock.
+   */
+  InterfaceMapConstPtr TryGetService(
+    BundlePrivate* bundle,
+    const InternedInterface* interfaceId,
+    std::shared_ptr<void>* registeredInterface);
+
+  /**
+   * Decrement the use count of a bundle without locking, unless it is the
+   * last use of the service by the bundle.
+   *
+   * @return true if the use count was decremented.
+   */
+  bool TryRemoveDependentReference(BundlePrivate* bundle);
+
+  /**
+   * Add a bundle to the dependents. The caller must hold the lock of
+   * this object.
+   *
+   * @param bundle The bundle getting the service.
+   * @param inserted Set to true if the bundle was not a dependent before.
+   * @return The use count of the bundle.
+   */
+  std::atomic<int>& AddDependent_unlocked(BundlePrivate* bundle,
+                                          bool& inserted);
 };
 }
 
@@ -27,21 +27,75 @@
 
 #include "BundlePrivate.h"
 #include "CoreBundleContext.h"
+#include "LDAPExprCache.h"
 #include "ServiceRegistrationBasePrivate.h"
 
 #include <cassert>
 #include <iterator>
 #include <stdexcept>
+#include <unordered_set>
 
 namespace cppmicroservices {
 
+namespace {
+
+ServiceRegistry::RankingKey GetRankingKey(const Properties& properties)
+{
+  auto l = properties.Lock();
+  US_UNUSED(l);
+  const Any& ranking = properties.Value_unlocked(
+    properties.Find_unlocked(Constants::SERVICE_RANKING));
+  const Any& id = properties.Value_unlocked(
+    properties.Find_unlocked(Constants::SERVICE_ID));
+  // Registering a service or setting its properties rejects rankings
+  // which are not an int.
+  return { ranking.Empty() ? 0 : any_cast<int>(ranking), any_cast<long>(id) };
+}
+}
+
+template<typename Classes>
+void ServiceRegistry::PublishSnapshot_unlocked(const Classes& classes,
+                                               bool servicesChanged)
+{
+  if (classes.empty()) {
+    return;
+  }
+  auto next = std::make_shared<Snapshot>(*snapshot.Load());
+  for (auto& clazz : classes) {
+    next->classServices.erase(clazz);
+    auto s = classServices.find(clazz);
+    if (s == classServices.end()) {
+      continue;
+    }
+    auto regs = std::make_shared<Snapshot::ClassServices>();
+    regs->clazz = clazz;
+    regs->services.reserve(s->second.size());
+    for (auto& ranked : s->second) {
+      regs->services.push_back(ranked.second);
+    }
+    std::string_view key(regs->clazz);
+    next->classServices.emplace(key, std::move(regs));
+  }
+  if (servicesChanged) {
+    auto all = std::make_shared<std::vector<ServiceRegistrationBase>>();
+    all->reserve(services.size());
+    for (auto& entry : services) {
+      all->push_back(entry.second.registration);
+    }
+    next->services = std::move(all);
+  }
+  snapshot.Store(std::move(next));
+}
+
 void ServiceRegistry::Clear()
 {
   auto l = this->Lock();
   US_UNUSED(l);
   services.clear();
   classServices.clear();
-  serviceRegistrations.clear();
+  bundleServices.clear();
+  bundleUsedServices.Lock(), bundleUsedServices.value.clear();
+  snapshot.Store(std::make_shared<const Snapshot>());
 }
 
 Properties ServiceRegistry::CreateServiceProperties(
@@ -77,12 +131,15 @@ Properties ServiceRegistry::CreateServiceProperties(
 
 ServiceRegistry::ServiceRegistry(CoreBundleContext* coreCtx)
   : core(coreCtx)
-{}
+{
+  snapshot.Store(std::make_shared<const Snapshot>());
+}
 
-ServiceRegistrationBase ServiceRegistry::RegisterService(
+ServiceRegistrationBase ServiceRegistry::CreateServiceRegistration(
   BundlePrivate* bundle,
   const InterfaceMapConstPtr& service,
-  const ServiceProperties& properties)
+  const ServiceProperties& properties,
+  std::vector<std::string>& classes)
 {
   if (!service || service->empty()) {
     throw std::invalid_argument(
@@ -98,7 +155,6 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(
              service->find("org.cppmicroservices.factory")->second)))
        : false);
 
-  std::vector<std::string> classes;
   // Check if service implements claimed classes and that they exist.
   for (auto i : *service) {
     if (i.first.empty() || (!isFactory && i.second == nullptr)) {
@@ -107,21 +163,39 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(
     classes.push_back(i.first);
   }
 
-  ServiceRegistrationBase res(
-    bundle,
-    service,
-    CreateServiceProperties(
-      properties, classes, isFactory, isPrototypeFactory));
+  Properties props = CreateServiceProperties(
+    properties, classes, isFactory, isPrototypeFactory);
+
+  // Services are ordered by int rankings, so other ranking types are
+  // rejected, like in ServiceRegistrationBase::SetProperties.
+  const Any& ranking =
+    props.Value_unlocked(props.Find_unlocked(Constants::SERVICE_RANKING));
+  if (!ranking.Empty()) {
+    try {
+      any_cast<int>(ranking);
+    } catch (const BadAnyCastException& ex) {
+      std::string exMsg("SERVICE_RANKING property has unexpected value type. ");
+      exMsg.append(ex.what());
+      throw std::invalid_argument(exMsg);
+    }
+  }
+
+  return ServiceRegistrationBase(bundle, service, std::move(props));
+}
+
+ServiceRegistrationBase ServiceRegistry::RegisterService(
+  BundlePrivate* bundle,
+  const InterfaceMapConstPtr& service,
+  const ServiceProperties& properties)
+{
+  std::vector<std::string> classes;
+  ServiceRegistrationBase res =
+    CreateServiceRegistration(bundle, service, properties, classes);
   {
     auto l = this->Lock();
     US_UNUSED(l);
-    services.insert(std::make_pair(res, classes));
-    serviceRegistrations.push_back(res);
-    for (auto& clazz : classes) {
-      auto& s = classServices[clazz];
-      auto ip = std::lower_bound(s.rbegin(), s.rend(), res);
-      s.insert(ip.base(), res);
-    }
+    AddServiceRegistration_unlocked(res, classes);
+    PublishSnapshot_unlocked(classes);
   }
 
   ServiceReferenceBase r = res.GetReference(std::string());
@@ -133,42 +207,147 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(
   return res;
 }
 
+std::vector<ServiceRegistrationBase> ServiceRegistry::RegisterServices(
+  BundlePrivate* bundle,
+  const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+    servicesToRegister)
+{
+  // Validate all services before any of them is registered
+  std::vector<ServiceRegistrationBase> res;
+  std::vector<std::vector<std::string>> resClasses(servicesToRegister.size());
+  res.reserve(servicesToRegister.size());
+  for (std::size_t i = 0; i < servicesToRegister.size(); ++i) {
+    res.push_back(CreateServiceRegistration(bundle,
+                                            servicesToRegister[i].first,
+                                            servicesToRegister[i].second,
+                                            resClasses[i]));
+  }
+
+  if (res.empty()) {
+    return res;
+  }
+
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+    std::unordered_set<std::string> classSet;
+    for (std::size_t i = 0; i < res.size(); ++i) {
+      AddServiceRegistration_unlocked(res[i], resClasses[i]);
+      classSet.insert(resClasses[i].begin(), resClasses[i].end());
+    }
+    PublishSnapshot_unlocked(classSet);
+  }
+
+  std::vector<ServiceEvent> registeredEvents;
+  registeredEvents.reserve(res.size());
+  for (auto& reg : res) {
+    registeredEvents.emplace_back(ServiceEvent::SERVICE_REGISTERED,
+                                  reg.GetReference(std::string()));
+  }
+  bundle->coreCtx->listeners.ServiceChanged(registeredEvents);
+  return res;
+}
+
+void ServiceRegistry::UnregisterServices(
+  const std::vector<ServiceRegistrationBase>& registrations)
+{
+  for (auto& sr : registrations) {
+    if (!sr.d) {
+      throw std::logic_error("ServiceRegistrationBase object invalid");
+    }
+    if (!sr.d->available) {
+      throw std::logic_error("Service is unregistered");
+    }
+    auto bundle = sr.d->bundle.lock();
+    if (bundle && bundle->coreCtx != core) {
+      throw std::invalid_argument(
+        "Service is registered with a different framework");
+    }
+  }
+
+  // Registrations which are already being unregistered by another thread,
+  // or which occur more than once, are skipped.
+  std::vector<ServiceRegistrationBase> unregistering;
+  for (auto& sr : registrations) {
+    bool isUnregistering(false); // expected state
+    if (atomic_compare_exchange_strong(
+          &sr.d->unregistering, &isUnregistering, true)) {
+      unregistering.push_back(sr);
+    }
+  }
+
+  // Services of bundles which are already gone are not in the registry
+  // anymore, no events are fired for them.
+  std::vector<ServiceEvent> unregisteringEvents;
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+    std::unordered_set<std::string> classSet;
+    for (auto& sr : unregistering) {
+      if (sr.d->bundle.lock() &&
+          RemoveServiceRegistration_unlocked(sr, &classSet)) {
+        unregisteringEvents.emplace_back(ServiceEvent::SERVICE_UNREGISTERING,
+                                         sr.d->reference);
+      }
+    }
+    PublishSnapshot_unlocked(classSet);
+  }
+
+  // Notify listeners. We must not hold any locks here.
+  core->listeners.ServiceChanged(unregisteringEvents);
+
+  for (auto& sr : unregistering) {
+    sr.d->FinishUnregister(sr);
+  }
+}
+
 void ServiceRegistry::UpdateServiceRegistrationOrder(
-  const std::vector<std::string>& classes)
+  const ServiceRegistrationBase& sr)
 {
+  // Concurrent property updates may call this in any order, the current
+  // ranking is always read again.
+  auto key = GetRankingKey(sr.d->properties);
+
   auto l = this->Lock();
   US_UNUSED(l);
-  for (auto& clazz : classes) {
+  auto i = services.find(key.id);
+  if (i == services.end()) {
+    return;
+  }
+  auto& entry = i->second;
+  if (entry.key.ranking == key.ranking) {
+    return;
+  }
+  for (auto& clazz : entry.classes) {
     auto& s = classServices[clazz];
-    std::sort(s.rbegin(), s.rend());
+    s.erase(entry.key);
+    s.emplace(key, sr);
   }
+  entry.key = key;
+  PublishSnapshot_unlocked(entry.classes, false);
 }
 
 void ServiceRegistry::Get(
   const std::string& clazz,
   std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
-  this->Lock(), Get_unlocked(clazz, serviceRegs);
-}
-
-void ServiceRegistry::Get_unlocked(
-  const std::string& clazz,
-  std::vector<ServiceRegistrationBase>& serviceRegs) const
-{
-  auto i = classServices.find(clazz);
-  if (i != classServices.end()) {
-    serviceRegs = i->second;
+  auto snap = GetSnapshot();
+  // The snapshot may still contain registrations which have been
+  // unregistered after it was published.
+  auto regs = GetClassServices(*snap, clazz);
+  for (auto& sr : *regs) {
+    if (sr.d->available) {
+      serviceRegs.push_back(sr);
+    }
   }
 }
 
 ServiceReferenceBase ServiceRegistry::Get(BundlePrivate* bundle,
                                           const std::string& clazz) const
 {
-  auto l = this->Lock();
-  US_UNUSED(l);
   try {
     std::vector<ServiceReferenceBase> srs;
-    Get_unlocked(clazz, "", bundle, srs);
+    Get(clazz, "", bundle, srs);
     DIAG_LOG(*core->sink) << "get service ref " << clazz << " for bundle "
                           << bundle->symbolicName << " = " << srs.size()
                           << " refs";
@@ -187,30 +366,24 @@ void ServiceRegistry::Get(const std::string& clazz,
                           BundlePrivate* bundle,
                           std::vector<ServiceReferenceBase>& res) const
 {
-  this->Lock(), Get_unlocked(clazz, filter, bundle, res);
-}
+  // Keep the snapshot alive for as long as we iterate over it.
+  auto snap = GetSnapshot();
 
-void ServiceRegistry::Get_unlocked(const std::string& clazz,
-                                   const std::string& filter,
-                                   BundlePrivate* bundle,
-                                   std::vector<ServiceReferenceBase>& res) const
-{
+  Snapshot::ServiceRegistrations classRegs;
   std::vector<ServiceRegistrationBase>::const_iterator s;
   std::vector<ServiceRegistrationBase>::const_iterator send;
   std::vector<ServiceRegistrationBase> v;
   LDAPExpr ldap;
+
   if (clazz.empty()) {
     if (!filter.empty()) {
-      ldap = LDAPExpr(filter);
+      ldap = LDAPExprCache::Instance().Get(filter);
       LDAPExpr::ObjectClassSet matched;
       if (ldap.GetMatchedObjectClasses(matched)) {
         v.clear();
         for (auto& className : matched) {
-          auto i = classServices.find(className);
-          if (i != classServices.end()) {
-            std::copy(
-              i->second.begin(), i->second.end(), std::back_inserter(v));
-          }
+          auto regs = GetClassServices(*snap, className);
+          std::copy(regs->begin(), regs->end(), std::back_inserter(v));
         }
         if (!v.empty()) {
           s = v.begin();
@@ -219,28 +392,42 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz,
           return;
         }
       } else {
-        s = serviceRegistrations.begin();
-        send = serviceRegistrations.end();
+        classRegs = snap->services;
+        s = classRegs->begin();
+        send = classRegs->end();
       }
     } else {
-      s = serviceRegistrations.begin();
-      send = serviceRegistrations.end();
+      classRegs = snap->services;
+      s = classRegs->begin();
+      send = classRegs->end();
     }
   } else {
-    auto it = classServices.find(clazz);
-    if (it != classServices.end()) {
-      s = it->second.begin();
-      send = it->second.end();
-    } else {
+    classRegs = GetClassServices(*snap, clazz);
+    if (classRegs->empty()) {
       return;
     }
+    s = classRegs->begin();
+    send = classRegs->end();
     if (!filter.empty()) {
-      ldap = LDAPExpr(filter);
+      ldap = LDAPExprCache::Instance().Get(filter);
     }
   }
 
   for (; s != send; ++s) {
-    ServiceReferenceBase sri = s->GetReference(clazz);
+    if (!s->d->available) {
+      continue;
+    }
+
+    // The service may get unregistered after the snapshot was published.
+    ServiceReferenceBase sri;
+    try {
+      sri = s->GetReference(clazz);
+    } catch (const std::logic_error&) {
+      continue;
+    }
+    if (!sri) {
+      continue;
+    }
 
     if (filter.empty() ||
         ldap.Evaluate(PropertiesHandle(s->d->properties, true), false)) {
@@ -266,28 +453,97 @@ void ServiceRegistry::RemoveServiceRegistration(
   RemoveServiceRegistration_unlocked(sr);
 }
 
-void ServiceRegistry::RemoveServiceRegistration_unlocked(
-  const ServiceRegistrationBase& sr)
+void ServiceRegistry::AddServiceRegistration_unlocked(
+  const ServiceRegistrationBase& sr,
+  const std::vector<std::string>& classes)
 {
-  std::vector<std::string> classes;
-  {
-    auto l2 = sr.d->properties.Lock();
-    US_UNUSED(l2);
-    assert(sr.d->properties.Value_unlocked(Constants::OBJECTCLASS).Type() ==
-           typeid(std::vector<std::string>));
-    classes = ref_any_cast<std::vector<std::string>>(
-      sr.d->properties.Value_unlocked(Constants::OBJECTCLASS));
-  }
-  services.erase(sr);
-  serviceRegistrations.erase(
-    std::remove(serviceRegistrations.begin(), serviceRegistrations.end(), sr),
-    serviceRegistrations.end());
+  auto key = GetRankingKey(sr.d->properties);
+  auto bundle = sr.d->bundle.lock().get();
+  services.emplace(key.id, ServiceEntry{ sr, bundle, classes, key });
   for (auto& clazz : classes) {
-    auto& s = classServices[clazz];
-    if (s.size() > 1) {
-      s.erase(std::remove(s.begin(), s.end(), sr), s.end());
-    } else {
-      classServices.erase(clazz);
+    classServices[clazz].emplace(key, sr);
+  }
+  bundleServices[bundle].emplace(key.id, sr);
+}
+
+bool ServiceRegistry::RemoveServiceRegistration_unlocked(
+  const ServiceRegistrationBase& sr,
+  std::unordered_set<std::string>* changedClasses)
+{
+  auto i = services.find(GetRankingKey(sr.d->properties).id);
+  if (i == services.end()) {
+    return false;
+  }
+  auto& entry = i->second;
+  for (auto& clazz : entry.classes) {
+    auto s = classServices.find(clazz);
+    if (s != classServices.end()) {
+      s->second.erase(entry.key);
+      if (s->second.empty()) {
+        classServices.erase(s);
+      }
+    }
+  }
+  auto b = bundleServices.find(entry.bundle);
+  if (b != bundleServices.end()) {
+    b->second.erase(i->first);
+    if (b->second.empty()) {
+      bundleServices.erase(b);
+    }
+  }
+  // The snapshot lists all services, so publish it after the erase
+  auto classes = std::move(entry.classes);
+  services.erase(i);
+  if (changedClasses) {
+    changedClasses->insert(classes.begin(), classes.end());
+  } else {
+    PublishSnapshot_unlocked(classes);
+  }
+  return true;
+}
+
+ServiceRegistry::SnapshotConstPtr ServiceRegistry::GetSnapshot() const
+{
+  return snapshot.Load();
+}
+
+ServiceRegistry::Snapshot::ServiceRegistrations
+ServiceRegistry::GetClassServices(const Snapshot& snap,
+                                  const std::string& clazz) const
+{
+  static const Snapshot::ServiceRegistrations noServices =
+    std::make_shared<const std::vector<ServiceRegistrationBase>>();
+
+  auto i = snap.classServices.find(clazz);
+  if (i == snap.classServices.end()) {
+    return noServices;
+  }
+  return Snapshot::ServiceRegistrations(i->second, &i->second->services);
+}
+
+void ServiceRegistry::AddServiceUser(
+  BundlePrivate* bundle,
+  ServiceRegistrationBasePrivate* registration)
+{
+  auto l = bundleUsedServices.Lock();
+  US_UNUSED(l);
+  auto& used = bundleUsedServices.value[bundle];
+  if (used.find(registration) == used.end()) {
+    used.emplace(registration, ServiceRegistrationBase(registration));
+  }
+}
+
+void ServiceRegistry::RemoveServiceUser(
+  BundlePrivate* bundle,
+  ServiceRegistrationBasePrivate* registration)
+{
+  auto l = bundleUsedServices.Lock();
+  US_UNUSED(l);
+  auto used = bundleUsedServices.value.find(bundle);
+  if (used != bundleUsedServices.value.end()) {
+    used->second.erase(registration);
+    if (used->second.empty()) {
+      bundleUsedServices.value.erase(used);
     }
   }
 }
@@ -299,11 +555,11 @@ void ServiceRegistry::GetRegisteredByBundle(
   auto l = this->Lock();
   US_UNUSED(l);
 
-  for (auto& sr : serviceRegistrations) {
-    if (auto bundle_ = sr.d->bundle.lock()) {
-      if (bundle_.get() == p) {
-        res.push_back(sr);
-      }
+  // in registration order
+  auto registered = bundleServices.find(p);
+  if (registered != bundleServices.end()) {
+    for (auto& sr : registered->second) {
+      res.push_back(sr.second);
     }
   }
 }
@@ -312,13 +568,25 @@ void ServiceRegistry::GetUsedByBundle(
   BundlePrivate* bundle,
   std::vector<ServiceRegistrationBase>& res) const
 {
-  auto l = this->Lock();
-  US_UNUSED(l);
-
-  for (const auto& serviceRegistration : serviceRegistrations) {
-    if (serviceRegistration.d->IsUsedByBundle(bundle)) {
-      res.push_back(serviceRegistration);
+  std::vector<ServiceRegistrationBase> used;
+  {
+    auto l = bundleUsedServices.Lock();
+    US_UNUSED(l);
+    auto i = bundleUsedServices.value.find(bundle);
+    if (i != bundleUsedServices.value.end()) {
+      for (auto& sr : i->second) {
+        used.push_back(sr.second);
+      }
     }
   }
+
+  // in registration order
+  std::map<long, ServiceRegistrationBase> byId;
+  for (auto& sr : used) {
+    byId.emplace(GetRankingKey(sr.d->properties).id, sr);
+  }
+  for (auto& sr : byId) {
+    res.push_back(sr.second);
+  }
 }
 }
@@ -27,11 +27,21 @@
 #include "cppmicroservices/ServiceRegistration.h"
 #include "cppmicroservices/detail/Threads.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 namespace cppmicroservices {
 
 class CoreBundleContext;
 class BundlePrivate;
 class Properties;
+class ServiceRegistrationBasePrivate;
 
 /**
  * Here we handle all the CppMicroServices services that are registered.
@@ -58,27 +68,114 @@ public:
     bool isPrototypeFactory = false,
     long sid = -1);
 
-  using MapServiceClasses =
-    std::unordered_map<ServiceRegistrationBase, std::vector<std::string>>;
-  using MapClassServices =
-    std::unordered_map<std::string, std::vector<ServiceRegistrationBase>>;
+  /**
+   * The position of a service in the ranking order of its classes: the
+   * highest ranked service first and, for equal rankings, the service
+   * with the lowest service id first.
+   */
+  struct RankingKey
+  {
+    int ranking;
+    long id;
+
+    bool operator<(const RankingKey& o) const
+    {
+      return ranking != o.ranking ? ranking > o.ranking : id < o.id;
+    }
+  };
+
+  /**
+   * A registered service, the class names under which it is registered
+   * and its current position in the ranking order.
+   */
+  struct ServiceEntry
+  {
+    ServiceRegistrationBase registration;
+    BundlePrivate* bundle;
+    std::vector<std::string> classes;
+    RankingKey key;
+  };
+
+  using MapServiceClasses = std::map<long, ServiceEntry>;
+  using RankedServices = std::map<RankingKey, ServiceRegistrationBase>;
+  using MapClassServices = std::unordered_map<std::string, RankedServices>;
+  using MapBundleServices =
+    std::unordered_map<BundlePrivate*,
+                       std::map<long, ServiceRegistrationBase>>;
+  using MapBundleUsedServices = std::unordered_map<
+    BundlePrivate*,
+    std::unordered_map<ServiceRegistrationBasePrivate*, ServiceRegistrationBase>>;
+
+  /**
+   * A view of the registered services, used by all service lookups.
+   * Snapshots are immutable, so readers never take the registry lock.
+   * Writers rebuild the registration lists of the classes they change
+   * and publish a new snapshot, which shares the lists of all other
+   * classes with the previous one.
+   */
+  struct Snapshot
+  {
+    using ServiceRegistrations =
+      std::shared_ptr<const std::vector<ServiceRegistrationBase>>;
+
+    /**
+     * The registrations of one class, ordered with the highest ranked
+     * service first.
+     */
+    struct ClassServices
+    {
+      std::string clazz;
+      std::vector<ServiceRegistrationBase> services;
+    };
+
+    /**
+     * Mapping of classname to registered services. The keys refer to the
+     * class name of the mapped ClassServices.
+     */
+    std::unordered_map<std::string_view, std::shared_ptr<const ClassServices>>
+      classServices;
+
+    /**
+     * All registrations, ordered by service id. Writers only rebuild this
+     * list when services are registered or unregistered.
+     */
+    ServiceRegistrations services =
+      std::make_shared<const std::vector<ServiceRegistrationBase>>();
+  };
+
+  using SnapshotConstPtr = std::shared_ptr<const Snapshot>;
 
   /**
    * All registered services in the current framework.
-   * Mapping of registered service to class names under which
-   * the service is registerd.
+   * Mapping of service id to registered service and the class names
+   * under which the service is registerd, ordered by service id.
    */
   MapServiceClasses services;
 
-  std::vector<ServiceRegistrationBase> serviceRegistrations;
-
   /**
    * Mapping of classname to registered service.
-   * The List of registered services are ordered with the highest
-   * ranked service first.
+   * The registered services are ordered with the highest ranked service
+   * first.
+   *
+   * This is the writer side state, guarded by the registry lock. Lookups
+   * use the last published Snapshot instead.
    */
   MapClassServices classServices;
 
+  /**
+   * Mapping of bundle to the services it registered, keyed by service id.
+   */
+  MapBundleServices bundleServices;
+
+  /**
+   * Mapping of bundle to the services it uses. This is updated while the
+   * lock of a registration is held, so it has its own lock.
+   */
+  struct : MultiThreaded<>
+  {
+    MapBundleUsedServices value;
+  } bundleUsedServices;
+
   CoreBundleContext* core;
 
   ServiceRegistry(const ServiceRegistry&) = delete;
@@ -99,6 +196,7 @@ public:
    * <li>The service object is 0.</li>
    * <li>The service parameter is not a ServiceFactory or an
    * instance of all the named classes in the classes parameter.</li>
+   * <li>The SERVICE_RANKING property is not an int.</li>
    * </ul>
    */
   ServiceRegistrationBase RegisterService(BundlePrivate* bundle,
@@ -106,12 +204,45 @@ public:
                                           const ServiceProperties& properties);
 
   /**
-   * Reorder registered services. Call this method if the ranking for
+   * Register several services in the framework wide register. All services
+   * are validated before any of them is registered. They are inserted with
+   * a single acquisition of the registry lock, and the SERVICE_REGISTERED
+   * events are delivered afterwards, in the order of <code>services</code>.
+   *
+   * @param bundle The bundle registering the services.
+   * @param services The service objects and their properties.
+   * @return The ServiceRegistration objects, in the order of
+   *         <code>services</code>.
+   * @exception std::invalid_argument If one of the services is invalid.
+   *
+   * @see RegisterService
+   */
+  std::vector<ServiceRegistrationBase> RegisterServices(
+    BundlePrivate* bundle,
+    const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+      services);
+
+  /**
+   * Unregister several services. The services are removed with a single
+   * acquisition of the registry lock and the SERVICE_UNREGISTERING events
+   * are delivered afterwards, in the order of <code>registrations</code>.
+   *
+   * @param registrations The registrations to unregister.
+   * @exception std::logic_error If one of the registrations is invalid or
+   *            already unregistered. No service is unregistered then.
+   * @exception std::invalid_argument If one of the services was registered
+   *            with a different framework.
+   */
+  void UnregisterServices(
+    const std::vector<ServiceRegistrationBase>& registrations);
+
+  /**
+   * Reorder a registered service. Call this method if the ranking for
    * a service registration has changed
    *
-   * @param classes is the list of classes whose entries need to be reordered
+   * @param sr The registration whose ranking has changed.
    */
-  void UpdateServiceRegistrationOrder(const std::vector<std::string>& classes);
+  void UpdateServiceRegistrationOrder(const ServiceRegistrationBase& sr);
 
   /**
    * Get all services implementing a certain class.
@@ -154,6 +285,26 @@ public:
    */
   void RemoveServiceRegistration(const ServiceRegistrationBase& sr);
 
+  /**
+   * Record that a bundle got a service object of a registration. Must be
+   * called with the registration's lock held, after the bundle was added
+   * to its dependents or prototype service instances.
+   *
+   * @param bundle The bundle using the service.
+   * @param registration The registration of the service.
+   */
+  void AddServiceUser(BundlePrivate* bundle,
+                      ServiceRegistrationBasePrivate* registration);
+
+  /**
+   * Record that a bundle released all service objects of a registration.
+   *
+   * @param bundle The bundle which used the service.
+   * @param registration The registration of the service.
+   */
+  void RemoveServiceUser(BundlePrivate* bundle,
+                         ServiceRegistrationBasePrivate* registration);
+
   /**
    * Get all services that a bundle has registered.
    *
@@ -173,19 +324,72 @@ public:
   void GetUsedByBundle(BundlePrivate* bundle,
                        std::vector<ServiceRegistrationBase>& serviceRegs) const;
 
+  /**
+   * Get the last published snapshot of the registered services.
+   * This never blocks on the registry lock.
+   *
+   * @return An immutable Snapshot object.
+   */
+  SnapshotConstPtr GetSnapshot() const;
+
+  /**
+   * Get the registrations of a class from a snapshot.
+   *
+   * @param snap The snapshot containing the class.
+   * @param clazz The class name.
+   * @return The registrations, ordered with the highest ranked first.
+   */
+  Snapshot::ServiceRegistrations GetClassServices(
+    const Snapshot& snap,
+    const std::string& clazz) const;
+
 private:
-  friend class ServiceHooks;
   friend class ServiceRegistrationBase;
 
-  void RemoveServiceRegistration_unlocked(const ServiceRegistrationBase& sr);
+  /**
+   * Add a registration to the writer side state. The caller publishes
+   * the changed classes.
+   */
+  void AddServiceRegistration_unlocked(const ServiceRegistrationBase& sr,
+                                       const std::vector<std::string>& classes);
+
+  /**
+   * Remove a registration from the writer side state and publish the
+   * changed classes, unless <code>changedClasses</code> is given.
+   *
+   * @param changedClasses Receives the classes to publish, if not null.
+   * @return <code>false</code> if the service was not registered.
+   */
+  bool RemoveServiceRegistration_unlocked(
+    const ServiceRegistrationBase& sr,
+    std::unordered_set<std::string>* changedClasses = nullptr);
+
+  /**
+   * Validates a service and creates its registration, without adding it
+   * to the registry.
+   *
+   * @param classes Receives the class names of the service.
+   */
+  static ServiceRegistrationBase CreateServiceRegistration(
+    BundlePrivate* bundle,
+    const InterfaceMapConstPtr& service,
+    const ServiceProperties& properties,
+    std::vector<std::string>& classes);
 
-  void Get_unlocked(const std::string& clazz,
-                    std::vector<ServiceRegistrationBase>& serviceRegs) const;
+  /**
+   * Publish a new snapshot with the registration lists of
+   * <code>classes</code> rebuilt from the writer side state. Must be
+   * called with the registry lock held.
+   *
+   * @param classes The class names whose registrations changed.
+   * @param servicesChanged Whether services were registered or
+   *        unregistered, rather than only re-ranked.
+   */
+  template<typename Classes>
+  void PublishSnapshot_unlocked(const Classes& classes,
+                                bool servicesChanged = true);
 
-  void Get_unlocked(const std::string& clazz,
-                    const std::string& filter,
-                    BundlePrivate* bundle,
-                    std::vector<ServiceReferenceBase>& serviceRefs) const;
+  detail::Atomic<SnapshotConstPtr> snapshot;
 };
 }
 
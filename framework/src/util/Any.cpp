@@ -51,8 +51,9 @@ std::ostream& newline_and_indent(std::ostream& os,
     // We only do formatting if increment > 0, because if increment was actually zero everything
     // would just line up in one column, so there'd be no formatting.
     //
-    // We always insert a newline if we're formatting
-    os << std::endl;
+    // We always insert a newline if we're formatting. The stream is not
+    // flushed, large values are written in one go.
+    os << '\n';
     if (indent > 0) {
       // And if we're indenting past the zeroth column, insert that many spaces
       os << std::setw(indent) << ' ';
@@ -63,8 +64,7 @@ std::ostream& newline_and_indent(std::ostream& os,
 
 std::ostream& any_value_to_string(std::ostream& os, const Any& any)
 {
-  os << any.ToString();
-  return os;
+  return any.ToString(os);
 }
 
 std::ostream& any_value_to_json(std::ostream& os,
@@ -72,8 +72,7 @@ std::ostream& any_value_to_json(std::ostream& os,
                                 const uint8_t increment,
                                 const int32_t indent)
 {
-  os << val.ToJSON(increment, indent);
-  return os;
+  return val.ToJSON(os, increment, indent);
 }
 
 std::ostream& any_value_to_json(std::ostream& o,
@@ -81,47 +80,55 @@ std::ostream& any_value_to_json(std::ostream& o,
                                 const uint8_t,
                                 const int32_t)
 {
+  static const char hexDigits[] = "0123456789abcdef";
+
+  // Characters which need no escaping are written in runs. The stream
+  // state is left untouched, since nested values share the stream.
   o << '"';
-  for (auto c = s.cbegin(); c != s.cend(); c++) {
+  auto run = s.data();
+  const auto end = s.data() + s.size();
+  for (auto c = run; c != end; ++c) {
+    const char* escaped = nullptr;
     switch (*c) {
       case '"':
-        o << "\\\"";
+        escaped = "\\\"";
         break;
       case '\\':
-        o << "\\\\";
+        escaped = "\\\\";
         break;
       case '\b':
-        o << "\\b";
+        escaped = "\\b";
         break;
       case '\f':
-        o << "\\f";
+        escaped = "\\f";
         break;
       case '\n':
-        o << "\\n";
+        escaped = "\\n";
         break;
       case '\r':
-        o << "\\r";
+        escaped = "\\r";
         break;
       case '\t':
-        o << "\\t";
+        escaped = "\\t";
         break;
       default:
-// suppress type-limits warning on linux arm 64 build
-#if defined(__GNUC__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wtype-limits"
-#endif
-        if ('\x00' <= *c && *c <= '\x1f') {
-          o << "\\u" << std::hex << std::setw(4) << std::setfill('0')
-            << static_cast<int>(*c);
-        } else {
-          o << *c;
+        if (static_cast<unsigned char>(*c) > 0x1f) {
+          continue;
         }
-#if defined(__GNUC__)
-#pragma GCC diagnostic pop
-#endif
+    }
+    o.write(run, c - run);
+    run = c + 1;
+    if (escaped) {
+      o << escaped;
+    } else {
+      const auto code = static_cast<unsigned char>(*c);
+      const char unicode[] = {
+        '\\', 'u', '0', '0', hexDigits[code >> 4], hexDigits[code & 0xf]
+      };
+      o.write(unicode, sizeof(unicode));
     }
   }
+  o.write(run, end - run);
   return o << '"';
 }
 
@@ -130,7 +137,7 @@ std::ostream& any_value_to_json(std::ostream& os,
                                 const uint8_t,
                                 const int32_t)
 {
-  return os << std::boolalpha << val;
+  return os << (val ? "true" : "false");
 }
 
 // The default constructor implementation needs to be in the implementation file, not the
@@ -140,15 +147,27 @@ std::ostream& any_value_to_json(std::ostream& os,
 Any::Any() = default;
 
 std::string Any::ToString() const
+{
+  std::ostringstream ss;
+  ToString(ss);
+  return ss.str();
+}
+
+std::string Any::ToStringNoExcept() const
 {
   if (Empty()) {
-    throw std::logic_error("empty any");
+    return std::string();
   }
-  return _content->ToString();
+  std::ostringstream ss;
+  _content->ToString(ss);
+  return ss.str();
 }
 
-std::string Any::ToStringNoExcept() const
+std::ostream& Any::ToString(std::ostream& os) const
 {
-  return Empty() ? std::string() : _content->ToString();
+  if (Empty()) {
+    throw std::logic_error("empty any");
+  }
+  return _content->ToString(os);
 }
 }
@@ -22,26 +22,101 @@
 
 #include "cppmicroservices/AnyMap.h"
 
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 namespace cppmicroservices {
 
 namespace detail {
 
+namespace {
+
+constexpr std::uint64_t ByteOnes = 0x0101010101010101ULL;
+
+// Sets the 0x20 bit of every ASCII upper case letter in the eight bytes of
+// w, which turns it into the corresponding lower case letter. A byte gets
+// its 0x80 bit set in 'upper' if it is below 0x80, not below 'A' and below
+// 'Z' + 1. The additions cannot carry into the next byte.
+inline std::uint64_t FoldCase(std::uint64_t w)
+{
+  const std::uint64_t low = w & (0x7f * ByteOnes);
+  const std::uint64_t upper = (low + (0x80 - 'A') * ByteOnes) &
+                              ~(low + (0x80 - 'Z' - 1) * ByteOnes) & ~w &
+                              (0x80 * ByteOnes);
+  return w | (upper >> 2);
+}
+
+inline char FoldCase(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+inline std::uint64_t Load(const char* p)
+{
+  std::uint64_t w;
+  std::memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+inline std::uint64_t Mix(std::uint64_t h, std::uint64_t w)
+{
+  h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+  return h ^ (h >> 32);
+}
+
+}
+
 std::size_t any_map_cihash::operator()(const std::string& key) const
 {
-  std::string lcase = key;
-  std::transform(lcase.begin(), lcase.end(), lcase.begin(), ::tolower);
-  return std::hash<std::string>{}(lcase);
+  return (*this)(std::string_view(key));
+}
+
+std::size_t any_map_cihash::operator()(std::string_view key) const
+{
+  // Hashes eight case folded bytes at a time, instead of creating a lower
+  // case copy of the key.
+  const char* p = key.data();
+  std::size_t n = key.size();
+  std::uint64_t h = 0xcbf29ce484222325ULL ^ n;
+  for (; n >= sizeof(std::uint64_t); n -= sizeof(std::uint64_t)) {
+    h = Mix(h, FoldCase(Load(p)));
+    p += sizeof(std::uint64_t);
+  }
+  if (n > 0) {
+    std::uint64_t w = 0;
+    std::memcpy(&w, p, n);
+    h = Mix(h, FoldCase(w));
+  }
+  h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ULL;
+  return static_cast<std::size_t>(h ^ (h >> 32));
 }
 
 bool any_map_ciequal::operator()(const std::string& l,
                                  const std::string& r) const
 {
-  return (l.size() == r.size() &&
-          std::equal(l.begin(), l.end(), r.begin(), [](char a, char b) {
-            return tolower(a) == tolower(b);
-          }));
+  return (*this)(std::string_view(l), std::string_view(r));
+}
+
+bool any_map_ciequal::operator()(std::string_view l, std::string_view r) const
+{
+  if (l.size() != r.size()) {
+    return false;
+  }
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= l.size(); i += sizeof(std::uint64_t)) {
+    const auto a = Load(l.data() + i);
+    const auto b = Load(r.data() + i);
+    if (a != b && FoldCase(a) != FoldCase(b)) {
+      return false;
+    }
+  }
+  for (; i < l.size(); ++i) {
+    if (FoldCase(l[i]) != FoldCase(r[i])) {
+      return false;
+    }
+  }
+  return true;
 }
 
 const Any& AtCompoundKey(const std::vector<Any>& v,
@@ -54,7 +129,7 @@ const Any& AtCompoundKey(const AnyMap& m, const std::string_view& key)
     auto head = key.substr(0, pos);
     auto tail = key.substr(pos + 1);
 
-    auto& h = m.at(std::string(head));
+    auto& h = m.at(head);
     if (h.Type() == typeid(AnyMap)) {
       return AtCompoundKey(ref_any_cast<AnyMap>(h), tail);
     } else if (h.Type() == typeid(std::vector<Any>)) {
@@ -63,7 +138,7 @@ const Any& AtCompoundKey(const AnyMap& m, const std::string_view& key)
     throw std::invalid_argument("Unsupported Any type at '" +
                                 std::string(head) + "' for dotted get");
   } else {
-    return m.at(std::string(key));
+    return m.at(key);
   }
 }
 
@@ -101,7 +176,7 @@ Any AtCompoundKey(const AnyMap& m,
   if (pos != AnyMap::key_type::npos) {
     const auto head = key.substr(0, pos);
     const auto tail = key.substr(pos + 1);
-    auto itr = m.find(std::string(head));
+    auto itr = m.find(head);
     if (itr != m.end()) {
       auto& h = itr->second;
       if (h.Type() == typeid(AnyMap)) {
@@ -113,7 +188,7 @@ Any AtCompoundKey(const AnyMap& m,
       }
     }
   } else {
-    auto itr = m.find(std::string(key));
+    auto itr = m.find(key);
     if (itr != m.end()) {
       return itr->second;
     }
@@ -717,6 +792,25 @@ any_map::size_type any_map::size() const
   }
 }
 
+namespace {
+
+// The standard containers only look up keys of their key_type, so a key
+// which is not a std::string is copied into a buffer which the calling
+// thread reuses, to avoid allocating a new string for each lookup.
+template<typename Function>
+decltype(auto) WithKey(std::string_view key, Function&& f)
+{
+#ifdef US_HAVE_THREAD_LOCAL
+  static thread_local std::string buffer;
+  buffer.assign(key.data(), key.size());
+  return f(static_cast<const std::string&>(buffer));
+#else
+  return f(std::string(key));
+#endif
+}
+
+}
+
 any_map::size_type any_map::count(const any_map::key_type& key) const
 {
   switch (type) {
@@ -731,6 +825,16 @@ any_map::size_type any_map::count(const any_map::key_type& key) const
   }
 }
 
+any_map::size_type any_map::count(std::string_view key) const
+{
+  return WithKey(key, [this](const key_type& k) { return count(k); });
+}
+
+any_map::size_type any_map::count(const char* key) const
+{
+  return count(std::string_view(key));
+}
+
 void any_map::clear()
 {
   switch (type) {
@@ -773,6 +877,28 @@ const any_map::mapped_type& any_map::at(const any_map::key_type& key) const
   }
 }
 
+any_map::mapped_type& any_map::at(std::string_view key)
+{
+  return WithKey(
+    key, [this](const key_type& k) -> mapped_type& { return at(k); });
+}
+
+const any_map::mapped_type& any_map::at(std::string_view key) const
+{
+  return WithKey(
+    key, [this](const key_type& k) -> const mapped_type& { return at(k); });
+}
+
+any_map::mapped_type& any_map::at(const char* key)
+{
+  return at(std::string_view(key));
+}
+
+const any_map::mapped_type& any_map::at(const char* key) const
+{
+  return at(std::string_view(key));
+}
+
 any_map::mapped_type& any_map::operator[](const any_map::key_type& key)
 {
   switch (type) {
@@ -835,6 +961,16 @@ any_map::const_iterator any_map::find(const key_type& key) const
   }
 }
 
+any_map::const_iterator any_map::find(std::string_view key) const
+{
+  return WithKey(key, [this](const key_type& k) { return find(k); });
+}
+
+any_map::const_iterator any_map::find(const char* key) const
+{
+  return find(std::string_view(key));
+}
+
 any_map::size_type any_map::erase(const key_type& key)
 {
   switch (type) {
@@ -986,10 +1122,10 @@ std::ostream& any_value_to_string(std::ostream& os, const AnyMap& m)
   const Iterator begin = i1;
   const Iterator end = m.end();
   for (; i1 != end; ++i1) {
-    if (i1 == begin)
-      os << i1->first << " : " << i1->second.ToString();
-    else
-      os << ", " << i1->first << " : " << i1->second.ToString();
+    if (i1 != begin)
+      os << ", ";
+    os << i1->first << " : ";
+    i1->second.ToString(os);
   }
   os << "}";
   return os;
@@ -1016,8 +1152,8 @@ std::ostream& any_value_to_json(std::ostream& os,
       os << ", ";
     }
     newline_and_indent(os, increment, indent);
-    os << "\"" << i1->first
-       << "\" : " << i1->second.ToJSON(increment, indent + increment);
+    os << "\"" << i1->first << "\" : ";
+    i1->second.ToJSON(os, increment, indent + increment);
   }
   newline_and_indent(os, increment, indent - increment);
   os << "}";
@@ -24,6 +24,7 @@
 
 #include "cppmicroservices/FrameworkEvent.h"
 
+#include "BundleTimings.h"
 #include "FrameworkPrivate.h"
 
 namespace cppmicroservices {
@@ -71,4 +72,26 @@ FrameworkEvent Framework::WaitForStop(const std::chrono::milliseconds& timeout)
 {
   return pimpl(d)->WaitForStop(timeout);
 }
+
+Framework::ServiceEventDeliveryStatistics
+Framework::GetServiceEventDeliveryStatistics() const
+{
+  return d->coreCtx->listeners.GetServiceEventDeliveryStatistics();
+}
+
+std::vector<Framework::BundlePhaseTiming> Framework::GetBundlePhaseTimings()
+  const
+{
+  auto const& timings = d->coreCtx->bundleTimings;
+  return timings ? timings->GetTimings() : std::vector<BundlePhaseTiming>();
+}
+
+void Framework::WriteBundlePhaseTimings(std::ostream& os) const
+{
+  if (auto const& timings = d->coreCtx->bundleTimings) {
+    timings->WriteTrace(os);
+  } else {
+    BundleTimings().WriteTrace(os);
+  }
+}
 }
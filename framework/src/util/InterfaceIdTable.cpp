@@ -0,0 +1,125 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "InterfaceIdTable.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace cppmicroservices {
+
+constexpr InterfaceId InterfaceIdTable::EMPTY_ID;
+constexpr InterfaceId InterfaceIdTable::FACTORY_ID;
+
+InterfaceIdTable::InterfaceIdTable()
+{
+  Intern_unlocked("");
+  Intern_unlocked("org.cppmicroservices.factory");
+}
+
+InterfaceIdTable& InterfaceIdTable::Instance()
+{
+  static InterfaceIdTable table;
+  return table;
+}
+
+const InternedInterface* InterfaceIdTable::Intern(std::string_view name)
+{
+  {
+    std::shared_lock<std::shared_mutex> l(mutex);
+    auto iter = ids.find(name);
+    if (iter != ids.end()) {
+      return iter->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> l(mutex);
+  return Intern_unlocked(name);
+}
+
+const InternedInterface* InterfaceIdTable::Intern_unlocked(
+  std::string_view name)
+{
+  auto iter = ids.find(name);
+  if (iter != ids.end()) {
+    return iter->second;
+  }
+
+  interfaces.push_back(InternedInterface{
+    std::string(name), static_cast<InterfaceId>(interfaces.size()) });
+  auto interned = &interfaces.back();
+  ids.emplace(interned->name, interned);
+  return interned;
+}
+
+FlatInterfaceMap::FlatInterfaceMap(const InterfaceMap& interfaces)
+{
+  auto& table = InterfaceIdTable::Instance();
+  entries.reserve(interfaces.size());
+  interned.reserve(interfaces.size());
+  for (auto const& entry : interfaces) {
+    interned.push_back(table.Intern(entry.first));
+    entries.emplace_back(interned.back()->id, entry.second);
+  }
+  std::sort(entries.begin(),
+            entries.end(),
+            [](const Entry& a, const Entry& b) { return a.first < b.first; });
+}
+
+std::shared_ptr<void> FlatInterfaceMap::Find(InterfaceId id) const
+{
+  auto iter = LowerBound(id);
+  return (iter != entries.end() && iter->first == id) ? iter->second
+                                                      : nullptr;
+}
+
+bool FlatInterfaceMap::Contains(InterfaceId id) const
+{
+  auto iter = LowerBound(id);
+  return iter != entries.end() && iter->first == id;
+}
+
+const InternedInterface* FlatInterfaceMap::FindInterned(
+  std::string_view name) const
+{
+  for (auto candidate : interned) {
+    if (candidate->name == name) {
+      return candidate;
+    }
+  }
+  return nullptr;
+}
+
+void FlatInterfaceMap::Clear()
+{
+  entries.clear();
+}
+
+std::vector<FlatInterfaceMap::Entry>::const_iterator
+FlatInterfaceMap::LowerBound(InterfaceId id) const
+{
+  return std::lower_bound(
+    entries.begin(), entries.end(), id, [](const Entry& entry, InterfaceId id) {
+      return entry.first < id;
+    });
+}
+}
@@ -0,0 +1,144 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_INTERFACEIDTABLE_H
+#define CPPMICROSERVICES_INTERFACEIDTABLE_H
+
+#include "cppmicroservices/ServiceInterface.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cppmicroservices {
+
+/**
+ * A service interface id interned in the InterfaceIdTable. Two interned
+ * ids are equal if and only if their interface names are equal.
+ */
+using InterfaceId = std::uint32_t;
+
+/**
+ * A service interface name interned in the InterfaceIdTable.
+ */
+struct InternedInterface
+{
+  std::string name;
+  InterfaceId id;
+};
+
+/**
+ * A framework-wide table of interned service interface ids.
+ *
+ * Interface names are long demangled type names, so the service layer
+ * compares the integers they are interned to instead. The empty name is
+ * always interned as #EMPTY_ID and the id of service factories
+ * ("org.cppmicroservices.factory") as #FACTORY_ID.
+ *
+ * Interned names are never released.
+ *
+ * This class is not part of the public API.
+ */
+class InterfaceIdTable
+{
+public:
+  static constexpr InterfaceId EMPTY_ID = 0;
+  static constexpr InterfaceId FACTORY_ID = 1;
+
+  InterfaceIdTable();
+
+  InterfaceIdTable(const InterfaceIdTable&) = delete;
+  InterfaceIdTable& operator=(const InterfaceIdTable&) = delete;
+
+  static InterfaceIdTable& Instance();
+
+  /**
+   * Get the interned interface <code>name</code>, interning it if
+   * necessary.
+   *
+   * @return The interned interface, never <code>nullptr</code>.
+   */
+  const InternedInterface* Intern(std::string_view name);
+
+private:
+  const InternedInterface* Intern_unlocked(std::string_view name);
+
+  mutable std::shared_mutex mutex;
+
+  // Indexed by id, a deque so that the interned interfaces never move
+  std::deque<InternedInterface> interfaces;
+  // The map keys refer to the names in interfaces
+  std::unordered_map<std::string_view, const InternedInterface*> ids;
+};
+
+/**
+ * The interfaces of a service object, sorted by their interned ids.
+ * Looking up an interface only compares integers. This is an immutable
+ * companion of the InterfaceMap a service was registered with.
+ */
+class FlatInterfaceMap
+{
+public:
+  FlatInterfaceMap() = default;
+
+  explicit FlatInterfaceMap(const InterfaceMap& interfaces);
+
+  /**
+   * @return The service object for the interface <code>id</code>, or
+   *         <code>nullptr</code> if there is none.
+   */
+  std::shared_ptr<void> Find(InterfaceId id) const;
+
+  bool Contains(InterfaceId id) const;
+
+  /**
+   * Get the interned interface <code>name</code> without locking the
+   * InterfaceIdTable. This also works after Clear().
+   *
+   * @return The interned interface, or <code>nullptr</code> if the map
+   *         was not created with an interface <code>name</code>.
+   */
+  const InternedInterface* FindInterned(std::string_view name) const;
+
+  /**
+   * Release the service objects. The interned interfaces are kept.
+   */
+  void Clear();
+
+private:
+  using Entry = std::pair<InterfaceId, std::shared_ptr<void>>;
+
+  std::vector<Entry>::const_iterator LowerBound(InterfaceId id) const;
+
+  std::vector<Entry> entries;
+  // Not changed after construction, so it can be read while Clear() runs
+  std::vector<const InternedInterface*> interned;
+};
+}
+
+#endif // CPPMICROSERVICES_INTERFACEIDTABLE_H
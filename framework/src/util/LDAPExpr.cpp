@@ -28,13 +28,18 @@
 #include "absl/strings/str_cat.h"
 
 #include "Properties.h"
+#include "PropertyKeyTable.h"
 
 #include <cctype>
 #include <cerrno>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <iterator>
+#include <list>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <utility>
 
@@ -129,6 +134,73 @@ public:
   void error(const std::string& m) const;
 };
 
+//! A filter compiled into a flat instruction array.
+class LDAPExprProgram
+{
+public:
+  explicit LDAPExprProgram(const LDAPExpr& expr);
+
+  bool Evaluate(const PropertiesHandle& p, bool matchCase) const;
+
+private:
+  enum OpCode : std::uint8_t
+  {
+    TEST,          //!< acc = result of tests[arg]
+    JUMP_IF_FALSE, //!< if acc is false, continue at code[arg]
+    JUMP_IF_TRUE,  //!< if acc is true, continue at code[arg]
+    NEGATE         //!< acc = !acc
+  };
+
+  struct Instruction
+  {
+    OpCode op;
+    std::uint32_t arg;
+  };
+
+  /**
+   * A simple expression, with the literal value converted up front to
+   * all types it may be compared against.
+   */
+  struct Test
+  {
+    Test(int op, const std::string& attrName, const std::string& attrValue);
+
+    int op;
+    //! The interned attribute name
+    std::shared_ptr<const InternedKey> attrName;
+    //! The literal value, '*' replaced by LDAPExprConstants::WILDCARD()
+    std::string attrValue;
+    //! attrValue without whitespace and lower cased, for APPROX
+    std::string approxValue;
+    bool isPresence;
+    bool hasWildcard;
+    bool isLong;
+    long longValue;
+    bool isDouble;
+    double doubleValue;
+    bool matchesTrue;
+    bool matchesFalse;
+  };
+
+  void Compile(const LDAPExpr& expr);
+
+  static bool Compare(const Any& obj, const Test& t);
+
+  template<typename T>
+  static bool CompareIntegralType(const Any& obj, const Test& t);
+
+  template<typename T>
+  static bool CompareFloatingPointType(const Any& obj, const Test& t);
+
+  static bool CompareString(const std::string_view s, const Test& t);
+
+  static bool ApproxEquals(const std::string_view s,
+                           const std::string_view approxValue);
+
+  std::vector<Instruction> code;
+  std::vector<Test> tests;
+};
+
 class LDAPExprData
 {
 public:
@@ -136,24 +208,40 @@ public:
     : m_operator(op)
     , m_args(std::move(args))
     , m_attrName()
+    , m_attrNameLower()
     , m_attrValue()
   {}
 
-  LDAPExprData(int op, std::string attrName, std::string attrValue)
+  LDAPExprData(int op,
+               std::string attrName,
+               std::string attrNameLower,
+               std::string attrValue)
     : m_operator(op)
     , m_args()
     , m_attrName(std::move(attrName))
+    , m_attrNameLower(std::move(attrNameLower))
     , m_attrValue(std::move(attrValue))
   {}
 
-  LDAPExprData(const LDAPExprData& other)
-
-    = default;
+  //! Compiles the expression on first use, so that sub-expressions are
+  //! compiled at most once, too.
+  const LDAPExprProgram& Program(const LDAPExpr& expr)
+  {
+    std::call_once(m_compiled, [&]() {
+      m_program = std::make_unique<const LDAPExprProgram>(expr);
+    });
+    return *m_program;
+  }
 
   int m_operator;
   std::vector<LDAPExpr> m_args;
   std::string m_attrName;
+  std::string m_attrNameLower;
   std::string m_attrValue;
+
+private:
+  std::once_flag m_compiled;
+  std::unique_ptr<const LDAPExprProgram> m_program;
 };
 
 LDAPExpr::LDAPExpr()
@@ -173,6 +261,7 @@ LDAPExpr::LDAPExpr(const std::string& filter)
     }
 
     d = expr.d;
+    d->Program(*this);
   } catch (const std::out_of_range&) {
     ps.error(LDAPExprConstants::EOS());
   }
@@ -185,7 +274,7 @@ LDAPExpr::LDAPExpr(int op, const std::vector<LDAPExpr>& args)
 LDAPExpr::LDAPExpr(int op,
                    const std::string& attrName,
                    const std::string& attrValue)
-  : d(new LDAPExprData(op, attrName, attrValue))
+  : d(new LDAPExprData(op, attrName, ToLower(attrName), attrValue))
 {}
 
 LDAPExpr::LDAPExpr(const LDAPExpr&) = default;
@@ -281,11 +370,11 @@ bool LDAPExpr::IsSimple(const StringList& keywords,
     if ((index =
            std::find(keywords.begin(),
                      keywords.end(),
-                     matchCase ? d->m_attrName : ToLower(d->m_attrName))) !=
+                     matchCase ? d->m_attrName : d->m_attrNameLower)) !=
           keywords.end() &&
         d->m_attrValue.find_first_of(LDAPExprConstants::WILDCARD()) ==
           std::string::npos) {
-      cache[index - keywords.begin()] = StringList(1, d->m_attrValue);
+      cache[index - keywords.begin()].push_back(d->m_attrValue);
       return true;
     }
   } else if (d->m_operator == OR) {
@@ -298,6 +387,24 @@ bool LDAPExpr::IsSimple(const StringList& keywords,
   return false;
 }
 
+bool LDAPExpr::IsSimpleConjunction(const StringList& keywords,
+                                   LocalCache& cache,
+                                   bool matchCase) const
+{
+  if (d->m_operator != AND) {
+    return false;
+  }
+  for (const auto& m_arg : d->m_args) {
+    LocalCache argCache;
+    if (m_arg.IsSimple(keywords, argCache, matchCase) ||
+        m_arg.IsSimpleConjunction(keywords, argCache, matchCase)) {
+      cache = std::move(argCache);
+      return true;
+    }
+  }
+  return false;
+}
+
 bool LDAPExpr::IsNull() const
 {
   return !d;
@@ -305,133 +412,175 @@ bool LDAPExpr::IsNull() const
 
 bool LDAPExpr::Evaluate(const PropertiesHandle& p, bool matchCase) const
 {
-  if ((d->m_operator & SIMPLE) != 0) {
-    // try case sensitive match first
-    int index = p->FindCaseSensitive_unlocked(d->m_attrName);
-    if (index < 0 && !matchCase)
-      index = p->Find_unlocked(d->m_attrName);
-    return index < 0
-             ? false
-             : Compare(p->Value_unlocked(index), d->m_operator, d->m_attrValue);
-  } else { // (d->m_operator & COMPLEX) != 0
-    switch (d->m_operator) {
-      case AND:
-        for (const auto& m_arg : d->m_args) {
-          if (!m_arg.Evaluate(p, matchCase))
-            return false;
-        }
-        return true;
-      case OR:
-        for (const auto& m_arg : d->m_args) {
-          if (m_arg.Evaluate(p, matchCase))
-            return true;
-        }
-        return false;
-      case NOT:
-        return !d->m_args[0].Evaluate(p, matchCase);
-      default:
-        return false; // Cannot happen
+  return d->Program(*this).Evaluate(p, matchCase);
+}
+
+LDAPExprProgram::Test::Test(int op,
+                            const std::string& attrName,
+                            const std::string& attrValue)
+  : op(op)
+  , attrName(PropertyKeyTable::Instance().Intern(attrName))
+  , attrValue(attrValue)
+  , approxValue(LDAPExpr::FixupString(attrValue))
+  , isPresence(op == LDAPExpr::EQ &&
+               attrValue == LDAPExprConstants::WILDCARD_STRING())
+  , hasWildcard(attrValue.find(LDAPExprConstants::WILDCARD()) !=
+                std::string::npos)
+  , isLong(false)
+  , longValue(0)
+  , isDouble(false)
+  , doubleValue(0)
+  , matchesTrue(false)
+  , matchesFalse(false)
+{
+  errno = 0;
+  char* endptr = nullptr;
+  longValue = strtol(attrValue.c_str(), &endptr, 10);
+  isLong =
+    !((errno == ERANGE && (longValue == std::numeric_limits<long>::max() ||
+                           longValue == std::numeric_limits<long>::min())) ||
+      (errno != 0 && longValue == 0) || endptr == attrValue.c_str());
+
+  errno = 0;
+  endptr = nullptr;
+  doubleValue = strtod(attrValue.c_str(), &endptr);
+  isDouble = !((errno == ERANGE && (doubleValue == 0 ||
+                                    doubleValue == HUGE_VAL ||
+                                    doubleValue == -HUGE_VAL)) ||
+               (errno != 0 && doubleValue == 0) ||
+               endptr == attrValue.c_str());
+
+  // A bool matches if the literal is a case insensitive prefix of its
+  // string representation.
+  auto isPrefixOf = [&attrValue](const std::string& boolStr) {
+    return attrValue.size() <= boolStr.size() &&
+           std::equal(
+             attrValue.begin(), attrValue.end(), boolStr.begin(), stricomp);
+  };
+  matchesTrue = isPrefixOf("true");
+  matchesFalse = isPrefixOf("false");
+}
+
+LDAPExprProgram::LDAPExprProgram(const LDAPExpr& expr)
+{
+  Compile(expr);
+}
+
+void LDAPExprProgram::Compile(const LDAPExpr& expr)
+{
+  const auto& d = *expr.d;
+  if ((d.m_operator & LDAPExpr::SIMPLE) != 0) {
+    code.push_back({ TEST, static_cast<std::uint32_t>(tests.size()) });
+    tests.emplace_back(d.m_operator, d.m_attrName, d.m_attrValue);
+  } else if (d.m_operator == LDAPExpr::NOT) {
+    Compile(d.m_args[0]);
+    code.push_back({ NEGATE, 0 });
+  } else {
+    // AND and OR jump to the end of the expression as soon as its
+    // result is known, leaving that result in the accumulator.
+    OpCode jump = (d.m_operator == LDAPExpr::AND) ? JUMP_IF_FALSE : JUMP_IF_TRUE;
+    std::vector<std::size_t> jumps;
+    for (std::size_t i = 0; i < d.m_args.size(); ++i) {
+      Compile(d.m_args[i]);
+      if (i + 1 < d.m_args.size()) {
+        jumps.push_back(code.size());
+        code.push_back({ jump, 0 });
+      }
+    }
+    for (auto j : jumps) {
+      code[j].arg = static_cast<std::uint32_t>(code.size());
+    }
+  }
+}
+
+bool LDAPExprProgram::Evaluate(const PropertiesHandle& p, bool matchCase) const
+{
+  bool acc = false;
+  std::size_t pc = 0;
+  while (pc < code.size()) {
+    const Instruction& instr = code[pc];
+    switch (instr.op) {
+      case TEST: {
+        const Test& t = tests[instr.arg];
+        // try case sensitive match first
+        int index = p->FindCaseSensitive_unlocked(t.attrName.get());
+        if (index < 0 && !matchCase)
+          index = p->Find_unlocked(t.attrName.get());
+        acc = index >= 0 && Compare(p->Value_unlocked(index), t);
+        ++pc;
+        break;
+      }
+      case JUMP_IF_FALSE:
+        pc = acc ? pc + 1 : instr.arg;
+        break;
+      case JUMP_IF_TRUE:
+        pc = acc ? instr.arg : pc + 1;
+        break;
+      case NEGATE:
+        acc = !acc;
+        ++pc;
+        break;
     }
   }
+  return acc;
 }
 
-bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
+bool LDAPExprProgram::Compare(const Any& obj, const Test& t)
 {
   if (obj.Empty())
     return false;
-  if (op == EQ && s == LDAPExprConstants::WILDCARD_STRING())
+  if (t.isPresence)
     return true;
 
   try {
     const std::type_info& objType = obj.Type();
     if (objType == typeid(std::string)) {
-      return CompareString(ref_any_cast<std::string>(obj), op, s);
+      return CompareString(ref_any_cast<std::string>(obj), t);
     } else if (objType == typeid(std::vector<std::string>)) {
       const auto& list = ref_any_cast<std::vector<std::string>>(obj);
-      for (std::size_t it = 0; it != list.size(); it++) {
-        if (CompareString(list[it], op, s))
+      for (const auto& it : list) {
+        if (CompareString(it, t))
           return true;
       }
     } else if (objType == typeid(std::list<std::string>)) {
       const auto& list = ref_any_cast<std::list<std::string>>(obj);
       for (const auto& it : list) {
-        if (CompareString(it, op, s))
+        if (CompareString(it, t))
           return true;
       }
     } else if (objType == typeid(char)) {
-      return CompareString(std::string(1, ref_any_cast<char>(obj)), op, s);
+      const char& c = ref_any_cast<char>(obj);
+      return CompareString(std::string_view(&c, 1), t);
     } else if (objType == typeid(bool)) {
-      if (op == LE || op == GE)
+      if (t.op == LDAPExpr::LE || t.op == LDAPExpr::GE)
         return false;
-
-      std::string boolVal = any_cast<bool>(obj) ? "true" : "false";
-      return std::equal(s.begin(), s.end(), boolVal.begin(), stricomp);
+      return any_cast<bool>(obj) ? t.matchesTrue : t.matchesFalse;
     } else if (objType == typeid(short)) {
-      return CompareIntegralType<short>(obj, op, s);
+      return CompareIntegralType<short>(obj, t);
     } else if (objType == typeid(int)) {
-      return CompareIntegralType<int>(obj, op, s);
+      return CompareIntegralType<int>(obj, t);
     } else if (objType == typeid(long int)) {
-      return CompareIntegralType<long int>(obj, op, s);
+      return CompareIntegralType<long int>(obj, t);
     } else if (objType == typeid(long long int)) {
-      return CompareIntegralType<long long int>(obj, op, s);
+      return CompareIntegralType<long long int>(obj, t);
     } else if (objType == typeid(unsigned char)) {
-      return CompareIntegralType<unsigned char>(obj, op, s);
+      return CompareIntegralType<unsigned char>(obj, t);
     } else if (objType == typeid(unsigned short)) {
-      return CompareIntegralType<unsigned short>(obj, op, s);
+      return CompareIntegralType<unsigned short>(obj, t);
     } else if (objType == typeid(unsigned int)) {
-      return CompareIntegralType<unsigned int>(obj, op, s);
+      return CompareIntegralType<unsigned int>(obj, t);
     } else if (objType == typeid(unsigned long int)) {
-      return CompareIntegralType<unsigned long int>(obj, op, s);
+      return CompareIntegralType<unsigned long int>(obj, t);
     } else if (objType == typeid(unsigned long long int)) {
-      return CompareIntegralType<unsigned long long int>(obj, op, s);
+      return CompareIntegralType<unsigned long long int>(obj, t);
     } else if (objType == typeid(float)) {
-      errno = 0;
-      char* endptr = nullptr;
-      double sFloat = strtod(s.c_str(), &endptr);
-      if ((errno == ERANGE &&
-           (sFloat == 0 || sFloat == HUGE_VAL || sFloat == -HUGE_VAL)) ||
-          (errno != 0 && sFloat == 0) || endptr == s.c_str()) {
-        return false;
-      }
-
-      auto floatVal = static_cast<double>(any_cast<float>(obj));
-
-      switch (op) {
-        case LE:
-          return floatVal <= sFloat;
-        case GE:
-          return floatVal >= sFloat;
-        default: /*APPROX and EQ*/
-          double diff = floatVal - sFloat;
-          return (diff < std::numeric_limits<float>::epsilon()) &&
-                 (diff > -std::numeric_limits<float>::epsilon());
-      }
+      return CompareFloatingPointType<float>(obj, t);
     } else if (objType == typeid(double)) {
-      errno = 0;
-      char* endptr = nullptr;
-      double sDouble = strtod(s.c_str(), &endptr);
-      if ((errno == ERANGE &&
-           (sDouble == 0 || sDouble == HUGE_VAL || sDouble == -HUGE_VAL)) ||
-          (errno != 0 && sDouble == 0) || endptr == s.c_str()) {
-        return false;
-      }
-
-      auto doubleVal = any_cast<double>(obj);
-
-      switch (op) {
-        case LE:
-          return doubleVal <= sDouble;
-        case GE:
-          return doubleVal >= sDouble;
-        default: /*APPROX and EQ*/
-          double diff = doubleVal - sDouble;
-          return (diff < std::numeric_limits<double>::epsilon()) &&
-                 (diff > -std::numeric_limits<double>::epsilon());
-      }
+      return CompareFloatingPointType<double>(obj, t);
     } else if (objType == typeid(std::vector<Any>)) {
       const auto& list = ref_any_cast<std::vector<Any>>(obj);
-      for (std::size_t it = 0; it != list.size(); it++) {
-        if (Compare(list[it], op, s))
+      for (const auto& it : list) {
+        if (Compare(it, t))
           return true;
       }
     }
@@ -443,50 +592,83 @@ bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
 }
 
 template<typename T>
-bool LDAPExpr::CompareIntegralType(const Any& obj,
-                                   const int op,
-                                   const std::string& s) const
+bool LDAPExprProgram::CompareIntegralType(const Any& obj, const Test& t)
 {
-  errno = 0;
-  char* endptr = nullptr;
-  long longInt = strtol(s.c_str(), &endptr, 10);
-  if ((errno == ERANGE && (longInt == std::numeric_limits<long>::max() ||
-                           longInt == std::numeric_limits<long>::min())) ||
-      (errno != 0 && longInt == 0) || endptr == s.c_str()) {
+  if (!t.isLong) {
     return false;
   }
 
-  auto sInt = static_cast<T>(longInt);
-  auto intVal = any_cast<T>(obj);
+  auto sInt = static_cast<T>(t.longValue);
+  auto intVal = ref_any_cast<T>(obj);
 
-  switch (op) {
-    case LE:
+  switch (t.op) {
+    case LDAPExpr::LE:
       return intVal <= sInt;
-    case GE:
+    case LDAPExpr::GE:
       return intVal >= sInt;
     default: /*APPROX and EQ*/
       return intVal == sInt;
   }
 }
 
-bool LDAPExpr::CompareString(const std::string_view s1,
-                             int op,
-                             const std::string_view s2)
+template<typename T>
+bool LDAPExprProgram::CompareFloatingPointType(const Any& obj, const Test& t)
 {
-  switch (op) {
-    case LE:
-      return s1.compare(s2) <= 0;
-    case GE:
-      return s1.compare(s2) >= 0;
-    case EQ:
-      return PatSubstr(s1, s2);
-    case APPROX:
-      return FixupString(s2) == FixupString(s1);
+  if (!t.isDouble) {
+    return false;
+  }
+
+  auto val = static_cast<double>(ref_any_cast<T>(obj));
+
+  switch (t.op) {
+    case LDAPExpr::LE:
+      return val <= t.doubleValue;
+    case LDAPExpr::GE:
+      return val >= t.doubleValue;
+    default: /*APPROX and EQ*/
+      double diff = val - t.doubleValue;
+      return (diff < std::numeric_limits<T>::epsilon()) &&
+             (diff > -std::numeric_limits<T>::epsilon());
+  }
+}
+
+bool LDAPExprProgram::CompareString(const std::string_view s, const Test& t)
+{
+  switch (t.op) {
+    case LDAPExpr::LE:
+      return s.compare(t.attrValue) <= 0;
+    case LDAPExpr::GE:
+      return s.compare(t.attrValue) >= 0;
+    case LDAPExpr::EQ:
+      return t.hasWildcard ? LDAPExpr::PatSubstr(s, t.attrValue)
+                           : s == t.attrValue;
+    case LDAPExpr::APPROX:
+      return ApproxEquals(s, t.approxValue);
     default:
       return false;
   }
 }
 
+bool LDAPExprProgram::ApproxEquals(const std::string_view s,
+                                   const std::string_view approxValue)
+{
+  // Same as LDAPExpr::FixupString(s) == approxValue, without allocating
+  std::size_t j = 0;
+  for (char c : s) {
+    if (std::isspace(c)) {
+      continue;
+    }
+    if (std::isupper(c)) {
+      c = std::tolower(c);
+    }
+    if (j == approxValue.size() || approxValue[j] != c) {
+      return false;
+    }
+    ++j;
+  }
+  return j == approxValue.size();
+}
+
 std::string LDAPExpr::FixupString(const std::string_view s)
 {
   std::string sb;
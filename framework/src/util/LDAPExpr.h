@@ -34,6 +34,7 @@ namespace cppmicroservices {
 
 class Any;
 class LDAPExprData;
+class LDAPExprProgram;
 class PropertiesHandle;
 
 /**
@@ -108,6 +109,23 @@ public:
                 LocalCache& cache,
                 bool matchCase) const;
 
+  /**
+   * Checks if this LDAP expression is an AND expression with an operand
+   * which is "simple" (see IsSimple()) or itself such a conjunction.
+   * Properties matching this expression also match that operand, so its
+   * keyword-value-pairs can be used to preselect properties before this
+   * expression is evaluated.
+   *
+   * @param keywords The keywords to look for.
+   * @param cache Filled with the keyword-value-pairs of the first
+   * suitable operand.
+   * @return <code>true</code> if a suitable operand was found,
+   * <code>false</code> otherwise.
+   */
+  bool IsSimpleConjunction(const StringList& keywords,
+                           LocalCache& cache,
+                           bool matchCase) const;
+
   /**
    * Returns <code>true</code> if this instance is invalid, i.e. it was
    * constructed using LDAPExpr().
@@ -117,13 +135,21 @@ public:
    */
   bool IsNull() const;
 
-  //! Evaluate this LDAP filter.
+  /**
+   * Evaluate this LDAP filter.
+   *
+   * The expression is compiled once into a flat instruction array, when
+   * it is parsed from a filter string or else on its first evaluation,
+   * so evaluating it does not allocate.
+   */
   bool Evaluate(const PropertiesHandle& p, bool matchCase) const;
 
   //!
   const std::string ToString() const;
 
 private:
+  friend class LDAPExprProgram;
+
   class ParseState;
 
   //!
@@ -142,20 +168,6 @@ private:
 
   static std::string ToLower(const std::string& str);
 
-  //!
-  bool Compare(const Any& obj, int op, const std::string& s) const;
-
-  //!
-  template<typename T>
-  bool CompareIntegralType(const Any& obj,
-                           const int op,
-                           const std::string& s) const;
-
-  //!
-  static bool CompareString(const std::string_view s1,
-                            int op,
-                            const std::string_view s2);
-
   //!
   static std::string FixupString(const std::string_view s);
 
@@ -0,0 +1,118 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "LDAPExprCache.h"
+
+#include <mutex>
+
+namespace cppmicroservices {
+
+LDAPExprCache::LDAPExprCache(std::size_t capacity)
+  : capacity(capacity)
+  , exprs()
+  , clock()
+  , hand(0)
+  , hits(0)
+  , misses(0)
+{}
+
+LDAPExprCache& LDAPExprCache::Instance()
+{
+  static LDAPExprCache cache;
+  return cache;
+}
+
+LDAPExpr LDAPExprCache::Get(const std::string& filter)
+{
+  {
+    std::shared_lock<std::shared_mutex> l(mutex);
+    auto iter = exprs.find(filter);
+    if (iter != exprs.end()) {
+      iter->second.used.store(true, std::memory_order_relaxed);
+      hits.fetch_add(1, std::memory_order_relaxed);
+      return iter->second.expr;
+    }
+  }
+
+  misses.fetch_add(1, std::memory_order_relaxed);
+
+  // Parse without holding the lock, this may throw.
+  LDAPExpr expr(filter);
+
+  if (capacity == 0) {
+    return expr;
+  }
+
+  std::unique_lock<std::shared_mutex> l(mutex);
+  auto iter = exprs.find(filter);
+  if (iter != exprs.end()) {
+    // Another thread cached the filter in the meantime
+    return iter->second.expr;
+  }
+
+  if (clock.size() < capacity) {
+    auto& entry = *exprs.try_emplace(filter, expr).first;
+    clock.push_back(&entry);
+    return entry.second.expr;
+  }
+
+  // Give entries which were used since the last pass another round
+  while (clock[hand]->second.used.load(std::memory_order_relaxed)) {
+    clock[hand]->second.used.store(false, std::memory_order_relaxed);
+    hand = (hand + 1) % clock.size();
+  }
+  exprs.erase(clock[hand]->first);
+  auto& entry = *exprs.try_emplace(filter, expr).first;
+  clock[hand] = &entry;
+  hand = (hand + 1) % clock.size();
+  return entry.second.expr;
+}
+
+void LDAPExprCache::Clear()
+{
+  std::unique_lock<std::shared_mutex> l(mutex);
+  exprs.clear();
+  clock.clear();
+  hand = 0;
+}
+
+std::size_t LDAPExprCache::Size() const
+{
+  std::shared_lock<std::shared_mutex> l(mutex);
+  return exprs.size();
+}
+
+std::size_t LDAPExprCache::Capacity() const
+{
+  return capacity;
+}
+
+std::uint64_t LDAPExprCache::Hits() const
+{
+  return hits.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LDAPExprCache::Misses() const
+{
+  return misses.load(std::memory_order_relaxed);
+}
+}
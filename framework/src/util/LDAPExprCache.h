@@ -0,0 +1,119 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_LDAPEXPRCACHE_H
+#define CPPMICROSERVICES_LDAPEXPRCACHE_H
+
+#include "LDAPExpr.h"
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cppmicroservices {
+
+/**
+ * A bounded, thread-safe cache of parsed LDAPExpr objects, keyed by
+ * their filter string.
+ *
+ * LDAPExpr objects share their immutable parse tree, so handing out
+ * copies of cached entries is cheap. Filter strings which fail to parse
+ * are not cached.
+ *
+ * Cache hits only take a shared lock. Misses and evictions take an
+ * exclusive lock. A full cache evicts entries with the CLOCK algorithm,
+ * an approximation of LRU: a hit marks its entry as used, and the clock
+ * hand evicts the next entry which was not used since the hand last
+ * passed it.
+ *
+ * This class is not part of the public API.
+ */
+class LDAPExprCache
+{
+public:
+  static const std::size_t DEFAULT_CAPACITY = 4096;
+
+  explicit LDAPExprCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+  LDAPExprCache(const LDAPExprCache&) = delete;
+  LDAPExprCache& operator=(const LDAPExprCache&) = delete;
+
+  /**
+   * The process wide cache shared by the service registry, the service
+   * listeners and LDAPFilter objects.
+   */
+  static LDAPExprCache& Instance();
+
+  /**
+   * Get the parsed expression for <code>filter</code>, parsing and
+   * caching it if it is not cached yet. If the cache is full, an entry
+   * which was not used recently is evicted.
+   *
+   * @param filter The filter string.
+   * @return The parsed LDAPExpr object.
+   * @throws std::invalid_argument If <code>filter</code> cannot be parsed.
+   */
+  LDAPExpr Get(const std::string& filter);
+
+  void Clear();
+
+  std::size_t Size() const;
+
+  std::size_t Capacity() const;
+
+  std::uint64_t Hits() const;
+
+  std::uint64_t Misses() const;
+
+private:
+  struct Entry
+  {
+    explicit Entry(const LDAPExpr& expr)
+      : expr(expr)
+      , used(false)
+    {}
+
+    const LDAPExpr expr;
+
+    // Set by hits under the shared lock, cleared by the clock hand
+    std::atomic<bool> used;
+  };
+
+  using Exprs = std::unordered_map<std::string, Entry>;
+
+  const std::size_t capacity;
+  mutable std::shared_mutex mutex;
+  Exprs exprs;
+
+  // The cached entries in the order of the clock hand
+  std::vector<Exprs::value_type*> clock;
+  std::size_t hand;
+
+  std::atomic<std::uint64_t> hits;
+  std::atomic<std::uint64_t> misses;
+};
+}
+
+#endif // CPPMICROSERVICES_LDAPEXPRCACHE_H
@@ -26,6 +26,7 @@
 #include "cppmicroservices/ServiceReference.h"
 
 #include "LDAPExpr.h"
+#include "LDAPExprCache.h"
 #include "Properties.h"
 #include "ServiceReferenceBasePrivate.h"
 
@@ -41,7 +42,7 @@ public:
   {}
 
   LDAPFilterData(const std::string& filter)
-    : ldapExpr(filter)
+    : ldapExpr(LDAPExprCache::Instance().Get(filter))
   {}
 
   LDAPFilterData(const LDAPFilterData&) = default;
@@ -112,6 +113,17 @@ bool LDAPFilter::operator==(const LDAPFilter& other) const
 
 LDAPFilter& LDAPFilter::operator=(const LDAPFilter& filter) = default;
 
+LDAPFilter::CacheStatistics LDAPFilter::GetCacheStatistics()
+{
+  auto& cache = LDAPExprCache::Instance();
+  CacheStatistics stats;
+  stats.hits = cache.Hits();
+  stats.misses = cache.Misses();
+  stats.size = cache.Size();
+  stats.capacity = cache.Capacity();
+  return stats;
+}
+
 std::ostream& operator<<(std::ostream& os, const LDAPFilter& filter)
 {
   return os << filter.ToString();
@@ -22,20 +22,36 @@
 
 #include "Properties.h"
 
+#include "PropertyKeyTable.h"
+
 #include <limits>
 #include <stdexcept>
-#ifdef US_PLATFORM_WINDOWS
-#  include <string.h>
-#  define ci_compare strnicmp
-#else
-#  include <strings.h>
-#  define ci_compare strncasecmp
-#endif
-
-US_MSVC_PUSH_DISABLE_WARNING(4996)
+#include <utility>
 
 namespace cppmicroservices {
 
+namespace {
+
+char ToLower(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+// Compares ignoring the case of ASCII letters, like the interned keys
+bool EqualsIgnoreCase(const std::string& s1, const std::string& s2)
+{
+  if (s1.size() != s2.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < s1.size(); ++i) {
+    if (ToLower(s1[i]) != ToLower(s2[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
 const Any Properties::emptyAny;
 
 Properties::Properties(const AnyMap& p)
@@ -47,13 +63,15 @@ Properties::Properties(const AnyMap& p)
   keys.reserve(p.size());
   values.reserve(p.size());
 
+  auto& keyTable = PropertyKeyTable::Instance();
   for (auto& iter : p) {
-    if (Find_unlocked(iter.first) > -1) {
+    auto key = keyTable.Intern(iter.first);
+    if (Find_unlocked(key.get()) > -1) {
       std::string msg("Properties contain case variants of the key: ");
       msg += iter.first;
       throw std::runtime_error(msg.c_str());
     }
-    keys.push_back(iter.first);
+    keys.push_back(std::move(key));
     values.push_back(iter.second);
   }
 }
@@ -79,7 +97,7 @@ Any Properties::Value_unlocked(const std::string& key) const
   return values[i];
 }
 
-Any Properties::Value_unlocked(int index) const
+const Any& Properties::Value_unlocked(int index) const
 {
   if (index < 0 || static_cast<std::size_t>(index) >= values.size()) {
     return emptyAny;
@@ -89,9 +107,10 @@ Any Properties::Value_unlocked(int index) const
 
 int Properties::Find_unlocked(const std::string& key) const
 {
+  // Comparing the few keys directly is cheaper than looking up the
+  // interned key in the framework-wide table.
   for (std::size_t i = 0; i < keys.size(); ++i) {
-    if (key.size() == keys[i].size() &&
-        ci_compare(key.c_str(), keys[i].c_str(), key.size()) == 0) {
+    if (EqualsIgnoreCase(keys[i]->name, key)) {
       return static_cast<int>(i);
     }
   }
@@ -101,7 +120,27 @@ int Properties::Find_unlocked(const std::string& key) const
 int Properties::FindCaseSensitive_unlocked(const std::string& key) const
 {
   for (std::size_t i = 0; i < keys.size(); ++i) {
-    if (key == keys[i]) {
+    if (keys[i]->name == key) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int Properties::Find_unlocked(const InternedKey* key) const
+{
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i]->folded == key->folded) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int Properties::FindCaseSensitive_unlocked(const InternedKey* key) const
+{
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i].get() == key) {
       return static_cast<int>(i);
     }
   }
@@ -110,7 +149,12 @@ int Properties::FindCaseSensitive_unlocked(const std::string& key) const
 
 std::vector<std::string> Properties::Keys_unlocked() const
 {
-  return keys;
+  std::vector<std::string> result;
+  result.reserve(keys.size());
+  for (auto& key : keys) {
+    result.push_back(key->name);
+  }
+  return result;
 }
 
 void Properties::Clear_unlocked()
@@ -119,5 +163,3 @@ void Properties::Clear_unlocked()
   values.clear();
 }
 }
-
-US_MSVC_POP_WARNING
@@ -27,11 +27,25 @@
 #include "cppmicroservices/AnyMap.h"
 #include "cppmicroservices/detail/Threads.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace cppmicroservices {
 
+struct InternedKey;
+
+/**
+ * Thread-safe, read-only service properties.
+ *
+ * The keys are interned in the framework-wide PropertyKeyTable, so
+ * properties with the same keys share a single copy of each key string
+ * and compiled LDAP filters look up keys by address.
+ *
+ * Key lookups scan the keys. Service properties hold few keys, and most
+ * of them differ in length from the looked up key, so a scan is cheaper
+ * than hashing the key, and saves a hash table per service.
+ */
 class Properties : public detail::MultiThreaded<>
 {
 
@@ -42,17 +56,20 @@ public:
   Properties& operator=(Properties&& o) noexcept;
 
   Any Value_unlocked(const std::string& key) const;
-  Any Value_unlocked(int index) const;
+  const Any& Value_unlocked(int index) const;
 
   int Find_unlocked(const std::string& key) const;
   int FindCaseSensitive_unlocked(const std::string& key) const;
 
+  int Find_unlocked(const InternedKey* key) const;
+  int FindCaseSensitive_unlocked(const InternedKey* key) const;
+
   std::vector<std::string> Keys_unlocked() const;
 
   void Clear_unlocked();
 
 private:
-  std::vector<std::string> keys;
+  std::vector<std::shared_ptr<const InternedKey>> keys;
   std::vector<Any> values;
 
   static const Any emptyAny;
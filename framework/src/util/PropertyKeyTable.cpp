@@ -0,0 +1,143 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "PropertyKeyTable.h"
+
+#include <algorithm>
+
+namespace cppmicroservices {
+
+namespace {
+
+bool IsUpper(char c)
+{
+  return c >= 'A' && c <= 'Z';
+}
+
+std::string ToLower(std::string_view str)
+{
+  std::string lowerStr(str);
+  for (auto& c : lowerStr) {
+    if (IsUpper(c)) {
+      c = static_cast<char>(c | 0x20);
+    }
+  }
+  return lowerStr;
+}
+}
+
+PropertyKeyTable& PropertyKeyTable::Instance()
+{
+  static auto* table = new PropertyKeyTable();
+  return *table;
+}
+
+std::shared_ptr<const InternedKey> PropertyKeyTable::Intern(
+  std::string_view key)
+{
+  // A released key with a lower case variant usually releases that, too
+  auto manyReleased = [this]() {
+    return released.load(std::memory_order_relaxed) * 4 > keys.size();
+  };
+
+  {
+    // Keys which are still referenced are found under a shared lock
+    std::shared_lock<std::shared_mutex> l(mutex);
+    auto iter = keys.find(key);
+    if (iter != keys.end() && !manyReleased()) {
+      if (auto interned = iter->second.ref.lock()) {
+        return interned;
+      }
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> l(mutex);
+  if (manyReleased()) {
+    RemoveReleased_unlocked();
+  }
+  return Intern_unlocked(key);
+}
+
+std::size_t PropertyKeyTable::Size() const
+{
+  std::shared_lock<std::shared_mutex> l(mutex);
+  return keys.size();
+}
+
+std::shared_ptr<const InternedKey> PropertyKeyTable::Intern_unlocked(
+  std::string_view key)
+{
+  // Releasing the last reference only counts the released key, it never
+  // deletes the key or locks the table.
+  auto makeRef = [this](const InternedKey* k) {
+    return std::shared_ptr<const InternedKey>(k, [this](const InternedKey*) {
+      released.fetch_add(1, std::memory_order_relaxed);
+    });
+  };
+
+  auto iter = keys.find(key);
+  if (iter != keys.end()) {
+    if (auto interned = iter->second.ref.lock()) {
+      return interned;
+    }
+    // Reuse a released key which was not removed yet
+    auto interned = makeRef(iter->second.key.get());
+    iter->second.ref = interned;
+    return interned;
+  }
+
+  std::shared_ptr<const InternedKey> folded;
+  if (std::any_of(key.begin(), key.end(), IsUpper)) {
+    folded = Intern_unlocked(ToLower(key));
+  }
+
+  Entry entry{ std::make_unique<InternedKey>(), {} };
+  entry.key->name = std::string(key);
+  entry.key->folded = folded ? folded.get() : entry.key.get();
+  entry.key->foldedRef = std::move(folded);
+  auto interned = makeRef(entry.key.get());
+  entry.ref = interned;
+  std::string_view name(entry.key->name);
+  keys.emplace(name, std::move(entry));
+  return interned;
+}
+
+void PropertyKeyTable::RemoveReleased_unlocked()
+{
+  // Removing a key may release its lower case variant, which is removed
+  // in a second pass.
+  for (int pass = 0;
+       pass < 2 && released.exchange(0, std::memory_order_relaxed) > 0;
+       ++pass) {
+    for (auto iter = keys.begin(); iter != keys.end();) {
+      if (iter->second.ref.expired()) {
+        // Synchronize with the release of the last reference before
+        // deleting the key.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        iter = keys.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+}
+}
@@ -0,0 +1,118 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_PROPERTYKEYTABLE_H
+#define CPPMICROSERVICES_PROPERTYKEYTABLE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cppmicroservices {
+
+/**
+ * A property key interned in the PropertyKeyTable.
+ *
+ * Two interned keys are equal if and only if their addresses are equal.
+ * They are equal ignoring the case of ASCII letters if and only if their
+ * <code>folded</code> members are equal.
+ */
+struct InternedKey
+{
+  std::string name;
+
+  /** The interned lower case variant of <code>name</code>. */
+  const InternedKey* folded;
+
+  /** Keeps the lower case variant interned, if it is a different key. */
+  std::shared_ptr<const InternedKey> foldedRef;
+};
+
+/**
+ * A framework-wide table of interned property keys.
+ *
+ * Services typically share a small set of property keys, so Properties
+ * objects store references to interned keys instead of their own string
+ * copies, and compiled LDAP filters compare keys by address.
+ *
+ * A key stays interned while references to it exist. Releasing the last
+ * reference does not lock the table; the table removes released keys in
+ * bulk when interning, once they make up a large part of its entries.
+ * Interning a key which is still referenced only takes a shared lock.
+ *
+ * This class is not part of the public API.
+ */
+class PropertyKeyTable
+{
+public:
+  PropertyKeyTable() = default;
+
+  PropertyKeyTable(const PropertyKeyTable&) = delete;
+  PropertyKeyTable& operator=(const PropertyKeyTable&) = delete;
+
+  /**
+   * The framework-wide table. It is never destroyed, so that references
+   * held by static objects can be released at any time.
+   */
+  static PropertyKeyTable& Instance();
+
+  /**
+   * Get a reference to the interned key for <code>key</code>, interning it
+   * and its lower case variant if necessary.
+   *
+   * @param key The key to intern.
+   * @return The interned key, never <code>nullptr</code>.
+   */
+  std::shared_ptr<const InternedKey> Intern(std::string_view key);
+
+  /**
+   * @return The number of keys in the table, including lower case variants
+   *         and released keys which have not been removed yet.
+   */
+  std::size_t Size() const;
+
+private:
+  struct Entry
+  {
+    std::unique_ptr<InternedKey> key;
+    std::weak_ptr<const InternedKey> ref;
+  };
+
+  std::shared_ptr<const InternedKey> Intern_unlocked(std::string_view key);
+
+  void RemoveReleased_unlocked();
+
+  mutable std::shared_mutex mutex;
+
+  // The map keys refer to the name of the InternedKey of the entry
+  std::unordered_map<std::string_view, Entry> keys;
+
+  // The number of keys whose last reference was released
+  std::atomic<std::size_t> released{ 0 };
+};
+}
+
+#endif // CPPMICROSERVICES_PROPERTYKEYTABLE_H
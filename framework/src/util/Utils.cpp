@@ -67,16 +67,7 @@ bool IsBundleFile(const std::string& location)
       topLevelDirs.begin(),
       topLevelDirs.end(),
       [&resContainer](const std::string& dir) -> bool {
-        std::vector<std::string> names;
-        std::vector<uint32_t> indices;
-
-        resContainer.GetChildren(dir + "/", true, names, indices);
-        return std::any_of(names.begin(),
-                           names.end(),
-                           [](const std::string& resourceName) -> bool {
-                             return (resourceName ==
-                                     std::string("manifest.json"));
-                           });
+        return resContainer.HasEntry(dir + "/manifest.json");
       });
   } catch (...) {
     return false;
@@ -86,21 +77,7 @@ bool IsBundleFile(const std::string& location)
 bool OnlyContainsManifest(
   const std::shared_ptr<BundleResourceContainer>& resContainer)
 {
-  auto topLevelDirs = resContainer->GetTopLevelDirs();
-  return std::all_of(
-    topLevelDirs.begin(),
-    topLevelDirs.end(),
-    [&resContainer](const std::string& dir) -> bool {
-      std::vector<std::string> names;
-      std::vector<uint32_t> indices;
-
-      resContainer->GetChildren(dir + "/", true, names, indices);
-      return std::all_of(names.begin(),
-                         names.end(),
-                         [](const std::string& resourceName) -> bool {
-                           return resourceName == std::string("manifest.json");
-                         });
-    });
+  return resContainer->OnlyContainsManifests();
 }
 
 //-------------------------------------------------------------------
@@ -9,7 +9,9 @@
 #include <cppmicroservices/FrameworkFactory.h>
 
 #include <cassert>
+#include <cctype>
 #include <iostream>
+#include <streambuf>
 
 #include "TestUtils.h"
 
@@ -159,7 +161,167 @@ BENCHMARK_DEFINE_F(AnyMapPerfTestFixture, ErrorPath_NoThrowOverload)
   }
 }
 
+// Builds a property map of the size and value types typically used as
+// service properties.
+AnyMap MakeServiceProperties(int count)
+{
+  AnyMap props(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  for (int i = 0; i < count; i += 4) {
+    auto suffix = std::to_string(i);
+    props["service.ranking" + suffix] = i;
+    props["service.enabled" + suffix] = true;
+    props["service.pid" + suffix] = std::string("com.example.service");
+    props["service.weight" + suffix] = 0.5;
+  }
+  return props;
+}
+
+static void ConstructServiceProperties(benchmark::State& state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MakeServiceProperties(count));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void CopyServiceProperties(benchmark::State& state)
+{
+  const auto count = static_cast<int>(state.range(0));
+  const AnyMap props = MakeServiceProperties(count);
+  for (auto _ : state) {
+    AnyMap copy(props);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Copies an Any holding an int, a short string, a long string and a
+// vector of strings.
+static void CopyAny(benchmark::State& state)
+{
+  const std::vector<Any> values{
+    Any(42),
+    Any(std::string("short")),
+    Any(std::string(64, 'l')),
+    Any(std::vector<std::string>{ "a", "b" })
+  };
+  const Any& value = values[state.range(0)];
+  for (auto _ : state) {
+    Any copy(value);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+// Builds a nested AnyMap of about 10 MB of JSON: 100 maps of 1000
+// entries, each holding a string, a number, a boolean and a vector.
+const Any& LargeNestedMap()
+{
+  static const Any tree = [] {
+    AnyMap root(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    for (int i = 0; i < 100; ++i) {
+      AnyMap child(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+      for (int j = 0; j < 1000; ++j) {
+        AnyMap entry(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+        entry["name"] = std::string("a \"quoted\" value of some length");
+        entry["count"] = j;
+        entry["enabled"] = (j % 2) == 0;
+        entry["tags"] = std::vector<Any>{ std::string("tag"), 1.5 };
+        child["entry_" + std::to_string(j)] = std::move(entry);
+      }
+      root["map_" + std::to_string(i)] = std::move(child);
+    }
+    return Any(std::move(root));
+  }();
+  return tree;
+}
+
+// Discards everything written to it, to measure serialization alone.
+class NullBuffer : public std::streambuf
+{
+protected:
+  int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+  std::streamsize xsputn(const char*, std::streamsize n) override
+  {
+    return n;
+  }
+};
+
+static void LargeAnyMapToJSON(benchmark::State& state)
+{
+  const Any& tree = LargeNestedMap();
+  std::size_t size = 0;
+  for (auto _ : state) {
+    auto json = tree.ToJSON(state.range(0) != 0);
+    size = json.size();
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void LargeAnyMapWriteJSON(benchmark::State& state)
+{
+  const Any& tree = LargeNestedMap();
+  const auto size = tree.ToJSON(state.range(0) != 0).size();
+  NullBuffer buffer;
+  std::ostream os(&buffer);
+  for (auto _ : state) {
+    tree.ToJSON(os, state.range(0) != 0);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void LargeAnyMapToString(benchmark::State& state)
+{
+  const Any& tree = LargeNestedMap();
+  std::size_t size = 0;
+  for (auto _ : state) {
+    auto str = tree.ToString();
+    size = str.size();
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
 // Register functions as benchmarrk
+// Looks up the keys of a manifest sized case insensitive map in upper
+// case. The argument selects the key type: 0 for std::string, 1 for
+// std::string_view and 2 for string literals.
+static void FindCaseInsensitive(benchmark::State& state)
+{
+  AnyMap m(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 32; ++i) {
+    keys.push_back("bundle.header_" + std::to_string(i));
+    m[keys.back()] = i;
+  }
+  for (auto& key : keys) {
+    for (auto& c : key) {
+      c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+  }
+
+  std::size_t i = 0;
+  switch (state.range(0)) {
+    case 0:
+      for (auto _ : state) {
+        benchmark::DoNotOptimize(m.find(keys[i++ % keys.size()]));
+      }
+      break;
+    case 1:
+      for (auto _ : state) {
+        std::string_view key = keys[i++ % keys.size()];
+        benchmark::DoNotOptimize(m.find(key));
+      }
+      break;
+    default:
+      for (auto _ : state) {
+        benchmark::DoNotOptimize(m.find(keys[i++ % keys.size()].c_str()));
+      }
+      break;
+  }
+}
+
 BENCHMARK_REGISTER_F(AnyMapPerfTestFixture, HappyPath)
   ->Arg(1)
   ->Arg(3)
@@ -192,3 +354,12 @@ BENCHMARK_REGISTER_F(AnyMapPerfTestFixture, ErrorPath_NoThrowOverload)
   ->Arg(15)
   ->Arg(18)
   ->Arg(20);
+BENCHMARK(ConstructServiceProperties)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(CopyServiceProperties)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(CopyAny)->DenseRange(0, 3);
+// The argument enables pretty printing
+BENCHMARK(LargeAnyMapToJSON)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(LargeAnyMapWriteJSON)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(LargeAnyMapToString)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(FindCaseInsensitive)->DenseRange(0, 2);
@@ -12,8 +12,11 @@
 
 #include <chrono>
 #include <iostream>
+#include <thread>
 #include <vector>
 
+#include "TestUtils.h"
+
 using namespace cppmicroservices;
 
 namespace {
@@ -228,3 +231,274 @@ BENCHMARK_REGISTER_F(ServiceRegistryFixture, ModifyServices)
 ->RangeMultiplier(4)
 ->Ranges({ { 1, 1000 }, { 1, 1000 } })
 ->UseManualTime();
+
+/**
+ * Looks up properties on services which all share the same handful of
+ * custom property keys. Property keys are interned framework-wide, so the
+ * registrations share one copy of each key and lookups compare pointers.
+ */
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, GetPropertyWithSharedKeys)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  auto regCount = state.range(0);
+
+  std::vector<ServiceRegistration<TestInterface>> regs;
+  for (auto i = regCount; i > 0; --i) {
+    ServiceProperties props;
+    props["perf.service.component.name"] = std::string("component");
+    props["perf.service.configuration.pid"] = static_cast<int>(i);
+    props["perf.service.vendor.description"] = std::string("vendor");
+    regs.push_back(fc.RegisterService<TestInterface>(
+      std::make_shared<TestInterface>(), props));
+  }
+
+  std::vector<ServiceReferenceU> refs;
+  for (auto& reg : regs) {
+    refs.push_back(reg.GetReference());
+  }
+
+  for (auto _ : state) {
+    for (auto& ref : refs) {
+      benchmark::DoNotOptimize(
+        ref.GetProperty("PERF.SERVICE.CONFIGURATION.PID"));
+    }
+  }
+
+  for (auto& reg : regs) {
+    reg.Unregister();
+  }
+}
+
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, GetPropertyWithSharedKeys)
+  ->RangeMultiplier(10)
+  ->Range(10, 10000);
+
+/**
+ * Registers and unregisters a service while many service listeners, each
+ * interested in a different interface, are registered. Only the listeners
+ * whose filters can match the service should be examined.
+ */
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, RegisterServiceWithManyListeners)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  auto fc = framework->GetBundleContext();
+  auto listenerCount = state.range(0);
+
+  std::vector<ListenerToken> tokens;
+  for (auto i = listenerCount; i > 0; --i) {
+    std::string filter{ "(&(" + Constants::OBJECTCLASS + "=TestInterface" +
+                        std::to_string(i) + ")(perf.service.value=*))" };
+    tokens.push_back(fc.AddServiceListener([](const ServiceEvent&) {}, filter));
+  }
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+
+  for (auto _ : state) {
+    InterfaceMapPtr iMapCopy(std::make_shared<InterfaceMap>(*interfaceMap));
+    auto start = high_resolution_clock::now();
+    auto reg = fc.RegisterService(iMapCopy);
+    reg.Unregister();
+    auto end = high_resolution_clock::now();
+    auto elapsed_seconds = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+  }
+
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, RegisterServiceWithManyListeners)
+  ->RangeMultiplier(10)
+  ->Range(10, 20000)
+  ->UseManualTime();
+
+/**
+ * Registers services while a slow service listener is registered. With
+ * asynchronous delivery (second argument 1) the registering thread does
+ * not wait for the listener.
+ */
+static void RegisterServicesWithSlowListener(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  FrameworkConfiguration config;
+  if (state.range(1) != 0) {
+    config[Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY] =
+      Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY_ASYNC;
+    config[Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_DEPTH] =
+      static_cast<int>(state.range(0)) * 2;
+  }
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto fc = framework.GetBundleContext();
+  fc.AddServiceListener(
+    [](const ServiceEvent&) { std::this_thread::sleep_for(microseconds(50)); });
+
+  for (auto _ : state) {
+    std::vector<ServiceRegistration<TestInterface>> regs;
+    auto start = high_resolution_clock::now();
+    for (auto i = state.range(0); i > 0; --i) {
+      regs.push_back(
+        fc.RegisterService<TestInterface>(std::make_shared<TestInterface>()));
+    }
+    auto end = high_resolution_clock::now();
+    state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+
+    for (auto& reg : regs) {
+      reg.Unregister();
+    }
+  }
+
+  auto stats = framework.GetServiceEventDeliveryStatistics();
+  state.counters["avgLatencyUs"] =
+    static_cast<double>(stats.averageLatency.count());
+  state.counters["maxQueueDepth"] = static_cast<double>(stats.maxQueueDepth);
+
+  framework.Stop();
+  framework.WaitForStop(milliseconds::zero());
+}
+
+BENCHMARK(RegisterServicesWithSlowListener)
+  ->Args({ 100, 0 })
+  ->Args({ 100, 1 })
+  ->UseManualTime();
+
+/**
+ * Registers and unregisters ranked services, either one by one (second
+ * argument 0) or with a single call to RegisterServices and
+ * UnregisterServices (second argument 1).
+ */
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, RegisterServicesInBatch)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  auto fc = framework->GetBundleContext();
+  auto regCount = state.range(0);
+  const bool batch = state.range(1) != 0;
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(2);
+
+  for (auto _ : state) {
+    std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+    for (auto i = regCount; i > 0; --i) {
+      services.emplace_back(
+        std::make_shared<InterfaceMap>(*interfaceMap),
+        ServiceProperties{
+          { Constants::SERVICE_RANKING, Any(static_cast<int>(i % 100)) } });
+    }
+
+    auto start = high_resolution_clock::now();
+    std::vector<ServiceRegistrationBase> regs;
+    if (batch) {
+      auto batchRegs = fc.RegisterServices(services);
+      regs.assign(batchRegs.begin(), batchRegs.end());
+      fc.UnregisterServices(regs);
+    } else {
+      for (auto& service : services) {
+        regs.push_back(fc.RegisterService(service.first, service.second));
+      }
+      for (auto& reg : regs) {
+        reg.Unregister();
+      }
+    }
+    auto end = high_resolution_clock::now();
+    state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+  }
+}
+
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, RegisterServicesInBatch)
+  ->Args({ 10000, 0 })
+  ->Args({ 10000, 1 })
+  ->UseManualTime();
+
+/**
+ * Registers, re-ranks and unregisters a single service while the number of
+ * services registered under the same interface grows. The cost of each
+ * operation should only grow logarithmically.
+ */
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, ModifyRankingAtScale)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  auto fc = framework->GetBundleContext();
+  auto regCount = state.range(0);
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+
+  std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+  for (auto i = regCount; i > 0; --i) {
+    services.emplace_back(
+      interfaceMap,
+      ServiceProperties{
+        { Constants::SERVICE_RANKING, Any(static_cast<int>(i % 1000)) } });
+  }
+  auto regs = fc.RegisterServices(services);
+  services.clear();
+
+  int ranking = 0;
+  for (auto _ : state) {
+    InterfaceMapPtr iMapCopy(std::make_shared<InterfaceMap>(*interfaceMap));
+    auto start = high_resolution_clock::now();
+    auto reg = fc.RegisterService(iMapCopy);
+    reg.SetProperties(
+      { { Constants::SERVICE_RANKING, Any(++ranking % 1000) } });
+    reg.Unregister();
+    auto end = high_resolution_clock::now();
+    state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+  }
+
+  fc.UnregisterServices(
+    std::vector<ServiceRegistrationBase>(regs.begin(), regs.end()));
+}
+
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, ModifyRankingAtScale)
+  ->RangeMultiplier(10)
+  ->Range(1000, 1000000)
+  ->UseManualTime();
+
+/**
+ * Stops a bundle while many services registered by other bundles are
+ * registered and in use. The cost of stopping the bundle should only
+ * depend on the services the bundle itself registered and used.
+ */
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, StopBundleInLargeRegistry)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  auto fc = framework->GetBundleContext();
+  auto regCount = state.range(0);
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+
+  std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services(
+    regCount, std::make_pair(interfaceMap, ServiceProperties()));
+  auto regs = fc.RegisterServices(services);
+  services.clear();
+
+  // the framework bundle uses every 100th service
+  std::vector<std::shared_ptr<void>> used;
+  for (std::size_t i = 0; i < regs.size(); i += 100) {
+    used.push_back(fc.GetService(regs[i].GetReference()));
+  }
+
+  auto bundle = cppmicroservices::testing::InstallLib(fc, "TestBundleA");
+  for (auto _ : state) {
+    bundle.Start();
+    auto start = high_resolution_clock::now();
+    bundle.Stop();
+    auto end = high_resolution_clock::now();
+    state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+  }
+
+  used.clear();
+  fc.UnregisterServices(
+    std::vector<ServiceRegistrationBase>(regs.begin(), regs.end()));
+}
+
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, StopBundleInLargeRegistry)
+  ->RangeMultiplier(10)
+  ->Range(500, 500000)
+  ->UseManualTime();
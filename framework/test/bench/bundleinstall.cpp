@@ -2,9 +2,11 @@
 #include <cppmicroservices/Bundle.h>
 #include <cppmicroservices/BundleContext.h>
 #include <cppmicroservices/BundleEvent.h>
+#include <cppmicroservices/Constants.h>
 #include <cppmicroservices/Framework.h>
 #include <cppmicroservices/FrameworkEvent.h>
 #include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
 #include <future>
 
 #include "TestUtils.h"
@@ -123,6 +125,114 @@ protected:
     framework.Stop();
     framework.WaitForStop(milliseconds::zero());
   }
+
+#ifdef US_BUILD_SHARED_LIBS
+  // Returns the locations of a set of test bundle libraries.
+  static std::vector<std::string> GetTestBundleLocations()
+  {
+    using namespace cppmicroservices;
+
+    std::vector<std::string> locations;
+    auto framework = FrameworkFactory().NewFramework();
+    framework.Start();
+    for (auto name : { "TestBundleA",
+                       "TestBundleA2",
+                       "TestBundleB",
+                       "TestBundleH",
+                       "TestBundleLQ",
+                       "TestBundleM",
+                       "TestBundleR",
+                       "TestBundleRA",
+                       "TestBundleRL",
+                       "TestBundleS",
+                       "TestBundleSL1",
+                       "TestBundleSL3",
+                       "TestBundleSL4" }) {
+      locations.push_back(
+        testing::InstallLib(framework.GetBundleContext(), name).GetLocation());
+    }
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+    return locations;
+  }
+
+  // Installs a set of bundle libraries with a single
+  // BundleContext::InstallBundles call, preparing them on
+  // state.range(0) threads.
+  void InstallBundlesInParallel(benchmark::State& state)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    // Resolve the library locations once, outside of the timed loop.
+    auto locations = GetTestBundleLocations();
+
+    FrameworkConfiguration config;
+    config[Constants::FRAMEWORK_BUNDLE_INSTALL_THREADS] =
+      static_cast<int>(state.range(0));
+
+    for (auto _ : state) {
+      auto framework = FrameworkFactory().NewFramework(config);
+      framework.Start();
+      auto context = framework.GetBundleContext();
+
+      auto start = high_resolution_clock::now();
+      benchmark::DoNotOptimize(context.InstallBundles(locations));
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+  }
+
+  // Measures framework startup followed by the installation of a set of
+  // bundle libraries, with the bundle metadata cache enabled. For a cold
+  // start the cache is cleared before each iteration.
+  void StartupWithMetadataCache(benchmark::State& state, bool warm)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    auto locations = GetTestBundleLocations();
+    testing::TempDir storage(testing::MakeUniqueTempDirectory());
+    const std::string cacheDir = storage.Path + util::DIR_SEP + "metadata";
+
+    FrameworkConfiguration config;
+    config[Constants::FRAMEWORK_STORAGE] = storage.Path;
+    config[Constants::FRAMEWORK_BUNDLE_METADATA_CACHE] = true;
+
+    auto startup = [&config, &locations]() {
+      auto framework = FrameworkFactory().NewFramework(config);
+      framework.Start();
+      benchmark::DoNotOptimize(
+        framework.GetBundleContext().InstallBundles(locations));
+      return framework;
+    };
+
+    if (warm) {
+      auto framework = startup();
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+
+    for (auto _ : state) {
+      if (!warm && util::Exists(cacheDir)) {
+        util::RemoveDirectoryRecursive(cacheDir);
+      }
+
+      auto start = high_resolution_clock::now();
+      auto framework = startup();
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+  }
+#endif
 };
 BENCHMARK_DEFINE_F(BundleInstallFixture, BundleInstallCppFramework)
 (benchmark::State& state)
@@ -136,6 +246,26 @@ BENCHMARK_DEFINE_F(BundleInstallFixture, LargeBundleInstallCppFramework)
   InstallWithCppFramework(state, "largeBundle");
 }
 
+#ifdef US_BUILD_SHARED_LIBS
+BENCHMARK_DEFINE_F(BundleInstallFixture, InstallBundlesInParallel)
+(benchmark::State& state)
+{
+  InstallBundlesInParallel(state);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, ColdStartupWithMetadataCache)
+(benchmark::State& state)
+{
+  StartupWithMetadataCache(state, false);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, WarmStartupWithMetadataCache)
+(benchmark::State& state)
+{
+  StartupWithMetadataCache(state, true);
+}
+#endif
+
 #if defined(PERFORM_LARGE_CONCURRENCY_TEST)
 BENCHMARK_DEFINE_F(BundleInstallFixture, ConcurrentBundleInstall1Thread)
 (benchmark::State& state)
@@ -173,6 +303,17 @@ BENCHMARK_REGISTER_F(BundleInstallFixture, BundleInstallCppFramework)
   ->UseManualTime();
 BENCHMARK_REGISTER_F(BundleInstallFixture, LargeBundleInstallCppFramework)
   ->UseManualTime();
+#ifdef US_BUILD_SHARED_LIBS
+BENCHMARK_REGISTER_F(BundleInstallFixture, InstallBundlesInParallel)
+  ->Arg(1)
+  ->Arg(4)
+  ->Arg(16)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleInstallFixture, ColdStartupWithMetadataCache)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleInstallFixture, WarmStartupWithMetadataCache)
+  ->UseManualTime();
+#endif
 #if defined(PERFORM_LARGE_CONCURRENCY_TEST)
 BENCHMARK_REGISTER_F(BundleInstallFixture, ConcurrentBundleInstall1Thread)
   ->UseManualTime();
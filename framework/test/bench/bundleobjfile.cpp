@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/BundleObjFactory.h>
+#include <cppmicroservices/util/BundleObjFile.h>
+#include <cppmicroservices/util/FileSystem.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "benchmark/benchmark.h"
+
+#ifdef US_BUILD_SHARED_LIBS
+
+// Copies each test bundle library 'copies' times into a temporary
+// directory, so that locating the resources of a bundle file is measured
+// over several hundred different files.
+class BundleObjFileFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State&)
+  {
+    using namespace cppmicroservices;
+
+    const int copies = 25;
+    dir = testing::TempDir(testing::MakeUniqueTempDirectory());
+    auto framework = FrameworkFactory().NewFramework();
+    framework.Start();
+    for (auto name : { "TestBundleA",
+                       "TestBundleA2",
+                       "TestBundleB",
+                       "TestBundleH",
+                       "TestBundleLQ",
+                       "TestBundleM",
+                       "TestBundleR",
+                       "TestBundleRA",
+                       "TestBundleRL",
+                       "TestBundleS",
+                       "TestBundleSL1",
+                       "TestBundleSL3",
+                       "TestBundleSL4" }) {
+      std::ifstream in(
+        testing::InstallLib(framework.GetBundleContext(), name).GetLocation(),
+        std::ios_base::binary);
+      std::string content{ std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>() };
+      for (int i = 0; i < copies; ++i) {
+        files.push_back(dir.Path + util::DIR_SEP + name + std::to_string(i) +
+                        US_LIB_EXT);
+        std::ofstream(files.back(), std::ios_base::binary) << content;
+      }
+    }
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    files.clear();
+    dir = cppmicroservices::testing::TempDir();
+  }
+
+  ~BundleObjFileFixture() = default;
+
+  cppmicroservices::testing::TempDir dir;
+  std::vector<std::string> files;
+};
+
+BENCHMARK_DEFINE_F(BundleObjFileFixture, LocateResources)
+(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  for (auto _ : state) {
+    for (auto const& file : files) {
+      auto obj = BundleObjFactory().CreateBundleFileObj(file);
+      benchmark::DoNotOptimize(obj->GetRawBundleResourceContainer());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * files.size());
+}
+
+BENCHMARK_REGISTER_F(BundleObjFileFixture, LocateResources);
+
+#endif
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "benchmark/benchmark.h"
+
+#ifdef US_BUILD_SHARED_LIBS
+
+// Installs 5000 bundles from a single bundle library by injecting their
+// manifests, so that lookups run against a large registry.
+class BundleRegistryFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State&)
+  {
+    using namespace cppmicroservices;
+
+    std::string location;
+    {
+      auto f = FrameworkFactory().NewFramework();
+      f.Start();
+      location =
+        testing::InstallLib(f.GetBundleContext(), "TestBundleA").GetLocation();
+      f.Stop();
+      f.WaitForStop(std::chrono::milliseconds::zero());
+    }
+
+    AnyMap manifests(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    for (int i = 0; i < bundleCount; ++i) {
+      auto name = "bundle_" + std::to_string(i);
+      AnyMap manifest(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+      manifest["bundle.symbolic_name"] = name;
+      manifests[name] = manifest;
+    }
+
+    framework = std::make_shared<Framework>(FrameworkFactory().NewFramework());
+    framework->Start();
+    bundles =
+      framework->GetBundleContext().InstallBundles(location, manifests);
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    using namespace std::chrono;
+
+    bundles.clear();
+    framework->Stop();
+    framework->WaitForStop(milliseconds::zero());
+  }
+
+  ~BundleRegistryFixture() = default;
+
+  static const int bundleCount = 5000;
+  std::shared_ptr<cppmicroservices::Framework> framework;
+  std::vector<cppmicroservices::Bundle> bundles;
+};
+
+BENCHMARK_DEFINE_F(BundleRegistryFixture, GetBundleById)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    auto id = bundles[i++ % bundles.size()].GetBundleId();
+    benchmark::DoNotOptimize(context.GetBundle(id));
+  }
+}
+
+BENCHMARK_DEFINE_F(BundleRegistryFixture, GetBundles)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context.GetBundles());
+  }
+}
+
+BENCHMARK_REGISTER_F(BundleRegistryFixture, GetBundleById);
+BENCHMARK_REGISTER_F(BundleRegistryFixture, GetBundles);
+
+#endif
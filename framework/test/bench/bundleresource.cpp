@@ -0,0 +1,307 @@
+#include <chrono>
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/BundleResource.h>
+#include <cppmicroservices/BundleResourceStream.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "benchmark/benchmark.h"
+
+class BundleResourceFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State&) {}
+
+  ~BundleResourceFixture() = default;
+
+protected:
+  // Reads the same resource from state.range(0) threads at the same time.
+  // Each thread opens a stream 'readsPerThread' times and reads the whole
+  // resource.
+  void ReadConcurrently(benchmark::State& state,
+                        const std::string& bundleName,
+                        const std::string& resourcePath)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    const auto numThreads = static_cast<int>(state.range(0));
+    const int readsPerThread = 10;
+
+    auto framework = cppmicroservices::FrameworkFactory().NewFramework();
+    framework.Start();
+    auto bundle =
+      testing::InstallLib(framework.GetBundleContext(), bundleName);
+    auto resource = bundle.GetResource(resourcePath);
+
+    auto readResource = [&resource]() {
+      std::size_t bytes = 0;
+      for (int i = 0; i < readsPerThread; ++i) {
+        BundleResourceStream rs(resource, std::ios_base::binary);
+        char buffer[4096];
+        while (rs.read(buffer, sizeof(buffer))) {
+          bytes += sizeof(buffer);
+        }
+        bytes += static_cast<std::size_t>(rs.gcount());
+      }
+      return bytes;
+    };
+
+    for (auto _ : state) {
+      auto start = high_resolution_clock::now();
+
+      std::vector<std::future<std::size_t>> results;
+      for (int i = 0; i < numThreads; ++i) {
+        results.push_back(std::async(std::launch::async, readResource));
+      }
+      for (auto& res : results) {
+        benchmark::DoNotOptimize(res.get());
+      }
+
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            numThreads * readsPerThread * resource.GetSize());
+
+    framework.Stop();
+    framework.WaitForStop(milliseconds::zero());
+  }
+};
+
+// The resource is stored without compression and read directly from the
+// mapped bundle file.
+BENCHMARK_DEFINE_F(BundleResourceFixture, ReadStoredResourceConcurrently)
+(benchmark::State& state)
+{
+  ReadConcurrently(state, "TestBundleRS", "/icons/compressable.bmp");
+}
+
+// The same resource, decompressed on every read.
+BENCHMARK_DEFINE_F(BundleResourceFixture, ReadCompressedResourceConcurrently)
+(benchmark::State& state)
+{
+  ReadConcurrently(state, "TestBundleR", "/icons/compressable.bmp");
+}
+
+// Reads the first 4 KiB of the compressed resource, which is inflated on
+// demand instead of as a whole.
+BENCHMARK_DEFINE_F(BundleResourceFixture, ReadCompressedResourcePrefix)
+(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle =
+    testing::InstallLib(framework.GetBundleContext(), "TestBundleR");
+  auto resource = bundle.GetResource("/icons/compressable.bmp");
+
+  for (auto _ : state) {
+    BundleResourceStream rs(resource, std::ios_base::binary);
+    char buffer[4096];
+    rs.read(buffer, sizeof(buffer));
+    benchmark::DoNotOptimize(rs.gcount());
+  }
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+namespace {
+
+uint32_t Crc32(const std::string& data)
+{
+  uint32_t crc = 0xffffffff;
+  for (unsigned char c : data) {
+    crc ^= c;
+    for (int i = 0; i < 8; ++i) {
+      crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// The names and contents of zip entries. Names ending with '/' are
+// directories.
+using ZipEntries = std::vector<std::pair<std::string, std::string>>;
+
+// Writes a zip64 archive with the given entries, stored without
+// compression.
+void WriteZipFile(const std::string& path, const ZipEntries& entries)
+{
+  auto put = [](std::string& out, uint64_t value, int size) {
+    for (int i = 0; i < size; ++i) {
+      out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  };
+
+  std::string archive;
+  std::string centralDirectory;
+  for (auto const& entry : entries) {
+    const auto& name = entry.first;
+    const auto& data = entry.second;
+    const uint32_t crc = Crc32(data);
+
+    // The central directory header, see APPNOTE.TXT, section 4.3.12.
+    put(centralDirectory, 0x02014b50, 4);
+    put(centralDirectory, 20, 2);
+    put(centralDirectory, 20, 2);
+    put(centralDirectory, 0, 4);
+    put(centralDirectory, 0, 2);
+    put(centralDirectory, 0x21, 2);
+    put(centralDirectory, crc, 4);
+    put(centralDirectory, data.size(), 4);
+    put(centralDirectory, data.size(), 4);
+    put(centralDirectory, name.size(), 2);
+    put(centralDirectory, 0, 8);
+    put(centralDirectory, 0, 4);
+    put(centralDirectory, archive.size(), 4);
+    centralDirectory += name;
+
+    // The local file header, see APPNOTE.TXT, section 4.3.7.
+    put(archive, 0x04034b50, 4);
+    put(archive, 20, 2);
+    put(archive, 0, 4);
+    put(archive, 0, 2);
+    put(archive, 0x21, 2);
+    put(archive, crc, 4);
+    put(archive, data.size(), 4);
+    put(archive, data.size(), 4);
+    put(archive, name.size(), 2);
+    put(archive, 0, 2);
+    archive += name;
+    archive += data;
+  }
+
+  const uint64_t centralDirectoryOffset = archive.size();
+  archive += centralDirectory;
+
+  // The zip64 end of central directory record and its locator, which
+  // are needed for more than 65535 entries.
+  const uint64_t endOfCentralDirectoryOffset = archive.size();
+  put(archive, 0x06064b50, 4);
+  put(archive, 44, 8);
+  put(archive, 45, 2);
+  put(archive, 45, 2);
+  put(archive, 0, 8);
+  put(archive, entries.size(), 8);
+  put(archive, entries.size(), 8);
+  put(archive, centralDirectory.size(), 8);
+  put(archive, centralDirectoryOffset, 8);
+
+  put(archive, 0x07064b50, 4);
+  put(archive, 0, 4);
+  put(archive, endOfCentralDirectoryOffset, 8);
+  put(archive, 1, 4);
+
+  put(archive, 0x06054b50, 4);
+  put(archive, 0, 4);
+  put(archive, 0xffff, 2);
+  put(archive, 0xffff, 2);
+  put(archive, centralDirectory.size(), 4);
+  put(archive, centralDirectoryOffset, 4);
+  put(archive, 0, 2);
+
+  std::ofstream(path, std::ios_base::binary) << archive;
+}
+}
+
+// Installs a bundle with 100 directories of 1000 resources each, one in
+// a hundred of which is a .json file.
+class LargeBundleResourceFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State&)
+  {
+    using namespace cppmicroservices;
+
+    const std::string name = "largeResourceBundle";
+    ZipEntries entries{
+      { name + "/", "" },
+      { name + "/manifest.json",
+        "{ \"bundle.symbolic_name\" : \"" + name + "\" }" },
+      { name + "/res/", "" }
+    };
+    for (int dir = 0; dir < 100; ++dir) {
+      auto dirName = name + "/res/dir" + std::to_string(dir) + "/";
+      entries.emplace_back(dirName, "");
+      for (int file = 0; file < 1000; ++file) {
+        entries.emplace_back(dirName + "resource" + std::to_string(file) +
+                               (file % 100 == 0 ? ".json" : ".txt"),
+                             "");
+      }
+    }
+
+    dir = testing::TempDir(testing::MakeUniqueTempDirectory());
+    auto location = dir.Path + util::DIR_SEP + name + ".zip";
+    WriteZipFile(location, entries);
+
+    framework = std::make_shared<Framework>(FrameworkFactory().NewFramework());
+    framework->Start();
+    bundle = framework->GetBundleContext().InstallBundles(location).at(0);
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    bundle = cppmicroservices::Bundle();
+    framework->Stop();
+    framework->WaitForStop(std::chrono::milliseconds::zero());
+    framework.reset();
+    dir = cppmicroservices::testing::TempDir();
+  }
+
+  ~LargeBundleResourceFixture() = default;
+
+  cppmicroservices::testing::TempDir dir;
+  std::shared_ptr<cppmicroservices::Framework> framework;
+  cppmicroservices::Bundle bundle;
+};
+
+BENCHMARK_DEFINE_F(LargeBundleResourceFixture, FindResourcesRecursive)
+(benchmark::State& state)
+{
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bundle.FindResources("res", "*.json", true));
+  }
+}
+
+BENCHMARK_DEFINE_F(LargeBundleResourceFixture, FindResourcesInDirectory)
+(benchmark::State& state)
+{
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+      bundle.FindResources("res/dir50", "resource1*.txt", false));
+  }
+}
+
+// Register functions as benchmark
+BENCHMARK_REGISTER_F(BundleResourceFixture, ReadStoredResourceConcurrently)
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleResourceFixture,
+                     ReadCompressedResourceConcurrently)
+  ->RangeMultiplier(2)
+  ->Range(1, 16)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleResourceFixture, ReadCompressedResourcePrefix);
+BENCHMARK_REGISTER_F(LargeBundleResourceFixture, FindResourcesRecursive);
+BENCHMARK_REGISTER_F(LargeBundleResourceFixture, FindResourcesInDirectory);
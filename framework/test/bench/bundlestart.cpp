@@ -0,0 +1,149 @@
+#include <chrono>
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Constants.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "TestUtils.h"
+#include "benchmark/benchmark.h"
+
+#ifdef US_BUILD_SHARED_LIBS
+
+// Copies the TestBundleA library 200 times into a temporary directory, so
+// that starting the bundles loads 200 different shared libraries and runs
+// their activators.
+class BundleStartFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State&)
+  {
+    using namespace cppmicroservices;
+
+    dir = testing::TempDir(testing::MakeUniqueTempDirectory());
+    auto framework = FrameworkFactory().NewFramework();
+    framework.Start();
+    std::ifstream in(
+      testing::InstallLib(framework.GetBundleContext(), "TestBundleA")
+        .GetLocation(),
+      std::ios_base::binary);
+    std::string content{ std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>() };
+    for (int i = 0; i < bundleCount; ++i) {
+      files.push_back(dir.Path + util::DIR_SEP + "TestBundleA" +
+                      std::to_string(i) + US_LIB_EXT);
+      std::ofstream(files.back(), std::ios_base::binary) << content;
+    }
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    files.clear();
+    dir = cppmicroservices::testing::TempDir();
+  }
+
+  // Installs the copies into a new framework. Each copy gets its own
+  // version, so that the bundles can share the symbolic name of the
+  // activator in the library.
+  std::vector<cppmicroservices::Bundle> Install(
+    cppmicroservices::Framework& framework)
+  {
+    using namespace cppmicroservices;
+
+    framework.Start();
+    std::vector<Bundle> bundles;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      AnyMap manifest(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+      manifest["bundle.symbolic_name"] = std::string("TestBundleA");
+      manifest["bundle.version"] = "1.0." + std::to_string(i);
+      manifest["bundle.activator"] = true;
+      AnyMap manifests(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+      manifests["TestBundleA"] = manifest;
+      auto installed =
+        framework.GetBundleContext().InstallBundles(files[i], manifests);
+      bundles.insert(bundles.end(), installed.begin(), installed.end());
+    }
+    return bundles;
+  }
+
+  ~BundleStartFixture() = default;
+
+  static const int bundleCount = 200;
+  cppmicroservices::testing::TempDir dir;
+  std::vector<std::string> files;
+};
+
+// The argument enables recording the bundle phase timings, to measure
+// their overhead.
+BENCHMARK_DEFINE_F(BundleStartFixture, StartSequential)
+(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_BUNDLE_TIMING] = state.range(0) != 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto framework = FrameworkFactory().NewFramework(config);
+    auto bundles = Install(framework);
+    state.ResumeTiming();
+
+    for (auto& bundle : bundles) {
+      bundle.Start();
+    }
+
+    state.PauseTiming();
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * bundleCount);
+}
+
+BENCHMARK_DEFINE_F(BundleStartFixture, StartBundles)
+(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_BUNDLE_START_THREADS] =
+    static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto framework = FrameworkFactory().NewFramework(config);
+    auto bundles = Install(framework);
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(
+      framework.GetBundleContext().StartBundles(bundles));
+
+    state.PauseTiming();
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * bundleCount);
+}
+
+BENCHMARK_REGISTER_F(BundleStartFixture, StartSequential)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(BundleStartFixture, StartBundles)
+  ->Arg(1)
+  ->Arg(4)
+  ->Arg(16)
+  ->Unit(benchmark::kMillisecond);
+
+#endif
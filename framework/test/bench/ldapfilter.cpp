@@ -6,6 +6,9 @@
 #include <cppmicroservices/LDAPFilter.h>
 #include <cppmicroservices/LDAPProp.h>
 
+#include <cstdint>
+#include <string>
+
 #include "TestUtils.h"
 #include "benchmark/benchmark.h"
 #include "fooservice.h"
@@ -26,6 +29,46 @@ static void ConstructNonTrivialFilterFromString(benchmark::State& state)
   };
 }
 
+// Every iteration uses a filter string which has not been seen before, so
+// each construction pays the full parse cost. Compare with
+// ConstructNonTrivialFilterFromString, which is served from the parse cache.
+static void ConstructUncachedNonTrivialFilterFromString(benchmark::State& state)
+{
+  static std::uint64_t i = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto filterStr = "( |(cn=Babs *)(sn=" + std::to_string(i++) + ") )";
+    state.ResumeTiming();
+    LDAPFilter filter(filterStr);
+  };
+}
+
+// Service queries with a filter string, as issued by service trackers.
+static void GetServiceReferencesWithFilter(benchmark::State& state)
+{
+  using namespace benchmark::test;
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+  ServiceProperties props;
+  props["bundle_priority"] = std::string("high");
+  (void)context.RegisterService<Foo>(std::make_shared<FooImpl>(), props);
+
+  auto before = LDAPFilter::GetCacheStatistics();
+  for (auto _ : state) {
+    (void)context.GetServiceReferences<Foo>("(bundle_priority=high)");
+  }
+  auto after = LDAPFilter::GetCacheStatistics();
+  state.counters["cache_hits"] =
+    static_cast<double>(after.hits - before.hits);
+  state.counters["cache_misses"] =
+    static_cast<double>(after.misses - before.misses);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
 LDAPFilter GetSimpleLDAPFilter()
 {
   return LDAPFilter("(bundle_priority=high)");
@@ -119,6 +162,8 @@ static void MatchFilterWithServiceReference(benchmark::State& state,
 // Register functions as benchmark
 BENCHMARK(ConstructFilterFromString);
 BENCHMARK(ConstructNonTrivialFilterFromString);
+BENCHMARK(ConstructUncachedNonTrivialFilterFromString);
+BENCHMARK(GetServiceReferencesWithFilter);
 BENCHMARK_CAPTURE(MatchFilterWithAnyMap, Simple, GetSimpleLDAPFilter());
 BENCHMARK_CAPTURE(MatchFilterWithAnyMap, Complex, GetComplexLDAPFilter());
 BENCHMARK_CAPTURE(MatchFilterWithBundle, Simple, GetSimpleLDAPFilter());
@@ -1,6 +1,16 @@
 #include "benchmark/benchmark.h"
+#include <cppmicroservices/AnyMap.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/LDAPFilter.h>
 #include <cppmicroservices/LDAPProp.h>
 
+#include <chrono>
+
+#include "fooservice.h"
+
 static void ConstructFilterIncremental(benchmark::State& state)
 {
   using namespace cppmicroservices;
@@ -26,6 +36,89 @@ static void ConstructFilterNotOperator(benchmark::State& state)
   };
 }
 
+namespace {
+
+cppmicroservices::ServiceProperties GetEvaluationProperties()
+{
+  using namespace cppmicroservices;
+
+  ServiceProperties props;
+  props["mode"] = std::string("cloud");
+  props["minProgLevel"] = std::string("Managed");
+  props["IsDynamic"] = true;
+  props["priority"] = 42;
+  props["load"] = 0.75;
+  props["tags"] = std::vector<std::string>{ "fast", "remote", "cached" };
+  return props;
+}
+
+// LDAPPropExpr filters of increasing complexity, covering string, wildcard,
+// bool, integer, floating point and list comparisons.
+cppmicroservices::LDAPPropExpr GetEvaluationExpr(int64_t complexity)
+{
+  using namespace cppmicroservices;
+
+  LDAPPropExpr expr;
+  expr = LDAPProp("mode") == "cloud";
+  if (complexity > 1) {
+    LDAPPropExpr level = LDAPProp("minProgLevel") == "Dynamic";
+    level |= LDAPProp("minProgLevel") == "Managed";
+    expr &= level;
+    expr &= LDAPProp("IsDynamic") == true;
+  }
+  if (complexity > 2) {
+    expr &= LDAPProp("priority") >= 10;
+    expr &= LDAPProp("load") <= 0.9;
+    expr &= LDAPProp("tags") == "rem*";
+    expr &= !(LDAPProp("mode").Approx("On Premise"));
+  }
+  return expr;
+}
+}
+
+// Evaluates filters against the properties of a registered service. The
+// filters are compiled once when the LDAPFilter is constructed; the
+// iterations measure evaluation only.
+static void EvaluateFilterWithServiceReference(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+  using namespace benchmark::test;
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+  auto reg = context.RegisterService<Foo>(std::make_shared<FooImpl>(),
+                                          GetEvaluationProperties());
+  auto ref = reg.GetReference();
+  LDAPFilter filter(GetEvaluationExpr(state.range(0)));
+  if (!filter.Match(ref)) {
+    state.SkipWithError("Error: Filter does not match the service properties");
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter.Match(ref));
+  }
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Same as above, against an AnyMap. This includes the cost of copying the
+// AnyMap into the properties used for evaluation.
+static void EvaluateFilterWithAnyMap(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  AnyMap props(GetEvaluationProperties());
+  LDAPFilter filter(GetEvaluationExpr(state.range(0)));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter.Match(props));
+  }
+}
+
 // Register functions as benchmarrk
 BENCHMARK(ConstructFilterIncremental);
 BENCHMARK(ConstructFilterNotOperator);
+BENCHMARK(EvaluateFilterWithServiceReference)->DenseRange(1, 3);
+BENCHMARK(EvaluateFilterWithAnyMap)->DenseRange(1, 3);
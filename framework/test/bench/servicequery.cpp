@@ -4,7 +4,10 @@
 #include <cppmicroservices/FrameworkFactory.h>
 #include <cppmicroservices/ServiceReference.h>
 
+#include <atomic>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 
@@ -96,6 +99,102 @@ BENCHMARK_DEFINE_F(ServiceFixture,
   }
 }
 
+BENCHMARK_DEFINE_F(ServiceFixture, GetServiceByInterface)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  auto ref = context.GetServiceReference<benchmark::test::Foo>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context.GetService(ref));
+  }
+}
+
+// Measures the throughput of GetServiceReferences calls made concurrently
+// from state.range(0) reader threads while one writer thread keeps
+// registering and unregistering services of the same interface.
+BENCHMARK_DEFINE_F(ServiceFixture,
+                   ConcurrentGetServiceReferencesWithRegistrationChurn)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+  using namespace cppmicroservices;
+  using namespace benchmark::test;
+
+  const auto readerCount = static_cast<int>(state.range(0));
+  const int queriesPerReader = 10000;
+  auto context = framework->GetBundleContext();
+
+  for (auto _ : state) {
+    std::atomic<bool> stopWriter{ false };
+    std::thread writer([&context, &stopWriter]() {
+      while (!stopWriter) {
+        auto reg = context.RegisterService<Foo>(std::make_shared<FooImpl>());
+        reg.Unregister();
+      }
+    });
+
+    auto start = high_resolution_clock::now();
+    std::vector<std::thread> readers;
+    for (int i = 0; i < readerCount; ++i) {
+      readers.emplace_back([&context, queriesPerReader]() {
+        for (int j = 0; j < queriesPerReader; ++j) {
+          (void)context.GetServiceReferences<Foo>();
+        }
+      });
+    }
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    auto end = high_resolution_clock::now();
+
+    stopWriter = true;
+    writer.join();
+
+    state.SetIterationTime(
+      duration_cast<duration<double>>(end - start).count());
+  }
+
+  state.SetItemsProcessed(state.iterations() * readerCount *
+                          queriesPerReader);
+}
+
+// Measures the throughput of GetService calls made concurrently from
+// state.range(0) threads, which all get the same service through the
+// same bundle context.
+BENCHMARK_DEFINE_F(ServiceFixture, ConcurrentGetService)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  const auto threadCount = static_cast<int>(state.range(0));
+  const int getsPerThread = 10000;
+  auto context = framework->GetBundleContext();
+  auto ref = context.GetServiceReference<benchmark::test::Foo>();
+  // Keep the service in use, as a long-lived consumer would
+  auto service = context.GetService(ref);
+
+  for (auto _ : state) {
+    auto start = high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+      threads.emplace_back([&context, &ref, getsPerThread]() {
+        for (int j = 0; j < getsPerThread; ++j) {
+          benchmark::DoNotOptimize(context.GetService(ref));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto end = high_resolution_clock::now();
+
+    state.SetIterationTime(
+      duration_cast<duration<double>>(end - start).count());
+  }
+
+  state.SetItemsProcessed(state.iterations() * threadCount * getsPerThread);
+}
+
 // Register benchmark functions
 BENCHMARK_REGISTER_F(ServiceFixture, GetServiceReferenceByInterface);
 BENCHMARK_REGISTER_F(ServiceFixture, GetServiceReferenceByClassName);
@@ -105,3 +204,17 @@ BENCHMARK_REGISTER_F(ServiceFixture,
                      GetAllServiceReferencesByClassNameAndLDAPFilter);
 BENCHMARK_REGISTER_F(ServiceFixture,
                      GetAllServiceReferencesByInterfaceAndLDAPFilter);
+BENCHMARK_REGISTER_F(ServiceFixture, GetServiceByInterface);
+
+// The argument is the number of concurrent reader threads
+BENCHMARK_REGISTER_F(ServiceFixture,
+                     ConcurrentGetServiceReferencesWithRegistrationChurn)
+  ->RangeMultiplier(2)
+  ->Range(1, 64)
+  ->UseManualTime();
+
+// The argument is the number of threads getting the service
+BENCHMARK_REGISTER_F(ServiceFixture, ConcurrentGetService)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseManualTime();
@@ -257,6 +257,61 @@ TEST(AnyMapTest, CIHashUnique)
   ASSERT_EQ(true, hashV1 != hashV2);
 }
 
+TEST(AnyMapTest, CIHashLongKeys)
+{
+  // Keys longer than eight characters are hashed and compared a word at a
+  // time, so check letters at every position and the characters next to
+  // the letter ranges.
+  std::string lower = "bundle.symbolic_name";
+  std::string upper = "BUNDLE.SYMBOLIC_NAME";
+  std::string mixed = "Bundle.Symbolic_Name";
+
+  any_map::unordered_any_cimap::hasher hash;
+  any_map::unordered_any_cimap::key_equal equal;
+  ASSERT_EQ(hash(lower), hash(upper));
+  ASSERT_EQ(hash(lower), hash(std::string_view(mixed)));
+  ASSERT_TRUE(equal(lower, upper));
+  ASSERT_TRUE(equal(std::string_view(lower), std::string_view(mixed)));
+
+  ASSERT_FALSE(equal(std::string("@[@[@[@[@["), std::string("`{`{`{`{`{")));
+  ASSERT_NE(hash(std::string("@[@[@[@[@[")), hash(std::string("`{`{`{`{`{")));
+  ASSERT_FALSE(equal(std::string("bundle.symbolic_nam"), lower.substr(1)));
+  ASSERT_FALSE(equal(std::string("\xc1\xc1\xc1\xc1\xc1\xc1\xc1\xc1"),
+                     std::string("\xe1\xe1\xe1\xe1\xe1\xe1\xe1\xe1")));
+}
+
+TEST(AnyMapTest, LookupWithoutString)
+{
+  for (auto type : { AnyMap::ORDERED_MAP,
+                     AnyMap::UNORDERED_MAP,
+                     AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS }) {
+    AnyMap m(type);
+    m["bundle.symbolic_name"] = std::string("main");
+    const AnyMap& cm = m;
+
+    const std::string_view key = "xbundle.symbolic_namex";
+    const auto name = key.substr(1, key.size() - 2);
+    ASSERT_EQ(1u, m.count(name));
+    ASSERT_EQ(1u, m.count("bundle.symbolic_name"));
+    ASSERT_EQ(0u, m.count(key));
+    ASSERT_EQ("main", any_cast<std::string>(m.at(name)));
+    ASSERT_EQ("main", any_cast<std::string>(cm.at(name)));
+    ASSERT_EQ("main", any_cast<std::string>(cm.at("bundle.symbolic_name")));
+    ASSERT_THROW(m.at(key), std::out_of_range);
+    ASSERT_THROW(cm.at("bundle.version"), std::out_of_range);
+    ASSERT_TRUE(cm.find(name) != cm.end());
+    ASSERT_TRUE(cm.find("bundle.version") == cm.end());
+
+    m.at(name) = std::string("other");
+    ASSERT_EQ("other", any_cast<std::string>(m.at("bundle.symbolic_name")));
+  }
+
+  AnyMap ci(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  ci["Bundle.Symbolic_Name"] = std::string("main");
+  ASSERT_EQ(1u, ci.count(std::string_view("BUNDLE.SYMBOLIC_NAME")));
+  ASSERT_EQ("main", any_cast<std::string>(ci.at("bundle.symbolic_name")));
+}
+
 TEST(AnyMapTest, GeneralUsage)
 {
   ASSERT_THROW(AnyMap m(static_cast<AnyMap::map_type>(100)), std::logic_error);
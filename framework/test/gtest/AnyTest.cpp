@@ -236,6 +236,36 @@ TEST(AnyTest, AnyMapComplex)
   EXPECT_EQ(anyMap.ToJSON(), toJSONRes);
 }
 
+TEST(AnyTest, AnyWriteToStream)
+{
+  std::vector<Any> values{ std::string("a\x01"), true, 10, 1.5 };
+  std::map<std::string, Any> map{ { "values", values },
+                                  { "flag", false },
+                                  { "count", 17 } };
+  Any anyMap = map;
+
+  std::ostringstream json;
+  anyMap.ToJSON(json, true);
+  EXPECT_EQ(json.str(), anyMap.ToJSON(true));
+
+  std::ostringstream str;
+  anyMap.ToString(str);
+  EXPECT_EQ(str.str(), anyMap.ToString());
+
+  // escaping strings and writing booleans must not change the
+  // formatting of the values which follow them in the same stream
+  std::ostringstream os;
+  Any(std::string("\x1f")).ToJSON(os);
+  Any(true).ToJSON(os);
+  os << ' ' << 10 << ' ' << true;
+  EXPECT_EQ(os.str(), "\"\\u001f\"true 10 1");
+
+  std::ostringstream empty;
+  EXPECT_EQ(Any().ToJSON(empty).good(), true);
+  EXPECT_EQ(empty.str(), "null");
+  EXPECT_THROW(Any().ToString(empty), std::logic_error);
+}
+
 TEST(AnyTest, AnyBadAnyCastException)
 {
   const Any uncastableConstAny(0.0);
@@ -304,3 +334,79 @@ TEST(AnyTest, AnyEquality)
     rhs); // and finally, with the "int" element erased, they should not be equal
           // anymore.
 }
+
+namespace {
+// A value which is too large to be stored inline
+struct LargeValue
+{
+  std::array<char, 128> data;
+  bool operator==(const LargeValue& o) const { return data == o.data; }
+  friend std::ostream& operator<<(std::ostream& os, const LargeValue&)
+  {
+    return os << "large";
+  }
+};
+
+// A value which is stored on the heap because moving it may throw
+struct ThrowingMove
+{
+  ThrowingMove() = default;
+  ThrowingMove(const ThrowingMove&) = default;
+  ThrowingMove(ThrowingMove&&) noexcept(false) {}
+  bool operator==(const ThrowingMove&) const { return true; }
+  friend std::ostream& operator<<(std::ostream& os, const ThrowingMove&)
+  {
+    return os << "throwing";
+  }
+};
+}
+
+#ifndef US_ENABLE_ANY_INLINE_STORAGE
+// Without inline storage Any keeps its original layout
+static_assert(sizeof(Any) == sizeof(void*), "Any changed its layout");
+#endif
+
+TEST(AnyTest, AnyCopyMoveSwapInlineAndHeap)
+{
+  LargeValue large;
+  large.data.fill('x');
+  auto shared = std::make_shared<int>(7);
+  std::vector<Any> values{ Any(42),
+                           Any(std::string("short")),
+                           Any(std::string(100, 's')),
+                           Any(shared),
+                           Any(large),
+                           Any(ThrowingMove()),
+                           Any() };
+
+  for (auto const& value : values) {
+    Any copy(value);
+    EXPECT_EQ(copy.Type(), value.Type());
+    Any moved(std::move(copy));
+    EXPECT_TRUE(copy.Empty());
+    EXPECT_EQ(moved.Type(), value.Type());
+    EXPECT_EQ(moved.ToStringNoExcept(), value.ToStringNoExcept());
+
+    for (auto const& other : values) {
+      Any lhs(value);
+      Any rhs(other);
+      lhs.Swap(rhs);
+      EXPECT_EQ(lhs.Type(), other.Type());
+      EXPECT_EQ(rhs.Type(), value.Type());
+      EXPECT_EQ(lhs.ToStringNoExcept(), other.ToStringNoExcept());
+      EXPECT_EQ(rhs.ToStringNoExcept(), value.ToStringNoExcept());
+
+      lhs = std::move(rhs);
+      EXPECT_TRUE(rhs.Empty());
+      EXPECT_EQ(lhs.ToStringNoExcept(), value.ToStringNoExcept());
+    }
+  }
+
+  EXPECT_EQ(any_cast<std::string>(values[2]), std::string(100, 's'));
+  EXPECT_EQ(ref_any_cast<LargeValue>(values[4]), large);
+
+  // copies share the pointee, and clearing all of them releases it
+  EXPECT_EQ(shared.use_count(), 2);
+  values.clear();
+  EXPECT_EQ(shared.use_count(), 1);
+}
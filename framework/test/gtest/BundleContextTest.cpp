@@ -214,4 +214,60 @@ TEST(BundleContextTest, NoSegfaultWithServiceFactory)
 
   thread.join();
 }
+
+TEST(BundleContextTest, ConcurrentGetServiceKeepsUseCount)
+{
+  cppmicroservices::Framework framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  auto service = std::make_shared<bc_tests::TestService>();
+  std::weak_ptr<bc_tests::TestService> weakService = service;
+  auto reg = context.RegisterService<bc_tests::TestService>(service);
+  service.reset();
+  auto ref = reg.GetReference();
+
+  {
+    auto held = context.GetService(ref);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back([&context, &ref]() {
+        for (int j = 0; j < 1000; ++j) {
+          ASSERT_TRUE(context.GetService(ref));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    ASSERT_EQ(1, ref.GetUsingBundles().size());
+  }
+  ASSERT_TRUE(ref.GetUsingBundles().empty());
+
+  // unregister while other threads keep getting the service
+  std::atomic<bool> stop{ false };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&context, &ref, &stop]() {
+      try {
+        while (!stop) {
+          (void)context.GetService(ref);
+        }
+      } catch (const std::invalid_argument&) {
+        // the reference became invalid
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  reg.Unregister();
+  EXPECT_FALSE(ref);
+  stop = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_TRUE(weakService.expired());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
 #endif
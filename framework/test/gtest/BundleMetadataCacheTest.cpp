@@ -0,0 +1,267 @@
+/*=============================================================================
+
+Library: CppMicroServices
+
+Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+file at the top-level directory of this distribution and at
+https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+=============================================================================*/
+
+#include "cppmicroservices/Bundle.h"
+#include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/BundleResource.h"
+#include "cppmicroservices/Constants.h"
+#include "cppmicroservices/Framework.h"
+#include "cppmicroservices/FrameworkEvent.h"
+#include "cppmicroservices/FrameworkFactory.h"
+#include "cppmicroservices/util/FileSystem.h"
+
+#include "TestUtils.h"
+#include "TestingConfig.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace cppmicroservices;
+using cppmicroservices::testing::TempDir;
+
+namespace {
+
+std::string GetTestBundlePath(const std::string& name)
+{
+  return cppmicroservices::testing::LIB_PATH + util::DIR_SEP +
+         US_LIB_PREFIX + name + US_LIB_POSTFIX + US_LIB_EXT;
+}
+
+std::string ReadFile(const std::string& path)
+{
+  std::ifstream in(path, std::ios_base::binary);
+  return std::string{ std::istreambuf_iterator<char>(in),
+                      std::istreambuf_iterator<char>() };
+}
+
+void WriteFile(const std::string& path, const std::string& content)
+{
+  std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+  out << content;
+}
+
+// Returns the cache entries in storage. If location is not empty, only
+// the entries for that bundle file are returned; the framework also caches
+// the bundles embedded in the test executable.
+std::vector<std::string> GetCacheFiles(const std::string& storage,
+                                       const std::string& location = {})
+{
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (auto const& entry : std::filesystem::directory_iterator(
+         storage + util::DIR_SEP + "metadata", ec)) {
+    // Each entry records the location of the bundle file it describes.
+    if (location.empty() ||
+        ReadFile(entry.path().string()).find(location) != std::string::npos) {
+      files.push_back(entry.path().string());
+    }
+  }
+  return files;
+}
+
+class BundleMetadataCacheTest : public ::testing::Test
+{
+protected:
+  BundleMetadataCacheTest()
+    : storage(cppmicroservices::testing::MakeUniqueTempDirectory())
+  {}
+
+  // Installs the bundle library at location in a new framework and
+  // returns the sorted symbolic names of the installed bundles.
+  std::vector<std::string> Install(const std::string& location,
+                                   bool useCache = true)
+  {
+    FrameworkConfiguration config;
+    config[Constants::FRAMEWORK_STORAGE] = storage.Path;
+    config[Constants::FRAMEWORK_BUNDLE_METADATA_CACHE] = useCache;
+    auto framework = FrameworkFactory().NewFramework(config);
+    framework.Start();
+
+    std::vector<std::string> names;
+    for (auto const& b :
+         framework.GetBundleContext().InstallBundles(location)) {
+      names.push_back(b.GetSymbolicName());
+    }
+    std::sort(names.begin(), names.end());
+
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+    return names;
+  }
+
+  TempDir storage;
+};
+
+}
+
+TEST_F(BundleMetadataCacheTest, testDisabledByDefault)
+{
+  ASSERT_EQ(std::vector<std::string>{ "TestBundleA" },
+            Install(GetTestBundlePath("TestBundleA"), false));
+  EXPECT_TRUE(GetCacheFiles(storage.Path).empty());
+}
+
+TEST_F(BundleMetadataCacheTest, testWarmInstall)
+{
+  auto location = GetTestBundlePath("TestBundleR");
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_STORAGE] = storage.Path;
+  config[Constants::FRAMEWORK_BUNDLE_METADATA_CACHE] = true;
+
+  AnyMap coldHeaders(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  for (int i = 0; i < 2; ++i) {
+    auto framework = FrameworkFactory().NewFramework(config);
+    framework.Start();
+
+    auto bundles = framework.GetBundleContext().InstallBundles(location);
+    ASSERT_EQ(1u, bundles.size());
+    auto bundle = bundles.front();
+    EXPECT_EQ("TestBundleR", bundle.GetSymbolicName());
+    EXPECT_EQ(1u, GetCacheFiles(storage.Path, location).size());
+
+    if (i == 0) {
+      coldHeaders = bundle.GetHeaders();
+    } else {
+      EXPECT_EQ(coldHeaders, bundle.GetHeaders());
+    }
+
+    // Resources are read from the bundle file, using the cached index.
+    auto resource = bundle.GetResource("icons/compressable.bmp");
+    ASSERT_TRUE(resource.IsValid());
+    EXPECT_GT(resource.GetSize(), 0);
+    EXPECT_FALSE(bundle.FindResources("", "*.json", false).empty());
+
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+}
+
+TEST_F(BundleMetadataCacheTest, testCachedManifestIsUsed)
+{
+  // Use a location which does not contain the symbolic name.
+  TempDir libDir(cppmicroservices::testing::MakeUniqueTempDirectory());
+  auto location = libDir.Path + util::DIR_SEP + "bundle" + US_LIB_EXT;
+  WriteFile(location, ReadFile(GetTestBundlePath("TestBundleA")));
+
+  ASSERT_EQ(std::vector<std::string>{ "TestBundleA" }, Install(location));
+  auto cacheFiles = GetCacheFiles(storage.Path, location);
+  ASSERT_EQ(1u, cacheFiles.size());
+
+  // Rename the bundle in the cache entry only.
+  auto entry = ReadFile(cacheFiles.front());
+  for (auto pos = entry.find("TestBundleA"); pos != std::string::npos;
+       pos = entry.find("TestBundleA", pos)) {
+    entry.replace(pos, 11, "TestBundleX");
+  }
+  WriteFile(cacheFiles.front(), entry);
+
+  EXPECT_EQ(std::vector<std::string>{ "TestBundleX" }, Install(location));
+  EXPECT_EQ(std::vector<std::string>{ "TestBundleA" },
+            Install(location, false));
+}
+
+TEST_F(BundleMetadataCacheTest, testModifiedBundleFile)
+{
+  TempDir libDir(cppmicroservices::testing::MakeUniqueTempDirectory());
+  auto location = libDir.Path + util::DIR_SEP + "bundle" + US_LIB_EXT;
+
+  WriteFile(location, ReadFile(GetTestBundlePath("TestBundleA")));
+  ASSERT_EQ(std::vector<std::string>{ "TestBundleA" }, Install(location));
+
+  // A different bundle at the same location replaces the cache entry. The
+  // TestBundleB library contains two bundles.
+  WriteFile(location, ReadFile(GetTestBundlePath("TestBundleB")));
+  std::vector<std::string> const bundlesInB{ "TestBundleB",
+                                             "TestBundleImportedByB" };
+  EXPECT_EQ(bundlesInB, Install(location));
+  EXPECT_EQ(bundlesInB, Install(location));
+  EXPECT_EQ(1u, GetCacheFiles(storage.Path, location).size());
+}
+
+TEST_F(BundleMetadataCacheTest, testCorruptCacheEntry)
+{
+  auto location = GetTestBundlePath("TestBundleA");
+  ASSERT_EQ(std::vector<std::string>{ "TestBundleA" }, Install(location));
+
+  auto cacheFiles = GetCacheFiles(storage.Path, location);
+  ASSERT_EQ(1u, cacheFiles.size());
+  auto entry = ReadFile(cacheFiles.front());
+
+  // Truncated entries and garbage are ignored and replaced.
+  WriteFile(cacheFiles.front(), entry.substr(0, entry.size() / 2));
+  EXPECT_EQ(std::vector<std::string>{ "TestBundleA" }, Install(location));
+  EXPECT_EQ(entry, ReadFile(cacheFiles.front()));
+
+  WriteFile(cacheFiles.front(), std::string(entry.size(), '\x7f'));
+  EXPECT_EQ(std::vector<std::string>{ "TestBundleA" }, Install(location));
+  EXPECT_EQ(entry, ReadFile(cacheFiles.front()));
+}
+
+TEST_F(BundleMetadataCacheTest, testInstallBundlesUsesCache)
+{
+  std::vector<std::string> locations{ GetTestBundlePath("TestBundleA"),
+                                      GetTestBundlePath("TestBundleB"),
+                                      GetTestBundlePath("TestBundleM") };
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_STORAGE] = storage.Path;
+  config[Constants::FRAMEWORK_BUNDLE_METADATA_CACHE] = true;
+
+  for (int i = 0; i < 2; ++i) {
+    auto framework = FrameworkFactory().NewFramework(config);
+    framework.Start();
+    auto bundles = framework.GetBundleContext().InstallBundles(locations);
+
+    // The result holds every bundle of each library, TestBundleB also
+    // contains TestBundleImportedByB.
+    std::vector<std::string> names;
+    for (auto const& b : bundles) {
+      names.push_back(b.GetSymbolicName());
+    }
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ((std::vector<std::string>{ "TestBundleA",
+                                         "TestBundleB",
+                                         "TestBundleImportedByB",
+                                         "TestBundleM" }),
+              names);
+    for (auto const& location : locations) {
+      EXPECT_EQ(1u, GetCacheFiles(storage.Path, location).size());
+    }
+
+    auto bundleA = std::find_if(
+      bundles.begin(), bundles.end(), [](const Bundle& b) {
+        return b.GetSymbolicName() == "TestBundleA";
+      });
+    ASSERT_NE(bundles.end(), bundleA);
+    bundleA->Start();
+    EXPECT_EQ(Bundle::STATE_ACTIVE, bundleA->GetState());
+
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+}
@@ -32,6 +32,10 @@
 
 #include "gtest/gtest.h"
 
+#if defined(US_PLATFORM_LINUX)
+#  include <dlfcn.h>
+#endif
+
 namespace {
 #if defined(US_BUILD_SHARED_LIBS)
 const std::string testBundlePath =
@@ -89,10 +93,38 @@ TEST(BundleObjFile, GetRawBundleResourceContainer)
 
     ASSERT_TRUE(data);
     ASSERT_GT(data->GetSize(), 0u);
+    // The data starts with the first local file header of the zip file.
+    ASSERT_EQ(0, memcmp(data->GetData(), "PK\x03\x04", 4));
   });
 #endif
 }
 
+#if defined(US_PLATFORM_LINUX)
+namespace {
+void LocalFunction() {}
+}
+
+TEST(BundleObjFile, ResourcesOfLoadedExecutable)
+{
+  auto bundleObj = cppmicroservices::BundleObjFactory().CreateBundleFileObj(
+    cppmicroservices::util::GetExecutablePath());
+  auto data = bundleObj->GetRawBundleResourceContainer();
+  if (!data) {
+    GTEST_SKIP() << "The executable has no linked resources.";
+  }
+
+  // The resources are read from the loaded executable, not from a new
+  // mapping of the file.
+  Dl_info dataInfo;
+  Dl_info exeInfo;
+  ASSERT_NE(0, dladdr(data->GetData(), &dataInfo));
+  ASSERT_NE(0,
+            dladdr(reinterpret_cast<const void*>(&LocalFunction), &exeInfo));
+  EXPECT_EQ(exeInfo.dli_fbase, dataInfo.dli_fbase);
+  EXPECT_EQ(0, memcmp(data->GetData(), "PK\x03\x04", 4));
+}
+#endif
+
 #if defined(US_BUILD_SHARED_LIBS)
 #  if defined(US_PLATFORM_APPLE) || defined(US_PLATFORM_POSIX)
 TEST(BundleObjFile, MappedFile)
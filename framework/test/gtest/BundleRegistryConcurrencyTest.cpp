@@ -21,6 +21,9 @@ limitations under the License.
 =============================================================================*/
 
 #include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/BundleEvent.h"
+#include "cppmicroservices/BundleResource.h"
+#include "cppmicroservices/Constants.h"
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/FrameworkFactory.h"
@@ -31,6 +34,8 @@ limitations under the License.
 #include "TestingConfig.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -142,6 +147,389 @@ TEST(BundleRegistryConcurrencyTest, testConcurrent)
   framework.WaitForStop(std::chrono::milliseconds::zero());
 }
 #  endif
+
+std::vector<std::string> GetTestBundleLocations()
+{
+  std::vector<std::string> locations;
+  for (auto name : { "TestBundleA",
+                     "TestBundleA2",
+                     "TestBundleB",
+                     "TestBundleH",
+                     "TestBundleLQ",
+                     "TestBundleM",
+                     "TestBundleR",
+                     "TestBundleRA",
+                     "TestBundleRL",
+                     "TestBundleS",
+                     "TestBundleSL1",
+                     "TestBundleSL3",
+                     "TestBundleSL4" }) {
+    locations.push_back(cppmicroservices::testing::LIB_PATH + util::DIR_SEP +
+                        US_LIB_PREFIX + name + US_LIB_POSTFIX + US_LIB_EXT);
+  }
+  return locations;
+}
+
+TEST(BundleRegistryConcurrencyTest, testInstallBundles)
+{
+  auto locations = GetTestBundleLocations();
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_BUNDLE_INSTALL_THREADS] = 4;
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  std::vector<Bundle> installedEvents;
+  bc.AddBundleListener([&installedEvents](const BundleEvent& evt) {
+    if (evt.GetType() == BundleEvent::BUNDLE_INSTALLED) {
+      installedEvents.push_back(evt.GetBundle());
+    }
+  });
+
+  // Install one location up front, and another one twice
+  auto preinstalled = bc.InstallBundles(locations[3]);
+  installedEvents.clear();
+  auto requested = locations;
+  requested.push_back(locations[0]);
+
+  auto bundles = bc.InstallBundles(requested);
+
+  // The result holds all bundles of each library in the order of the
+  // locations, TestBundleB also contains TestBundleImportedByB.
+  std::vector<std::vector<Bundle>> perLocation;
+  auto next = bundles.begin();
+  for (auto const& location : requested) {
+    auto count = bc.GetBundles(location).size();
+    ASSERT_LE(count, static_cast<std::size_t>(bundles.end() - next));
+    perLocation.emplace_back(next, next + count);
+    next += count;
+    for (auto const& b : perLocation.back()) {
+      ASSERT_EQ(b.GetLocation(), location);
+      ASSERT_EQ(b.GetState(), Bundle::STATE_INSTALLED);
+    }
+  }
+  ASSERT_EQ(next, bundles.end());
+  ASSERT_EQ(perLocation[2].size(), 2);
+  ASSERT_EQ(perLocation[3], preinstalled);
+  ASSERT_EQ(perLocation.back(), perLocation.front());
+
+  // Bundle ids and events follow the order of the locations
+  std::vector<Bundle> newBundles;
+  for (std::size_t i = 0; i + 1 < perLocation.size(); ++i) {
+    if (i != 3) {
+      newBundles.insert(
+        newBundles.end(), perLocation[i].begin(), perLocation[i].end());
+    }
+  }
+  ASSERT_EQ(installedEvents, newBundles);
+  for (std::size_t i = 1; i < newBundles.size(); ++i) {
+    ASSERT_LT(newBundles[i - 1].GetBundleId(), newBundles[i].GetBundleId());
+  }
+
+  // The manifests are the same as for bundles installed one at a time
+  auto serialFramework = FrameworkFactory().NewFramework();
+  serialFramework.Start();
+  for (std::size_t i = 0; i < requested.size(); ++i) {
+    auto serial =
+      serialFramework.GetBundleContext().InstallBundles(requested[i]);
+    ASSERT_EQ(serial.size(), perLocation[i].size());
+    for (std::size_t j = 0; j < serial.size(); ++j) {
+      auto const& b = perLocation[i][j];
+      ASSERT_EQ(serial[j].GetSymbolicName(), b.GetSymbolicName());
+      ASSERT_EQ(serial[j].GetVersion(), b.GetVersion());
+      ASSERT_EQ(serial[j].GetHeaders().size(), b.GetHeaders().size());
+    }
+  }
+  ASSERT_TRUE(
+    perLocation[6].front().GetResource("icons/compressable.bmp").IsValid());
+
+  for (auto& b : bundles) {
+    EXPECT_NO_THROW(b.Start());
+  }
+
+  serialFramework.Stop();
+  serialFramework.WaitForStop(std::chrono::milliseconds::zero());
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testInstallBundlesFailure)
+{
+  auto locations = GetTestBundleLocations();
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+  auto initialCount = bc.GetBundles().size();
+
+  // Locations before the failing one are installed, the others are not
+  std::vector<std::string> requested{ locations[0],
+                                      locations[1] + ".missing",
+                                      locations[2] };
+  ASSERT_THROW(bc.InstallBundles(requested), std::runtime_error);
+  ASSERT_EQ(bc.GetBundles().size(), initialCount + 1);
+  ASSERT_EQ(bc.GetBundles(locations[0]).size(), 1);
+  ASSERT_TRUE(bc.GetBundles(locations[2]).empty());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testBundleLookup)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+  auto initialCount = bc.GetBundles().size();
+
+  AnyMap manifests(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  for (int i = 0; i < 3; ++i) {
+    AnyMap manifest(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    manifest["bundle.symbolic_name"] = "lookup_" + std::to_string(i);
+    manifests["lookup_" + std::to_string(i)] = manifest;
+  }
+  auto bundles =
+    bc.InstallBundles(GetTestBundleLocations().front(), manifests);
+  ASSERT_EQ(3u, bundles.size());
+  ASSERT_EQ(initialCount + 3, bc.GetBundles().size());
+
+  for (auto const& b : bundles) {
+    EXPECT_EQ(b, bc.GetBundle(b.GetBundleId()));
+    auto atLocation = bc.GetBundles(b.GetLocation());
+    EXPECT_NE(std::find(atLocation.begin(), atLocation.end(), b),
+              atLocation.end());
+  }
+
+  auto id = bundles[1].GetBundleId();
+  bundles[1].Uninstall();
+  EXPECT_FALSE(bc.GetBundle(id));
+  auto remaining = bc.GetBundles();
+  EXPECT_EQ(initialCount + 2, remaining.size());
+  EXPECT_EQ(std::find(remaining.begin(), remaining.end(), bundles[1]),
+            remaining.end());
+  EXPECT_EQ(bundles[2], bc.GetBundle(bundles[2].GetBundleId()));
+
+  EXPECT_EQ(2u, bc.GetBundles(bundles[0].GetLocation()).size());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Installs one bundle per entry of 'dependencies' from a single bundle
+// library, with the given bundle.start_dependencies header.
+std::vector<Bundle> InstallWithStartDependencies(
+  BundleContext bc,
+  const std::vector<std::pair<std::string, Any>>& dependencies)
+{
+  AnyMap manifests(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  for (auto const& entry : dependencies) {
+    AnyMap manifest(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    manifest["bundle.symbolic_name"] = entry.first;
+    if (!entry.second.Empty()) {
+      manifest[Constants::BUNDLE_STARTDEPENDENCIES] = entry.second;
+    }
+    manifests[entry.first] = manifest;
+  }
+  auto installed =
+    bc.InstallBundles(GetTestBundleLocations().front(), manifests);
+
+  // Return the bundles in the order of 'dependencies'
+  std::vector<Bundle> bundles;
+  for (auto const& entry : dependencies) {
+    for (auto const& b : installed) {
+      if (b.GetSymbolicName() == entry.first) {
+        bundles.push_back(b);
+      }
+    }
+  }
+  return bundles;
+}
+
+TEST(BundleRegistryConcurrencyTest, testStartBundles)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_BUNDLE_START_THREADS] = 4;
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  // Dependencies on bundles which are not started together and on the
+  // bundle itself are ignored
+  auto bundles = InstallWithStartDependencies(
+    bc,
+    { { "start_c", std::vector<Any>{ std::string("start_a"),
+                                     std::string("start_b") } },
+      { "start_b", std::string("start_a") },
+      { "start_a", Any() },
+      { "start_d",
+        std::vector<Any>{ std::string("missing"), std::string("start_d") } } });
+  ASSERT_EQ(4u, bundles.size());
+
+  std::mutex eventsMutex;
+  std::vector<std::string> started;
+  bc.AddBundleListener([&](const BundleEvent& evt) {
+    if (evt.GetType() == BundleEvent::BUNDLE_STARTED) {
+      std::lock_guard<std::mutex> lock(eventsMutex);
+      started.push_back(evt.GetBundle().GetSymbolicName());
+    }
+  });
+
+  auto results = bc.StartBundles(bundles);
+  ASSERT_EQ(bundles.size(), results.size());
+  for (std::size_t i = 0; i < bundles.size(); ++i) {
+    EXPECT_EQ(bundles[i], results[i].bundle);
+    EXPECT_FALSE(results[i].exception);
+    EXPECT_EQ(Bundle::STATE_ACTIVE, bundles[i].GetState());
+  }
+
+  ASSERT_EQ(4u, started.size());
+  auto position = [&started](const std::string& name) {
+    return std::find(started.begin(), started.end(), name) - started.begin();
+  };
+  EXPECT_LT(position("start_a"), position("start_b"));
+  EXPECT_LT(position("start_b"), position("start_c"));
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testStartBundlesFailure)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  // The bundle library has no activator for start_fail
+  AnyMap manifests(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+  for (auto name :
+       { "start_dependent", "start_indirect", "start_other", "start_fail" }) {
+    AnyMap manifest(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    manifest["bundle.symbolic_name"] = std::string(name);
+    manifests[name] = manifest;
+  }
+  ref_any_cast<AnyMap>(manifests["start_fail"])["bundle.activator"] = true;
+  ref_any_cast<AnyMap>(
+    manifests["start_dependent"])[Constants::BUNDLE_STARTDEPENDENCIES] =
+    std::string("start_fail");
+  ref_any_cast<AnyMap>(
+    manifests["start_indirect"])[Constants::BUNDLE_STARTDEPENDENCIES] =
+    std::string("start_dependent");
+  auto installed =
+    bc.InstallBundles(GetTestBundleLocations().front(), manifests);
+  ASSERT_EQ(4u, installed.size());
+  std::vector<Bundle> bundles;
+  for (auto name :
+       { "start_dependent", "start_indirect", "start_other", "start_fail" }) {
+    for (auto const& b : installed) {
+      if (b.GetSymbolicName() == name) {
+        bundles.push_back(b);
+      }
+    }
+  }
+
+  // Dependents of a bundle which failed to start are not started, the
+  // other bundles are
+  auto results = bc.StartBundles(bundles);
+  ASSERT_EQ(4u, results.size());
+  for (std::size_t i : { 0, 1, 3 }) {
+    EXPECT_TRUE(results[i].exception);
+    EXPECT_NE(Bundle::STATE_ACTIVE, bundles[i].GetState());
+  }
+  EXPECT_FALSE(results[2].exception);
+  EXPECT_EQ(Bundle::STATE_ACTIVE, bundles[2].GetState());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testStartBundlesInvalid)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  auto bundles = InstallWithStartDependencies(
+    bc,
+    { { "cycle_a", std::string("cycle_b") },
+      { "cycle_b", std::string("cycle_c") },
+      { "cycle_c", std::string("cycle_a") },
+      { "invalid_header", Any(42) } });
+  ASSERT_EQ(4u, bundles.size());
+  EXPECT_THROW(bc.StartBundles({ bundles[0], bundles[1], bundles[2] }),
+               std::invalid_argument);
+  EXPECT_THROW(bc.StartBundles({ bundles[3] }), std::invalid_argument);
+  EXPECT_THROW(bc.StartBundles({ Bundle() }), std::invalid_argument);
+
+  for (auto const& b : bc.GetBundles()) {
+    if (b.GetBundleId() != 0) {
+      EXPECT_NE(Bundle::STATE_ACTIVE, b.GetState());
+    }
+  }
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+#  ifdef US_ENABLE_THREADING_SUPPORT
+TEST(BundleRegistryConcurrencyTest, testConcurrentInstallBundles)
+{
+  auto locations = GetTestBundleLocations();
+
+  // Some libraries contain more than one bundle
+  std::map<std::string, std::size_t> bundlesPerLocation;
+  std::size_t bundleCount = 0;
+  {
+    auto serialFramework = FrameworkFactory().NewFramework();
+    serialFramework.Start();
+    for (auto const& location : locations) {
+      auto count =
+        serialFramework.GetBundleContext().InstallBundles(location).size();
+      bundlesPerLocation[location] = count;
+      bundleCount += count;
+    }
+    serialFramework.Stop();
+    serialFramework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto initialCount = framework.GetBundleContext().GetBundles().size();
+
+  // Overlapping batches and single installs of the same locations
+  const int numTestThreads = 8;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numTestThreads; ++i) {
+    threads.emplace_back([&bundlesPerLocation,
+                          bundleCount,
+                          framework,
+                          locations,
+                          i]() mutable {
+      auto bc = framework.GetBundleContext();
+      if (i % 2) {
+        std::reverse(locations.begin(), locations.end());
+        auto bundles = bc.InstallBundles(locations);
+        std::unique_lock<std::mutex> lock = io_lock();
+        EXPECT_EQ(bundles.size(), bundleCount);
+      } else {
+        for (auto& location : locations) {
+          auto bundles = bc.InstallBundles(location);
+          std::unique_lock<std::mutex> lock = io_lock();
+          EXPECT_EQ(bundles.size(), bundlesPerLocation.at(location));
+        }
+      }
+    });
+  }
+
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  ASSERT_EQ(framework.GetBundleContext().GetBundles().size(),
+            initialCount + bundleCount);
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+#  endif
 } // end anonymous namespace
 
 #endif
@@ -0,0 +1,141 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "cppmicroservices/GlobalConfig.h"
+#include "cppmicroservices/util/FileSystem.h"
+
+#include "BundleResourceContainer.h"
+
+#include "TestingConfig.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace cppmicroservices;
+
+#ifdef US_BUILD_SHARED_LIBS
+namespace {
+
+std::shared_ptr<BundleResourceContainer> OpenContainer(
+  const std::string& name)
+{
+  return std::make_shared<BundleResourceContainer>(
+    cppmicroservices::testing::LIB_PATH + util::DIR_SEP + US_LIB_PREFIX +
+      name + US_LIB_POSTFIX + US_LIB_EXT,
+    AnyMap(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
+}
+
+bool GetStat(BundleResourceContainer& container, const std::string& name)
+{
+  BundleResourceContainer::Stat stat;
+  stat.filePath = name;
+  return container.GetStat(stat);
+}
+
+}
+
+TEST(BundleResourceContainerTest, EntryIndexIsBuiltOnFirstUse)
+{
+  auto container = OpenContainer("TestBundleB");
+  std::vector<std::string> const topLevelDirs{ "TestBundleB",
+                                               "TestBundleImportedByB" };
+  ASSERT_EQ(topLevelDirs, container->GetTopLevelDirs());
+  ASSERT_FALSE(container->HasEntryIndex());
+
+  ASSERT_TRUE(GetStat(*container, "TestBundleB/manifest.json"));
+  ASSERT_FALSE(container->HasEntryIndex());
+
+  auto entries = container->GetEntryIndex();
+  ASSERT_TRUE(container->HasEntryIndex());
+  ASSERT_EQ(8u, entries.size());
+  ASSERT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+  ASSERT_EQ("TestBundleB/", entries.front().first);
+}
+
+TEST(BundleResourceContainerTest, LookupsSwitchToTheEntryIndex)
+{
+  auto container = OpenContainer("TestBundleR");
+
+  // The first 16 lookups scan the central directory
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(GetStat(*container, "TestBundleR/test.xml"));
+    ASSERT_TRUE(GetStat(*container, "TestBundleR/TEST.XML"));
+  }
+  ASSERT_FALSE(container->HasEntryIndex());
+
+  // The next one builds the entry index
+  ASSERT_FALSE(GetStat(*container, "TestBundleR/missing.xml"));
+  ASSERT_TRUE(container->HasEntryIndex());
+
+  // Hits and misses are answered from the index, ignoring case
+  ASSERT_TRUE(GetStat(*container, "TestBundleR/icons/readme.txt"));
+  ASSERT_FALSE(GetStat(*container, "TestBundleR/missing.xml"));
+  ASSERT_TRUE(GetStat(*container, "TestBundleR/TEST.XML"));
+  ASSERT_TRUE(GetStat(*container, "testbundler/Icons/README.txt"));
+  ASSERT_FALSE(GetStat(*container, "TestBundleR/TEST.XM"));
+}
+
+TEST(BundleResourceContainerTest, HasEntry)
+{
+  auto container = OpenContainer("TestBundleR");
+  ASSERT_TRUE(container->HasEntry("TestBundleR/test.xml"));
+  ASSERT_TRUE(container->HasEntry("TestBundleR/icons/"));
+  ASSERT_FALSE(container->HasEntry("TestBundleR/Test.xml"));
+  ASSERT_FALSE(container->HasEntry("TestBundleR/missing.xml"));
+  ASSERT_FALSE(container->HasEntryIndex());
+
+  container->GetEntryIndex();
+  ASSERT_TRUE(container->HasEntry("TestBundleR/test.xml"));
+  ASSERT_FALSE(container->HasEntry("TestBundleR/Test.xml"));
+}
+
+TEST(BundleResourceContainerTest, OnlyContainsManifests)
+{
+  auto manifestOnly = OpenContainer("TestBundleA");
+  ASSERT_TRUE(manifestOnly->OnlyContainsManifests());
+  ASSERT_FALSE(manifestOnly->HasEntryIndex());
+
+  auto withResources = OpenContainer("TestBundleR");
+  ASSERT_FALSE(withResources->OnlyContainsManifests());
+  ASSERT_FALSE(withResources->HasEntryIndex());
+}
+
+#  ifdef US_PLATFORM_LINUX
+TEST(BundleResourceContainerTest, LinkedStoredDataIsAligned)
+{
+  // TestBundleRLA stores its resources without compression, aligned to
+  // 4096 bytes, and links them into the library.
+  auto container = OpenContainer("TestBundleRLA");
+  BundleResourceContainer::Stat stat;
+  stat.filePath = "TestBundleRLA/icons/compressable.bmp";
+  ASSERT_TRUE(container->GetStat(stat));
+  ASSERT_EQ(stat.compressedSize, stat.uncompressedSize);
+
+  auto data = container->GetData(stat.index);
+  ASSERT_TRUE(data);
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(data.get()) % 4096);
+}
+#  endif
+#endif
@@ -29,7 +29,11 @@ limitations under the License.
 #include "cppmicroservices/FrameworkFactory.h"
 
 #include "gtest/gtest.h"
+#include <iterator>
+#include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 using namespace cppmicroservices;
 
@@ -138,6 +142,16 @@ TEST_F(BundleResourceTest, testInvalidResource)
   ASSERT_TRUE(rs.eof());
 }
 
+TEST_F(BundleResourceTest, testResourceNameIgnoresCase)
+{
+  BundleResource xml = testBundle.GetResource("/test.xml");
+  BundleResource upperXml = testBundle.GetResource("/TEST.XML");
+  ASSERT_TRUE(upperXml.IsValid());
+  ASSERT_EQ(xml.GetSize(), upperXml.GetSize());
+  ASSERT_TRUE(testBundle.GetResource("/Icons/README.txt").IsValid());
+  ASSERT_FALSE(testBundle.GetResource("/TEST.XM").IsValid());
+}
+
 TEST_F(BundleResourceTest, testResourceTree)
 {
   BundleResource res = testBundle.GetResource("");
@@ -222,6 +236,39 @@ TEST_F(BundleResourceTest, testResourceTree)
   ASSERT_EQ(nodes.size(), 1);
 }
 
+TEST_F(BundleResourceTest, testFindResourcesPatterns)
+{
+  auto find = [this](const std::string& path,
+                     const std::string& pattern,
+                     bool recurse) {
+    std::vector<std::string> paths;
+    for (auto const& r : testBundle.FindResources(path, pattern, recurse)) {
+      paths.push_back(r.GetResourcePath());
+    }
+    return paths;
+  };
+
+  // The parts of a pattern are matched anywhere in the name, in order.
+  ASSERT_EQ(std::vector<std::string>({ "/foo.ptxt", "/foo2.ptxt" }),
+            find("", "oo*pt", false));
+  ASSERT_EQ(std::vector<std::string>({ "/icons/cppmicroservices.png" }),
+            find("/icons", "c*s*ng", false));
+  ASSERT_TRUE(find("/icons", "ng*c", false).empty());
+
+  // Directories are found after their contents.
+  ASSERT_EQ(std::vector<std::string>({ "/foo.ptxt",
+                                       "/foo2.ptxt",
+                                       "/icons/compressable.bmp",
+                                       "/icons/cppmicroservices.png",
+                                       "/icons/readme.txt",
+                                       "/icons/",
+                                       "/manifest.json",
+                                       "/special_chars.dummy.ptxt",
+                                       "/test.xml" }),
+            find("", "*", true));
+  ASSERT_EQ(std::vector<std::string>({ "/icons/" }), find("", "icons", true));
+}
+
 TEST_F(BundleResourceTest, testResourceOperators)
 {
   BundleResource invalid = testBundle.GetResource("invalid");
@@ -445,6 +492,115 @@ TEST_F(BundleResourceTest, testCompressedResource)
   ASSERT_TRUE(bmp.eof());
 }
 
+TEST_F(BundleResourceTest, testCompressedResourceSeek)
+{
+  std::ifstream bmp(
+    US_FRAMEWORK_SOURCE_DIR
+    "/test/bundles/libRWithResources/resources/icons/compressable.bmp",
+    std::ifstream::in | std::ifstream::binary);
+  ASSERT_TRUE(bmp.is_open());
+  const std::string content{ std::istreambuf_iterator<char>(bmp),
+                             std::istreambuf_iterator<char>() };
+  ASSERT_EQ(300122u, content.size());
+
+  // The resource is larger than a chunk of the inflater, so seeking
+  // moves between chunks and seeking backwards inflates it again. Only
+  // bundles linked into their library are inflated incrementally, appended
+  // resources are extracted as a whole and seek within the buffer.
+  BundleResource res = testBundle.GetResource("/icons/compressable.bmp");
+  ASSERT_LT(res.GetCompressedSize(), res.GetSize());
+  BundleResourceStream rs(res, std::ios_base::binary);
+
+  char buf[16];
+  for (std::streamoff offset : { 200000, 100, 299990, 65536, 0 }) {
+    ASSERT_TRUE(rs.seekg(offset));
+    ASSERT_EQ(offset, rs.tellg());
+    ASSERT_TRUE(rs.read(buf, 10));
+    ASSERT_EQ(content.substr(static_cast<std::size_t>(offset), 10),
+              std::string(buf, 10));
+  }
+
+  ASSERT_TRUE(rs.seekg(-5, std::ios_base::end));
+  ASSERT_EQ(std::streampos(300117), rs.tellg());
+  ASSERT_TRUE(rs.seekg(32768));
+  ASSERT_TRUE(rs.unget());
+  ASSERT_EQ(content[32767], static_cast<char>(rs.get()));
+  ASSERT_FALSE(rs.seekg(300123));
+}
+
+TEST_F(BundleResourceTest, testConcurrentResourceReads)
+{
+  auto readAll = [](const BundleResource& r) {
+    BundleResourceStream rs(r, std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(rs),
+                       std::istreambuf_iterator<char>());
+  };
+
+  BundleResource res = testBundle.GetResource("/icons/compressable.bmp");
+  const std::string content = readAll(res);
+  ASSERT_EQ(300122u, content.size());
+
+  std::vector<std::string> results(4);
+  std::vector<std::thread> threads;
+  for (auto& result : results) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 5; ++i) {
+        result = readAll(res);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto const& result : results) {
+    ASSERT_EQ(content, result);
+  }
+}
+
+TEST_F(BundleResourceTest, testStoredResource)
+{
+  // TestBundleRS contains resources of TestBundleR without compression,
+  // which are read directly from the bundle file.
+  auto storedBundle =
+    cppmicroservices::testing::InstallLib(context, "TestBundleRS");
+  BundleResource res = storedBundle.GetResource("/icons/compressable.bmp");
+  checkResourceInfo(res,
+                    "/icons/",
+                    "compressable",
+                    "compressable",
+                    "bmp",
+                    "bmp",
+                    300122,
+                    false);
+  ASSERT_EQ(res.GetCompressedSize(), res.GetSize());
+
+  auto readAll = [](const BundleResource& r, std::ios_base::openmode mode) {
+    BundleResourceStream rs(r, mode);
+    return std::string(std::istreambuf_iterator<char>(rs),
+                       std::istreambuf_iterator<char>());
+  };
+
+  BundleResource compressed =
+    testBundle.GetResource("/icons/compressable.bmp");
+  ASSERT_LT(compressed.GetCompressedSize(), compressed.GetSize());
+  std::string content = readAll(res, std::ios_base::binary);
+  ASSERT_EQ(content.size(), static_cast<std::size_t>(300122));
+  ASSERT_EQ(content, readAll(compressed, std::ios_base::binary));
+
+  // Text mode handling must be the same as for compressed resources
+  ASSERT_EQ(readAll(storedBundle.GetResource("foo.ptxt"), std::ios_base::in),
+            readAll(testBundle.GetResource("foo.ptxt"), std::ios_base::in));
+
+  // A stream keeps the data valid after the bundle was uninstalled
+  BundleResourceStream rs(res, std::ios_base::binary);
+#ifdef US_BUILD_SHARED_LIBS
+  storedBundle.Uninstall();
+#endif
+  ASSERT_EQ(std::string(std::istreambuf_iterator<char>(rs),
+                        std::istreambuf_iterator<char>()),
+            content);
+}
+
 TEST_F(BundleResourceTest, testResources)
 {
   BundleResource foo = testBundle.GetResource("foo.ptxt");
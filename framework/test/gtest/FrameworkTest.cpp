@@ -23,6 +23,8 @@ limitations under the License.
 #include <chrono>
 #include <fstream>
 #include <mutex>
+#include <set>
+#include <sstream>
 #include <thread>
 #include <type_traits>
 
@@ -859,6 +861,79 @@ TEST(FrameworkTest, LoadLibraryLogsMessagesTest)
   f.Stop();
   f.WaitForStop(std::chrono::milliseconds::zero());
 }
+
+TEST(FrameworkTest, BundlePhaseTimings)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_BUNDLE_TIMING] = true;
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+
+  auto bundle =
+    cppmicroservices::testing::InstallLib(f.GetBundleContext(), "TestBundleA");
+  bundle.Start();
+
+  // The bundles embedded in the test executable are timed too
+  std::set<Framework::BundlePhase> phases;
+  for (auto const& timing : f.GetBundlePhaseTimings()) {
+    if (timing.location != bundle.GetLocation()) {
+      continue;
+    }
+    EXPECT_GE(timing.duration.count(), 0);
+    if (timing.phase == Framework::BundlePhase::OpenResources) {
+      EXPECT_EQ(-1, timing.bundleId);
+    } else {
+      EXPECT_EQ(bundle.GetBundleId(), timing.bundleId);
+      EXPECT_EQ(bundle.GetSymbolicName(), timing.symbolicName);
+    }
+    phases.insert(timing.phase);
+  }
+  std::set<Framework::BundlePhase> expected{
+    Framework::BundlePhase::OpenResources,
+    Framework::BundlePhase::Install,
+    Framework::BundlePhase::ParseManifest,
+    Framework::BundlePhase::Resolve,
+    Framework::BundlePhase::StartedListeners
+  };
+  auto activator = bundle.GetHeaders().find(Constants::BUNDLE_ACTIVATOR);
+  if (activator != bundle.GetHeaders().end() &&
+      any_cast<bool>(activator->second)) {
+    expected.insert(Framework::BundlePhase::LoadLibrary);
+    expected.insert(Framework::BundlePhase::ActivatorStart);
+  }
+  EXPECT_EQ(expected, phases);
+
+  std::ostringstream trace;
+  f.WriteBundlePhaseTimings(trace);
+  EXPECT_EQ(0u, trace.str().find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.str().find("\"name\":\"Install\""));
+  EXPECT_NE(std::string::npos,
+            trace.str().find("\"bundle.symbolic_name\":\"" +
+                             bundle.GetSymbolicName() + "\""));
+
+  // The timings are kept after the framework stopped
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+  EXPECT_FALSE(f.GetBundlePhaseTimings().empty());
+}
+
+TEST(FrameworkTest, BundlePhaseTimingsDisabled)
+{
+  auto f = FrameworkFactory().NewFramework();
+  f.Start();
+
+  cppmicroservices::testing::InstallLib(f.GetBundleContext(), "TestBundleA")
+    .Start();
+  EXPECT_TRUE(f.GetBundlePhaseTimings().empty());
+
+  std::ostringstream trace;
+  f.WriteBundlePhaseTimings(trace);
+  EXPECT_EQ("{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n",
+            trace.str());
+
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
 #endif
 
 US_MSVC_POP_WARNING
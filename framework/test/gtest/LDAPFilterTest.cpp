@@ -173,3 +173,48 @@ TEST(LDAPFilter, TestEvaluate)
   props["prop"] = std::string("foo(bar)");
   ASSERT_TRUE(ldap.Match(props));
 }
+
+TEST(LDAPFilter, TestParseCache)
+{
+  const std::string filterStr = "(&(cache.test=parsed once)(cache.rank>=3))";
+  auto before = LDAPFilter::GetCacheStatistics();
+
+  LDAPFilter first(filterStr);
+  auto afterFirst = LDAPFilter::GetCacheStatistics();
+  ASSERT_EQ(afterFirst.misses, before.misses + 1);
+
+  LDAPFilter second(filterStr);
+  auto afterSecond = LDAPFilter::GetCacheStatistics();
+  ASSERT_EQ(afterSecond.misses, afterFirst.misses);
+  ASSERT_EQ(afterSecond.hits, afterFirst.hits + 1);
+  ASSERT_LE(afterSecond.size, afterSecond.capacity);
+
+  // filters sharing a cached expression evaluate independently
+  AnyMap props(AnyMap::UNORDERED_MAP);
+  props["cache.test"] = std::string("parsed once");
+  props["cache.rank"] = 5;
+  ASSERT_TRUE(first.Match(props));
+  ASSERT_TRUE(second.Match(props));
+  ASSERT_EQ(first, second);
+
+  // malformed filters are not cached
+  EXPECT_THROW(LDAPFilter ldap("cache.test=malformed)"), std::invalid_argument);
+  EXPECT_THROW(LDAPFilter ldap("cache.test=malformed)"), std::invalid_argument);
+  ASSERT_EQ(LDAPFilter::GetCacheStatistics().misses, afterSecond.misses + 2);
+}
+
+TEST(LDAPFilter, TestEvaluateNested)
+{
+  AnyMap props(AnyMap::UNORDERED_MAP);
+  props["a"] = 1;
+  props["b"] = std::string("two");
+  props["c"] = true;
+
+  // short-circuiting AND/OR nested at different depths
+  ASSERT_TRUE(LDAPFilter("(&(a=1)(|(b=one)(b=t*))(!(c=false)))").Match(props));
+  ASSERT_FALSE(LDAPFilter("(&(a=1)(|(b=one)(b=three))(c=true))").Match(props));
+  ASSERT_TRUE(LDAPFilter("(|(&(a=2)(b=two))(&(a>=1)(!(b=x))))").Match(props));
+  ASSERT_FALSE(LDAPFilter("(!(|(a<=0)(&(b=two)(c=true))))").Match(props));
+  ASSERT_TRUE(LDAPFilter("(|(missing=*)(!(missing=*)))").Match(props));
+  ASSERT_FALSE(LDAPFilter("(&(a=1)(b=two)(c=true)(missing=*))").Match(props));
+}
@@ -0,0 +1,121 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "cppmicroservices/GlobalConfig.h"
+
+#include "PropertyKeyTable.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cppmicroservices;
+
+TEST(PropertyKeyTableTest, InternReturnsTheSameKey)
+{
+  PropertyKeyTable table;
+  auto key = table.Intern("service.Ranking");
+  ASSERT_EQ("service.Ranking", key->name);
+  ASSERT_EQ(key, table.Intern(std::string("service.Ranking")));
+
+  // The lower case variant is interned, too
+  auto lower = table.Intern("service.ranking");
+  ASSERT_NE(key, lower);
+  ASSERT_EQ(lower.get(), key->folded);
+  ASSERT_EQ(lower.get(), lower->folded);
+  ASSERT_EQ(key->folded, table.Intern("SERVICE.RANKING")->folded);
+  ASSERT_EQ(3u, table.Size());
+}
+
+TEST(PropertyKeyTableTest, FoldsAsciiLettersOnly)
+{
+  PropertyKeyTable table;
+  // '@' and '[' border the upper case letters
+  auto key = table.Intern("@[");
+  ASSERT_EQ(key.get(), key->folded);
+  ASSERT_NE(key->folded, table.Intern("`{")->folded);
+
+  auto nonAscii = table.Intern("\xc3\x84Z");
+  ASSERT_EQ("\xc3\x84z", nonAscii->folded->name);
+  ASSERT_NE(nonAscii->folded, table.Intern("\xc3\xa4z")->folded);
+}
+
+TEST(PropertyKeyTableTest, ReleasedKeysAreRemoved)
+{
+  PropertyKeyTable table;
+  auto kept = table.Intern("Kept");
+  {
+    std::vector<std::shared_ptr<const InternedKey>> keys;
+    for (int i = 0; i < 100; ++i) {
+      keys.push_back(table.Intern("Key" + std::to_string(i)));
+    }
+    ASSERT_EQ(202u, table.Size());
+  }
+
+  // Interning removes the released keys and their lower case variants
+  table.Intern("key0");
+  table.Intern("key0");
+  ASSERT_EQ(3u, table.Size());
+  ASSERT_EQ("Kept", kept->name);
+  ASSERT_EQ(kept, table.Intern("Kept"));
+  ASSERT_EQ("kept", kept->folded->name);
+}
+
+TEST(PropertyKeyTableTest, ReleasedKeyIsReused)
+{
+  PropertyKeyTable table;
+  std::vector<std::shared_ptr<const InternedKey>> keys;
+  for (int i = 0; i < 10; ++i) {
+    keys.push_back(table.Intern("key" + std::to_string(i)));
+  }
+
+  // A single released key is not removed right away
+  const InternedKey* address = table.Intern("reused").get();
+  auto key = table.Intern("reused");
+  ASSERT_EQ(address, key.get());
+  ASSERT_EQ("reused", key->name);
+  ASSERT_EQ(11u, table.Size());
+}
+
+#ifdef US_ENABLE_THREADING_SUPPORT
+TEST(PropertyKeyTableTest, ConcurrentInternAndRelease)
+{
+  PropertyKeyTable table;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&table]() {
+      for (int i = 0; i < 2000; ++i) {
+        auto name = "Key" + std::to_string(i % 50);
+        auto key = table.Intern(name);
+        EXPECT_EQ(name, key->name);
+        EXPECT_EQ(table.Intern(name), key);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_LE(table.Size(), 100u);
+}
+#endif
@@ -29,6 +29,7 @@
 #include "gtest/gtest.h"
 #include "json/json.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <fstream>
@@ -313,6 +314,24 @@ std::string getManifestContent(const std::string& zipfile,
   return std::string();
 }
 
+// return the offset of the data of a zip archive entry in the given file
+mz_uint64 getEntryDataOffset(const std::string& file, const EntryInfo& entry)
+{
+  // Offsets and sizes of the zip local file header, see the zip file
+  // format specification (APPNOTE.TXT, section 4.3.7).
+  const mz_uint64 localHeaderSize = 30;
+  const std::streamoff fileNameLengthOffset = 26;
+
+  std::ifstream in(file, std::ios::binary);
+  in.seekg(static_cast<std::streamoff>(entry.localHeaderOffset) +
+           fileNameLengthOffset);
+  unsigned char lengths[4] = {};
+  in.read(reinterpret_cast<char*>(lengths), sizeof lengths);
+  EXPECT_TRUE(in.good()) << "Could not read local header of " << entry.name;
+  return entry.localHeaderOffset + localHeaderSize +
+         (lengths[0] | lengths[1] << 8) + (lengths[2] | lengths[3] << 8);
+}
+
 /*
 * @brief remove any line feed and new line characters.
 * @param[in,out] str string to be modified
@@ -620,6 +639,78 @@ TEST_F(ResourceCompilerTest, testCompressionLevel)
   testExists(entryNames, "mybundle/resource2/");
 }
 
+/*
+ * Use resource compiler to store files which do not compress well, with
+ * their data aligned to 4096 bytes.
+ *
+ * Working directory is changed temporarily to tempdir because of --res-add option
+ */
+TEST_F(ResourceCompilerTest, testStoreIncompressible)
+{
+  std::ofstream compressible(tempdir + "compressible.txt");
+  for (int i = 0; i < 1000; ++i) {
+    compressible << "A sample resource which compresses well\n";
+  }
+  compressible.close();
+
+  // Neither file compresses, but only the first one is detected by its name.
+  std::string noise(10000, '\0');
+  unsigned int seed = 1;
+  for (auto& c : noise) {
+    seed = seed * 1103515245 + 12345;
+    c = static_cast<char>(seed >> 16);
+  }
+  std::ofstream(tempdir + "incompressible.png", std::ios::binary) << noise;
+  std::reverse(noise.begin(), noise.end());
+  std::ofstream(tempdir + "incompressible.bin", std::ios::binary) << noise;
+
+  std::ostringstream cmd;
+  cmd << rcbinpath;
+  cmd << " --bundle-name mybundle ";
+  cmd << " --manifest-add manifest.json ";
+  cmd << " --out-file ExampleStoreIncompressible.zip ";
+  cmd << " --res-add compressible.txt ";
+  cmd << " --res-add incompressible.png ";
+  cmd << " --res-add incompressible.bin ";
+  cmd << " --store-incompressible";
+  cmd << " --alignment 4096";
+  cmd << " --report";
+
+  auto cwdir = util::GetCurrentWorkingDirectory();
+  ChangeDirectory(tempdir);
+  ASSERT_EQ(EXIT_SUCCESS, runExecutable(cmd.str()));
+  ChangeDirectory(cwdir);
+
+  const std::string zipPath(tempdir + "ExampleStoreIncompressible.zip");
+  ZipFile zip(zipPath);
+  ASSERT_EQ(zip.size(), 5);
+
+  for (ZipFile::size_type i = 0; i < zip.size(); ++i) {
+    const EntryInfo& entry = zip[i];
+    if (entry.name == "mybundle/compressible.txt") {
+      ASSERT_EQ(entry.method, MZ_DEFLATED);
+      ASSERT_LT(entry.compressedSize, entry.uncompressedSize);
+    } else if (entry.type == EntryInfo::EntryType::FILE) {
+      // The manifest is too small to be worth compressing.
+      ASSERT_EQ(entry.method, 0) << entry.name;
+      ASSERT_EQ(entry.compressedSize, entry.uncompressedSize);
+      if (entry.uncompressedSize >= 4096) {
+        ASSERT_EQ(getEntryDataOffset(zipPath, entry) % 4096, 0)
+          << entry.name;
+      }
+    }
+  }
+
+  cmd.str(std::string());
+  cmd << rcbinpath;
+  cmd << " --bundle-name mybundle ";
+  cmd << " --manifest-add " << tempdir << "manifest.json";
+  cmd << " --out-file " << tempdir << "ExampleInvalidAlignment.zip";
+  cmd << " --alignment 3000";
+  //Test Failure mode: --alignment is not a power of two
+  ASSERT_EQ(EXIT_FAILURE, runExecutable(cmd.str()));
+}
+
 /*
  * Add the same manifest contents multiples times through --manifest-add
  * The intended behavior is that any subsequent duplicate manifest file is ignored
@@ -36,6 +36,12 @@
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
 US_MSVC_PUSH_DISABLE_WARNING(4996)
 
 using namespace cppmicroservices;
@@ -377,4 +383,182 @@ TEST_F(ServiceListenerTest, frameSL25a)
   sListen.clearEvents();
 }
 
+namespace {
+struct ServiceA
+{
+  virtual ~ServiceA() = default;
+};
+struct ServiceB
+{
+  virtual ~ServiceB() = default;
+};
+struct ServiceAB
+  : ServiceA
+  , ServiceB
+{};
+}
+
+// Listeners are cached by the object classes, service id and service pid
+// in their filters. Make sure the cached listeners receive exactly the
+// events a full filter evaluation would deliver.
+TEST_F(ServiceListenerTest, CachedListenerFilters)
+{
+  auto context = framework.GetBundleContext();
+
+  const std::string classA =
+    "(objectclass=" + us_service_interface_iid<ServiceA>() + ")";
+  const std::string classB =
+    "(objectclass=" + us_service_interface_iid<ServiceB>() + ")";
+  const std::vector<std::string> filters = {
+    classA,
+    "(|" + classA + classB + ")",
+    "(service.pid=pid.a)",
+    "(&" + classB + "(rank>=2))",
+    "(&(rank=*)(&(service.pid=pid.a)(rank<=1)))",
+    "(rank=1)",
+    ""
+  };
+  std::vector<int> counts(filters.size(), 0);
+  std::vector<ListenerToken> tokens;
+  for (std::size_t i = 0; i < filters.size(); ++i) {
+    tokens.push_back(context.AddServiceListener(
+      [&counts, i](const ServiceEvent&) { ++counts[i]; }, filters[i]));
+  }
+
+  ServiceProperties propsA;
+  propsA[Constants::SERVICE_PID] = std::string("pid.a");
+  propsA["rank"] = 1;
+  ServiceProperties propsB;
+  propsB["rank"] = 2;
+
+  auto regA =
+    context.RegisterService<ServiceA>(std::make_shared<ServiceAB>(), propsA);
+  auto regB =
+    context.RegisterService<ServiceB>(std::make_shared<ServiceAB>(), propsB);
+  auto regAB = context.RegisterService<ServiceA, ServiceB>(
+    std::make_shared<ServiceAB>());
+
+  EXPECT_EQ(counts, std::vector<int>({ 2, 3, 1, 1, 1, 1, 3 }));
+
+  regA.Unregister();
+  regB.Unregister();
+  regAB.Unregister();
+
+  EXPECT_EQ(counts, std::vector<int>({ 4, 6, 2, 2, 2, 2, 6 }));
+
+  for (auto& token : tokens) {
+    context.RemoveListener(std::move(token));
+  }
+  context.RegisterService<ServiceA>(std::make_shared<ServiceAB>(), propsA);
+  EXPECT_EQ(counts, std::vector<int>({ 4, 6, 2, 2, 2, 2, 6 }));
+}
+
+namespace {
+Framework NewAsyncFramework(int queueDepth, const std::string& policy)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY] =
+    Constants::FRAMEWORK_SERVICE_EVENT_DELIVERY_ASYNC;
+  config[Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_DEPTH] = queueDepth;
+  config[Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_POLICY] = policy;
+  return FrameworkFactory().NewFramework(config);
+}
+
+void WaitForPendingServiceEvents(const Framework& framework)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (framework.GetServiceEventDeliveryStatistics().pending > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+}
+
+TEST(ServiceListenerAsyncTest, OrderedAsyncDelivery)
+{
+  auto framework =
+    NewAsyncFramework(4, Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_BLOCK);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  std::mutex eventsMutex;
+  std::map<long, std::vector<ServiceEvent::Type>> events;
+  bool calledOnRegisteringThread = false;
+  const auto registeringThread = std::this_thread::get_id();
+  context.AddServiceListener(
+    [&](const ServiceEvent& evt) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      std::lock_guard<std::mutex> l(eventsMutex);
+      calledOnRegisteringThread |=
+        std::this_thread::get_id() == registeringThread;
+      events[any_cast<long>(
+               evt.GetServiceReference().GetProperty(Constants::SERVICE_ID))]
+        .push_back(evt.GetType());
+    },
+    "(objectclass=" + us_service_interface_iid<ServiceA>() + ")");
+
+  const int serviceCount = 20;
+  for (int i = 0; i < serviceCount; ++i) {
+    auto reg = context.RegisterService<ServiceA>(std::make_shared<ServiceAB>());
+    reg.SetProperties(ServiceProperties{ { "modified", true } });
+    reg.Unregister();
+  }
+  WaitForPendingServiceEvents(framework);
+
+  auto stats = framework.GetServiceEventDeliveryStatistics();
+  EXPECT_EQ(stats.queued, 3u * serviceCount);
+  EXPECT_EQ(stats.delivered, stats.queued);
+  EXPECT_EQ(stats.discarded, 0u);
+  EXPECT_LE(stats.maxQueueDepth, 4u);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+
+  EXPECT_FALSE(calledOnRegisteringThread);
+  ASSERT_EQ(events.size(), static_cast<std::size_t>(serviceCount));
+  const std::vector<ServiceEvent::Type> expected{
+    ServiceEvent::SERVICE_REGISTERED,
+    ServiceEvent::SERVICE_MODIFIED,
+    ServiceEvent::SERVICE_UNREGISTERING
+  };
+  for (auto& serviceEvents : events) {
+    EXPECT_EQ(serviceEvents.second, expected);
+  }
+}
+
+TEST(ServiceListenerAsyncTest, DiscardWhenQueueIsFull)
+{
+  auto framework =
+    NewAsyncFramework(1, Constants::FRAMEWORK_SERVICE_EVENT_QUEUE_DISCARD);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  std::promise<void> release;
+  std::shared_future<void> released(release.get_future());
+  std::atomic<int> received(0);
+  context.AddServiceListener(
+    [&](const ServiceEvent&) {
+      released.wait();
+      ++received;
+    },
+    "(objectclass=" + us_service_interface_iid<ServiceA>() + ")");
+
+  std::vector<ServiceRegistration<ServiceA>> regs;
+  for (int i = 0; i < 10; ++i) {
+    regs.push_back(
+      context.RegisterService<ServiceA>(std::make_shared<ServiceAB>()));
+  }
+  // the registering thread must not block on the full queue
+  release.set_value();
+  WaitForPendingServiceEvents(framework);
+
+  auto stats = framework.GetServiceEventDeliveryStatistics();
+  EXPECT_GT(stats.discarded, 0u);
+  EXPECT_EQ(stats.delivered + stats.discarded, 10u);
+  EXPECT_EQ(static_cast<uint64_t>(received), stats.delivered);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
 US_MSVC_POP_WARNING
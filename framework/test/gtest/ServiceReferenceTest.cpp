@@ -238,3 +238,30 @@ TEST_F(ServiceReferenceTest, TestGetServiceReferenceWithModifiedProperties)
   ASSERT_EQ(context.GetServiceReference<ServiceNS::ITestServiceA>(),
             regArr[1].GetReference());
 }
+
+TEST_F(ServiceReferenceTest, TestGetServiceWithMultipleInterfaces)
+{
+  auto context = framework.GetBundleContext();
+  auto implA = std::make_shared<TestServiceA>();
+  auto implB = std::make_shared<TestServiceB>();
+  auto im = std::make_shared<InterfaceMap>();
+  (*im)["ServiceNS::ITestServiceB"] = implB;
+  (*im)["ServiceNS::ITestServiceA"] = implA;
+  auto reg = context.RegisterService(im);
+
+  // each typed reference must resolve to the object registered for
+  // its own interface
+  auto srA = context.GetServiceReference<ServiceNS::ITestServiceA>();
+  auto srB = context.GetServiceReference<ServiceNS::ITestServiceB>();
+  ASSERT_EQ(context.GetService(srA), implA);
+  ASSERT_EQ(context.GetService(srB), implB);
+
+  // an untyped reference converted to a typed one looks up the
+  // requested interface as well
+  ServiceReference<ServiceNS::ITestServiceB> srU =
+    context.GetServiceReference("ServiceNS::ITestServiceA");
+  ASSERT_EQ(context.GetService(srU), implB);
+
+  reg.Unregister();
+  ASSERT_FALSE(srA);
+}
@@ -24,6 +24,7 @@
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/FrameworkFactory.h"
+#include "cppmicroservices/ServiceEvent.h"
 
 #include "TestUtils.h"
 #include "gtest/gtest.h"
@@ -219,3 +220,138 @@ TEST_F(ServiceRegistryTest, TestServicePropertiesUpdate)
   reg2.Unregister();
   ASSERT_TRUE(context.GetServiceReferences<ITestServiceA>().empty());
 }
+
+TEST_F(ServiceRegistryTest, TestServiceRankingType)
+{
+  auto s1 = std::make_shared<TestServiceA>();
+  ServiceProperties props;
+  props[Constants::SERVICE_RANKING] = std::string("100");
+
+  // rankings which are not an int are rejected, like in SetProperties
+  ASSERT_THROW(context.RegisterService<ITestServiceA>(s1, props),
+               std::invalid_argument);
+  std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+  services.emplace_back(MakeInterfaceMap<ITestServiceA>(s1), props);
+  ASSERT_THROW(context.RegisterServices(services), std::invalid_argument);
+  ASSERT_TRUE(context.GetServiceReferences<ITestServiceA>().empty());
+
+  props[Constants::SERVICE_RANKING] = 10L;
+  ASSERT_THROW(context.RegisterService<ITestServiceA>(s1, props),
+               std::invalid_argument);
+
+  auto reg = context.RegisterService<ITestServiceA>(s1);
+  ASSERT_THROW(reg.SetProperties(props), std::invalid_argument);
+  reg.Unregister();
+}
+
+TEST_F(ServiceRegistryTest, TestBatchServiceRegistration)
+{
+  auto s0 = std::make_shared<TestServiceA>();
+  auto s1 = std::make_shared<TestServiceA>();
+  auto s2 = std::make_shared<TestServiceA>();
+  ServiceRegistration<ITestServiceA> single =
+    context.RegisterService<ITestServiceA>(s0,
+                                           { { Constants::SERVICE_RANKING,
+                                               Any(5) } });
+
+  std::vector<long> registered;
+  std::vector<long> unregistering;
+  auto token = context.AddServiceListener([&](const ServiceEvent& evt) {
+    auto id =
+      any_cast<long>(evt.GetServiceReference().GetProperty(Constants::SERVICE_ID));
+    if (evt.GetType() == ServiceEvent::SERVICE_REGISTERED) {
+      registered.push_back(id);
+    } else if (evt.GetType() == ServiceEvent::SERVICE_UNREGISTERING) {
+      unregistering.push_back(id);
+    }
+  });
+
+  std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+  services.emplace_back(MakeInterfaceMap<ITestServiceA>(s1),
+                        ServiceProperties{ { Constants::SERVICE_RANKING,
+                                             Any(1) } });
+  services.emplace_back(MakeInterfaceMap<ITestServiceA>(s2),
+                        ServiceProperties{ { Constants::SERVICE_RANKING,
+                                             Any(10) } });
+  auto regs = context.RegisterServices(services);
+  ASSERT_EQ(regs.size(), 2);
+
+  // events are delivered in the order of the batch
+  std::vector<long> ids;
+  for (auto& reg : regs) {
+    ids.push_back(any_cast<long>(
+      reg.GetReference().GetProperty(Constants::SERVICE_ID)));
+  }
+  ASSERT_EQ(registered, ids);
+
+  // the new services are merged into the existing ranking order
+  auto refs = context.GetServiceReferences<ITestServiceA>();
+  ASSERT_EQ(refs.size(), 3);
+  ASSERT_EQ(context.GetService(refs[0]), s2);
+  ASSERT_EQ(context.GetService(refs[1]), s0);
+  ASSERT_EQ(context.GetService(refs[2]), s1);
+
+  // an invalid service fails the whole batch
+  services.emplace_back(std::make_shared<InterfaceMap>(), ServiceProperties());
+  EXPECT_THROW(context.RegisterServices(services), std::invalid_argument);
+  ASSERT_EQ(context.GetServiceReferences<ITestServiceA>().size(), 3);
+
+  std::vector<ServiceRegistrationBase> toUnregister{ regs[1], regs[0] };
+  context.UnregisterServices(toUnregister);
+  ASSERT_EQ(unregistering, std::vector<long>({ ids[1], ids[0] }));
+  refs = context.GetServiceReferences<ITestServiceA>();
+  ASSERT_EQ(refs.size(), 1);
+  ASSERT_EQ(context.GetService(refs[0]), s0);
+
+  // unregistering a service twice fails and leaves the others registered
+  toUnregister.push_back(single);
+  EXPECT_THROW(context.UnregisterServices(toUnregister), std::logic_error);
+  ASSERT_EQ(context.GetServiceReferences<ITestServiceA>().size(), 1);
+
+  context.RemoveListener(std::move(token));
+  single.Unregister();
+}
+
+TEST_F(ServiceRegistryTest, TestRegisteredAndUsedServicesByBundle)
+{
+  auto bundle = context.GetBundle();
+  auto regA = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>());
+  auto regB = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(),
+    { { Constants::SERVICE_RANKING, Any(10) } });
+
+  // registered services are returned in registration order
+  auto registered = bundle.GetRegisteredServices();
+  ASSERT_EQ(registered.size(), 2);
+  ASSERT_EQ(registered[0], regA.GetReference());
+  ASSERT_EQ(registered[1], regB.GetReference());
+  ASSERT_TRUE(bundle.GetServicesInUse().empty());
+
+  auto refA = regA.GetReference();
+  auto refB = regB.GetReference();
+  auto serviceB = context.GetService(refB);
+  auto serviceA = context.GetService(refA);
+  auto inUse = bundle.GetServicesInUse();
+  ASSERT_EQ(inUse.size(), 2);
+  ASSERT_EQ(inUse[0], refA);
+  ASSERT_EQ(inUse[1], refB);
+
+  // the service stays in use until the last service object is released
+  auto serviceA2 = context.GetService(refA);
+  serviceA.reset();
+  ASSERT_EQ(bundle.GetServicesInUse().size(), 2);
+  serviceA2.reset();
+  inUse = bundle.GetServicesInUse();
+  ASSERT_EQ(inUse.size(), 1);
+  ASSERT_EQ(inUse[0], refB);
+
+  regB.Unregister();
+  ASSERT_TRUE(bundle.GetServicesInUse().empty());
+  registered = bundle.GetRegisteredServices();
+  ASSERT_EQ(registered.size(), 1);
+  ASSERT_EQ(registered[0], refA);
+
+  regA.Unregister();
+  ASSERT_TRUE(bundle.GetRegisteredServices().empty());
+}
@@ -41,6 +41,8 @@ struct EntryInfo
   mz_uint64 compressedSize;
   mz_uint64 uncompressedSize;
   mz_uint32 crc32;
+  mz_uint16 method;
+  mz_uint64 localHeaderOffset;
 };
 
 /*
@@ -79,6 +81,9 @@ public:
       entry.compressedSize = filestat.m_comp_size;
       entry.uncompressedSize = filestat.m_uncomp_size;
       entry.crc32 = filestat.m_crc32;
+      entry.method = filestat.m_method;
+      entry.localHeaderOffset =
+        ziparchive.m_archive_file_ofs + filestat.m_local_header_ofs;
       entries.push_back(entry);
     }
 
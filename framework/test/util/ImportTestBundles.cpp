@@ -17,6 +17,7 @@ CPPMICROSERVICES_IMPORT_BUNDLE(TestBundleM)
 CPPMICROSERVICES_INITIALIZE_STATIC_BUNDLE(TestBundleR)
 CPPMICROSERVICES_INITIALIZE_STATIC_BUNDLE(TestBundleRA)
 CPPMICROSERVICES_INITIALIZE_STATIC_BUNDLE(TestBundleRL)
+CPPMICROSERVICES_INITIALIZE_STATIC_BUNDLE(TestBundleRS)
 CPPMICROSERVICES_IMPORT_BUNDLE(TestBundleS)
 CPPMICROSERVICES_IMPORT_BUNDLE(TestBundleSL1)
 CPPMICROSERVICES_IMPORT_BUNDLE(TestBundleSL3)
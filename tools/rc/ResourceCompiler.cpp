@@ -22,11 +22,15 @@
 
 #include "miniz.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <stdexcept>
@@ -50,6 +54,8 @@
 #  define WIN32_LEAN_AND_MEAN
 #  define VC_EXTRALEAN
 #  include <windows.h>
+#  include <nowide/convert.hpp>
+#  include <sys/stat.h>
 #  define PATH_SEPARATOR "\\"
 static std::string get_error_str()
 {
@@ -90,8 +96,20 @@ std::string us_tempfile()
   return std::string(szTempFileName);
 }
 
+static bool get_file_modified_time(const std::string& fileName,
+                                   MZ_TIME_T& modifiedTime)
+{
+  struct _stat64 fileStat;
+  if (_wstat64(nowide::widen(fileName).c_str(), &fileStat) != 0) {
+    return false;
+  }
+  modifiedTime = static_cast<MZ_TIME_T>(fileStat.st_mtime);
+  return true;
+}
+
 #else
 
+#  include <sys/stat.h>
 #  include <unistd.h>
 #  define PATH_SEPARATOR "/"
 static std::string get_error_str()
@@ -109,6 +127,17 @@ std::string us_tempfile()
   return std::string(temppath);
 }
 
+static bool get_file_modified_time(const std::string& fileName,
+                                   MZ_TIME_T& modifiedTime)
+{
+  struct stat fileStat;
+  if (stat(fileName.c_str(), &fileStat) != 0) {
+    return false;
+  }
+  modifiedTime = fileStat.st_mtime;
+  return true;
+}
+
 #endif
 
 // ---------------------------------------------------------------------------------
@@ -292,6 +321,94 @@ Json::Value AggregateManifestsAndValidate(
             << manifestJson.toStyledString() << std::endl;
   return manifestJson;
 }
+
+/*
+ * @brief checks whether a file name has the extension of a file format
+ * which is compressed already, so that deflating it again rarely pays off.
+ * @param fileName the file name or archive entry to check.
+ */
+bool hasCompressedFileExtension(const std::string& fileName)
+{
+  static const std::set<std::string> compressedExtensions = {
+    "7z",  "br",  "bz2", "gif", "gz",   "jar", "jpeg", "jpg",  "lz4", "mp3",
+    "mp4", "ogg", "png", "xz",  "webm", "webp", "woff", "woff2", "zip", "zst"
+  };
+
+  std::string::size_type dotPos = fileName.find_last_of('.');
+  std::string::size_type separatorPos = fileName.find_last_of("/\\");
+  if (dotPos == std::string::npos ||
+      (separatorPos != std::string::npos && dotPos < separatorPos)) {
+    return false;
+  }
+  std::string extension(fileName.substr(dotPos + 1));
+  std::transform(extension.begin(),
+                 extension.end(),
+                 extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return compressedExtensions.count(extension) > 0;
+}
+
+/*
+ * @brief prints the size, the compressed size, the compression ratio and
+ * the compression method of each file in a zip archive.
+ * @param archiveFile archive file path
+ * @param out the stream to print the report to
+ * @throw runtime_error if the archive could not be read.
+ */
+void printArchiveReport(const std::string& archiveFile, std::ostream& out)
+{
+  mz_zip_archive zipArchive;
+  memset(&zipArchive, 0, sizeof(mz_zip_archive));
+  if (!mz_zip_reader_init_file(&zipArchive, archiveFile.c_str(), 0)) {
+    throw std::runtime_error("Could not initialize zip archive " + archiveFile);
+  }
+
+  auto printRow = [&out](mz_uint64 size,
+                         mz_uint64 compressedSize,
+                         const std::string& method,
+                         const std::string& name) {
+    out << std::setw(12) << size << std::setw(12) << compressedSize;
+    if (size > 0) {
+      out << std::setw(7) << std::fixed << std::setprecision(1)
+          << 100.0 * static_cast<double>(compressedSize) /
+               static_cast<double>(size)
+          << "%";
+    } else {
+      out << std::setw(8) << "-";
+    }
+    out << "  " << std::left << std::setw(9) << method << std::right << name
+        << std::endl;
+  };
+
+  out << std::setw(12) << "Size" << std::setw(12) << "Compressed"
+      << std::setw(8) << "Ratio"
+      << "  " << std::left << std::setw(9) << "Method" << std::right << "Name"
+      << std::endl;
+
+  mz_uint64 totalSize = 0;
+  mz_uint64 totalCompressedSize = 0;
+  mz_uint numFiles = 0;
+  mz_uint numZipIndices = mz_zip_reader_get_num_files(&zipArchive);
+  for (mz_uint index = 0; index < numZipIndices; ++index) {
+    mz_zip_archive_file_stat fileStat;
+    if (!mz_zip_reader_file_stat(&zipArchive, index, &fileStat) ||
+        fileStat.m_is_directory) {
+      continue;
+    }
+    printRow(fileStat.m_uncomp_size,
+             fileStat.m_comp_size,
+             fileStat.m_method == MZ_DEFLATED ? "deflated" : "stored",
+             fileStat.m_filename);
+    totalSize += fileStat.m_uncomp_size;
+    totalCompressedSize += fileStat.m_comp_size;
+    ++numFiles;
+  }
+  printRow(totalSize,
+           totalCompressedSize,
+           "",
+           "(" + std::to_string(numFiles) + " files)");
+  mz_zip_reader_end(&zipArchive);
+}
 }
 
 /*
@@ -300,9 +417,20 @@ Json::Value AggregateManifestsAndValidate(
 class ZipArchive
 {
 public:
+  /*
+   * @param archiveFileName is the path of the zip archive to create
+   * @param compressionLevel is the compression level used to deflate files
+   * @param bundleName is the name of the bundle the files are added to
+   * @param storeIncompressible indicates if files which do not compress
+   *        well are stored without compression
+   * @param alignment is the alignment of the data of stored files, relative
+   *        to the start of the zip archive
+   */
   ZipArchive(const std::string& archiveFileName,
              int compressionLevel,
-             const std::string& bundleName);
+             const std::string& bundleName,
+             bool storeIncompressible = false,
+             mz_uint alignment = 1);
   virtual ~ZipArchive();
   /*
   * @brief Add manifest.json to this zip archive
@@ -349,6 +477,32 @@ private:
    */
   void CheckAndAddToArchivedNames(const std::string& archiveEntry);
 
+  /*
+   * @brief Add a file entry with the given contents to the zip archive.
+   *        The contents are stored without compression if the compression
+   *        level is 0, or if storeIncompressible is set and deflating the
+   *        contents does not pay off. Otherwise they are deflated.
+   * @throw std::runtime exception if failed to add the entry
+   * @param archiveEntry is the name of the entry
+   * @param contents is the uncompressed contents of the entry
+   * @param lastModified is the modification time of the entry, or NULL to
+   *        use the current time
+   */
+  void AddFileEntry(const std::string& archiveEntry,
+                    const std::string& contents,
+                    MZ_TIME_T* lastModified);
+
+  /*
+   * @brief Add a file entry with the given contents to the zip archive
+   *        without compressing it. The local header of the entry is padded
+   *        so that the contents start at a multiple of the alignment.
+   * @throw std::runtime exception if failed to add the entry
+   */
+  void AddStoredFileEntry(const std::string& archiveEntry,
+                          const void* data,
+                          std::size_t size,
+                          MZ_TIME_T* lastModified);
+
   void PrintErrorAndExit(const std::string& errorMsg)
   {
     std::cerr << errorMsg << std::endl;
@@ -358,6 +512,8 @@ private:
   std::string fileName;
   int compressionLevel;
   std::string bundleName;
+  bool storeIncompressible;
+  mz_uint alignment;
   std::unique_ptr<mz_zip_archive> writeArchive;
   std::set<std::string> archivedNames; // list of all the file entries
   std::set<std::string> archivedDirs;  // list of all directory entries
@@ -365,10 +521,14 @@ private:
 
 ZipArchive::ZipArchive(const std::string& archiveFileName,
                        int compressionLevel,
-                       const std::string& bName)
+                       const std::string& bName,
+                       bool storeIncompressible,
+                       mz_uint alignment)
   : fileName(archiveFileName)
   , compressionLevel(compressionLevel)
   , bundleName(bName)
+  , storeIncompressible(storeIncompressible)
+  , alignment(alignment)
   , writeArchive(new mz_zip_archive())
 {
   std::clog << "Initializing zip archive " << fileName << " ..." << std::endl;
@@ -397,11 +557,9 @@ void ZipArchive::AddManifestFile(const Json::Value& manifest)
 
   CheckAndAddToArchivedNames(archiveEntry);
 
-  if (MZ_FALSE == mz_zip_writer_add_mem(writeArchive.get(),
-                                        archiveEntry.c_str(),
-                                        styledManifestJson.c_str(),
-                                        styledManifestJson.size(),
-                                        compressionLevel)) {
+  try {
+    AddFileEntry(archiveEntry, styledManifestJson, NULL);
+  } catch (const std::runtime_error&) {
     throw std::runtime_error("Error writing manifest.json to archive " +
                              fileName);
   }
@@ -431,12 +589,27 @@ void ZipArchive::AddResourceFile(const std::string& resFileName,
   std::string archiveEntry = bundleName + "/" + archiveName;
   CheckAndAddToArchivedNames(archiveEntry);
 
-  if (!mz_zip_writer_add_file(writeArchive.get(),
-                              archiveEntry.c_str(),
-                              resFileName.c_str(),
-                              NULL,
-                              0,
-                              compressionLevel)) {
+  if (storeIncompressible || alignment > 1) {
+    // The contents are needed in memory to decide whether to compress them
+    // and to align them.
+    MZ_TIME_T lastModified;
+    nowide::ifstream resFile(resFileName, std::ios::in | std::ios::binary);
+    if (!resFile.is_open() ||
+        !get_file_modified_time(resFileName, lastModified)) {
+      throw std::runtime_error("Error reading file " + resFileName);
+    }
+    std::string contents{ std::istreambuf_iterator<char>(resFile),
+                          std::istreambuf_iterator<char>() };
+    if (resFile.bad()) {
+      throw std::runtime_error("Error reading file " + resFileName);
+    }
+    AddFileEntry(archiveEntry, contents, &lastModified);
+  } else if (!mz_zip_writer_add_file(writeArchive.get(),
+                                     archiveEntry.c_str(),
+                                     resFileName.c_str(),
+                                     NULL,
+                                     0,
+                                     compressionLevel)) {
     throw std::runtime_error("Error writing file to archive");
   }
   // add a directory entries for the file path
@@ -460,6 +633,138 @@ void ZipArchive::AddDirectory(const std::string& dirName)
   }
 }
 
+void ZipArchive::AddFileEntry(const std::string& archiveEntry,
+                              const std::string& contents,
+                              MZ_TIME_T* lastModified)
+{
+  // Inflating a resource costs time on every read, and a stored resource
+  // can be read directly from the bundle file. Compression therefore has
+  // to save a noticeable share of the size, and more than a few bytes.
+  const std::size_t minSavedBytes = 512;
+  const std::size_t minSavedPercent = 10;
+
+  const std::size_t size = contents.size();
+  bool store = (compressionLevel == MZ_NO_COMPRESSION || size == 0);
+  if (!store && storeIncompressible) {
+    store = hasCompressedFileExtension(archiveEntry) ||
+            size <= minSavedBytes;
+  }
+
+  std::unique_ptr<void, void (*)(void*)> compressed(nullptr, ::free);
+  std::size_t compressedSize = 0;
+  if (!store && storeIncompressible) {
+    // Produce raw deflate data, as used in zip archives.
+    const mz_uint flags = tdefl_create_comp_flags_from_zip_params(
+      compressionLevel, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    compressed.reset(tdefl_compress_mem_to_heap(
+      contents.data(), size, &compressedSize, flags));
+    if (!compressed) {
+      throw std::runtime_error("Error compressing " + archiveEntry);
+    }
+    store = compressedSize >= size ||
+            size - compressedSize <
+              std::max(minSavedBytes, size * minSavedPercent / 100);
+  }
+
+  std::clog << "\t " << (store ? "storing " : "deflating ") << archiveEntry
+            << std::endl;
+  if (store) {
+    AddStoredFileEntry(archiveEntry, contents.data(), size, lastModified);
+  } else if (compressed) {
+    if (!mz_zip_writer_add_mem_ex_v2(
+          writeArchive.get(),
+          archiveEntry.c_str(),
+          compressed.get(),
+          compressedSize,
+          NULL,
+          0,
+          compressionLevel | MZ_ZIP_FLAG_COMPRESSED_DATA,
+          size,
+          static_cast<mz_uint32>(
+            mz_crc32(MZ_CRC32_INIT,
+                     reinterpret_cast<const unsigned char*>(contents.data()),
+                     size)),
+          lastModified,
+          NULL,
+          0,
+          NULL,
+          0)) {
+      throw std::runtime_error("Error writing file to archive");
+    }
+  } else if (!mz_zip_writer_add_mem_ex_v2(writeArchive.get(),
+                                          archiveEntry.c_str(),
+                                          contents.data(),
+                                          size,
+                                          NULL,
+                                          0,
+                                          compressionLevel,
+                                          0,
+                                          0,
+                                          lastModified,
+                                          NULL,
+                                          0,
+                                          NULL,
+                                          0)) {
+    throw std::runtime_error("Error writing file to archive");
+  }
+}
+
+void ZipArchive::AddStoredFileEntry(const std::string& archiveEntry,
+                                    const void* data,
+                                    std::size_t size,
+                                    MZ_TIME_T* lastModified)
+{
+  // Offsets and sizes of the zip local file header, see the zip file
+  // format specification (APPNOTE.TXT, section 4.3.7).
+  const mz_uint64 localHeaderSize = 30;
+  // The extra field id used by Android's zipalign for padding.
+  const mz_uint16 paddingFieldId = 0xd935;
+  const mz_uint paddingFieldHeaderSize = 4;
+
+  // Pad the extra field of the local header, so that the data starts at a
+  // multiple of the alignment. Data smaller than the alignment is only
+  // padded if it would cross a multiple of the alignment otherwise. miniz
+  // adds a zip64 extra field to the local header of entries beyond 4 GiB,
+  // which are not aligned therefore.
+  std::string padding;
+  const mz_uint64 dataOffset =
+    writeArchive->m_archive_size + localHeaderSize + archiveEntry.size();
+  if (alignment > 1 && size > 0 && dataOffset + size < 0xFFFFFFFF &&
+      (size >= alignment || dataOffset % alignment + size > alignment)) {
+    mz_uint paddingSize =
+      static_cast<mz_uint>((alignment - dataOffset % alignment) % alignment);
+    while (paddingSize > 0 && paddingSize < paddingFieldHeaderSize) {
+      paddingSize += alignment;
+    }
+    if (paddingSize > 0) {
+      const mz_uint16 dataSize =
+        static_cast<mz_uint16>(paddingSize - paddingFieldHeaderSize);
+      padding.assign(paddingSize, '\0');
+      padding[0] = static_cast<char>(paddingFieldId & 0xff);
+      padding[1] = static_cast<char>(paddingFieldId >> 8);
+      padding[2] = static_cast<char>(dataSize & 0xff);
+      padding[3] = static_cast<char>(dataSize >> 8);
+    }
+  }
+
+  if (!mz_zip_writer_add_mem_ex_v2(writeArchive.get(),
+                                   archiveEntry.c_str(),
+                                   data,
+                                   size,
+                                   NULL,
+                                   0,
+                                   MZ_NO_COMPRESSION,
+                                   0,
+                                   0,
+                                   lastModified,
+                                   padding.empty() ? NULL : padding.data(),
+                                   static_cast<mz_uint>(padding.size()),
+                                   NULL,
+                                   0)) {
+    throw std::runtime_error("Error writing file to archive");
+  }
+}
+
 ZipArchive::~ZipArchive()
 {
   assert(writeArchive->m_zip_mode != MZ_ZIP_MODE_INVALID);
@@ -519,8 +824,27 @@ void ZipArchive::AddResourcesFromArchive(const std::string& archiveFileName)
               &currZipArchive, archiveFileName, archiveEntry);
           }
 
-          if (!mz_zip_writer_add_from_zip_reader(
-                writeArchive.get(), &currZipArchive, currZipIndex)) {
+          mz_zip_archive_file_stat fileStat;
+          if (alignment > 1 &&
+              mz_zip_reader_file_stat(
+                &currZipArchive, currZipIndex, &fileStat) &&
+              fileStat.m_method == 0 && fileStat.m_uncomp_size > 0) {
+            // Copying the entry would keep its padding from the source
+            // archive, which does not align it in this archive.
+            std::size_t length = 0;
+            std::unique_ptr<void, void (*)(void*)> data(
+              mz_zip_reader_extract_to_heap(
+                &currZipArchive, currZipIndex, &length, 0),
+              ::free);
+            if (!data) {
+              throw std::runtime_error("Failed to extract file " +
+                                       std::string(archiveName) +
+                                       " from archive " + archiveFileName);
+            }
+            AddStoredFileEntry(
+              archiveName, data.get(), length, &fileStat.m_time);
+          } else if (!mz_zip_writer_add_from_zip_reader(
+                       writeArchive.get(), &currZipArchive, currZipIndex)) {
             throw std::runtime_error("Failed to append file " +
                                      std::string(archiveName) +
                                      " from archive " + archiveFileName);
@@ -596,7 +920,10 @@ enum OptionIndex
   RESADD,
   ZIPADD,
   MANIFESTADD,
-  BUNDLEFILE
+  BUNDLEFILE,
+  STOREINCOMPRESSIBLE,
+  ALIGNMENT,
+  REPORT
 };
 
 const option::Descriptor usage[] = {
@@ -669,6 +996,32 @@ const option::Descriptor usage[] = {
     Custom_Arg::NonEmpty,
     " --bundle-file, -b \tPath to the bundle binary. The resources zip file "
     "will be appended to this binary. " },
+  { STOREINCOMPRESSIBLE,
+    0,
+    "s",
+    "store-incompressible",
+    Custom_Arg::None,
+    " --store-incompressible, -s \tStore files without compression if "
+    "deflating them saves less than 10 percent or 512 bytes of their size. "
+    "Files in compressed formats (e.g. png, jpg, zip) are always stored. "
+    "Stored files are read directly from the bundle file at runtime." },
+  { ALIGNMENT,
+    0,
+    "a",
+    "alignment",
+    Custom_Arg::Numeric,
+    " --alignment, -a \tAlign the data of stored files to a multiple of the "
+    "given number of bytes, e.g. 4096 to align them to memory pages. Files "
+    "smaller than the alignment are only kept from crossing a multiple of "
+    "it. Value must be a power of two up to 32768. Together with "
+    "--bundle-file, the zip archive is appended at an aligned offset." },
+  { REPORT,
+    0,
+    "R",
+    "report",
+    Custom_Arg::None,
+    " --report, -R \tPrint the size, compressed size, compression ratio and "
+    "compression method of each file in the zip archive." },
   { UNKNOWN,
     0,
     "",
@@ -758,7 +1111,19 @@ static int checkSanity(option::Parser& parse, option::Option* options)
         }
       }
     };
-  check_multiple_args({ BUNDLEFILE, OUTFILE, BUNDLENAME });
+  check_multiple_args({ BUNDLEFILE, OUTFILE, BUNDLENAME, ALIGNMENT });
+
+  // The alignment is limited by the size of the padding extra field.
+  if (options[ALIGNMENT]) {
+    long alignment = strtol(options[ALIGNMENT].arg, nullptr, 10);
+    if (alignment < 1 || alignment > 32768 ||
+        (alignment & (alignment - 1)) != 0) {
+      std::cerr << "The --alignment argument must be a power of two between "
+                   "1 and 32768. Check usage."
+                << std::endl;
+      return_code = EXIT_FAILURE;
+    }
+  }
 
   // At-least one of --bundle-file or --out-file is required.
   if (!options[BUNDLEFILE] && !options[OUTFILE]) {
@@ -797,6 +1162,7 @@ int main(int argc, char** argv)
   const int BUNDLE_MANIFEST_VALIDATION_ERROR_CODE(2);
 
   int compressionLevel = MZ_DEFAULT_LEVEL; //default compression level;
+  mz_uint alignment = 1;
   int return_code = EXIT_SUCCESS;
   std::string bundleName;
 
@@ -834,6 +1200,12 @@ int main(int argc, char** argv)
   }
   std::clog << "using compression level " << compressionLevel << std::endl;
 
+  if (options[ALIGNMENT]) {
+    alignment =
+      static_cast<mz_uint>(strtol(options[ALIGNMENT].arg, nullptr, 10));
+    std::clog << "using alignment " << alignment << std::endl;
+  }
+
   std::string zipFile;
   bool deleteTempFile = false;
 
@@ -855,7 +1227,11 @@ int main(int argc, char** argv)
       }
 
       std::unique_ptr<ZipArchive> zipArchive(
-        new ZipArchive(zipFile, compressionLevel, bundleName));
+        new ZipArchive(zipFile,
+                       compressionLevel,
+                       bundleName,
+                       options[STOREINCOMPRESSIBLE] != nullptr,
+                       alignment));
 
       // map of manifest file to its JSON data
       std::unordered_map<std::string, Json::Value> manifests;
@@ -888,6 +1264,9 @@ int main(int argc, char** argv)
         zipArchive->AddResourcesFromArchive(opt->arg);
       }
     }
+    if (options[REPORT]) {
+      printArchiveReport(zipFile, std::cout);
+    }
     // ---------------------------------------------------------------------------------
     //      APPEND ZIP to BINARY if bundle-file is specified
     // ---------------------------------------------------------------------------------
@@ -903,6 +1282,12 @@ int main(int argc, char** argv)
                   << std::endl;
         std::clog << "  Initial file size : " << outFileStream.tellp()
                   << std::endl;
+        // Stored files are aligned relative to the start of the zip
+        // archive, so the archive has to start at an aligned offset.
+        std::streamoff paddingSize =
+          (alignment - outFileStream.tellp() % alignment) % alignment;
+        std::fill_n(
+          std::ostreambuf_iterator<char>(outFileStream), paddingSize, '\0');
         outFileStream << zipFileStream.rdbuf();
         std::clog << "  Final file size : " << outFileStream.tellp()
                   << std::endl;
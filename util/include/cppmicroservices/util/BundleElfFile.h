@@ -26,12 +26,12 @@
 #  include "MappedFile.h"
 
 #  include <cerrno>
+#  include <cstdint>
 #  include <cstring>
+#  include <dlfcn.h>
 #  include <elf.h>
-#  include <fstream>
-#  include <map>
+#  include <link.h>
 #  include <memory>
-#  include <new>
 
 #  include <sys/stat.h>
 
@@ -52,6 +52,7 @@ struct Elf<ELFCLASS32>
 {
   typedef Elf32_Ehdr Ehdr;
   typedef Elf32_Shdr Shdr;
+  typedef Elf32_Phdr Phdr;
   typedef Elf32_Dyn Dyn;
   typedef Elf32_Addr Addr;
   typedef Elf32_Sym Sym;
@@ -71,6 +72,7 @@ struct Elf<ELFCLASS64>
 {
   typedef Elf64_Ehdr Ehdr;
   typedef Elf64_Shdr Shdr;
+  typedef Elf64_Phdr Phdr;
   typedef Elf64_Dyn Dyn;
   typedef Elf64_Addr Addr;
   typedef Elf64_Sym Sym;
@@ -85,6 +87,20 @@ struct Elf<ELFCLASS64>
   }
 };
 
+// The address of a function in the image containing this code, which
+// stays loaded as long as it can be called.
+inline const void* GetBundleElfFileAnchor()
+{
+  return reinterpret_cast<const void*>(&GetBundleElfFileAnchor);
+}
+
+// Locates the .us_resources section of an ELF shared object.
+//
+// The file is mapped once and the headers are parsed in place. If the file
+// is an image which is already loaded and cannot be unloaded while the
+// framework runs (the executable, or the image containing this code), the
+// resources are read from the loaded image and the file mapping is
+// released again.
 template<class ElfType>
 class BundleElfFile
   : public BundleObjFile
@@ -93,6 +109,7 @@ class BundleElfFile
 public:
   typedef typename ElfType::Ehdr Ehdr;
   typedef typename ElfType::Shdr Shdr;
+  typedef typename ElfType::Phdr Phdr;
   typedef typename ElfType::Dyn Dyn;
   typedef typename ElfType::Addr Addr;
   typedef typename ElfType::Sym Sym;
@@ -101,61 +118,68 @@ public:
   typedef typename ElfType::Word Word;
   typedef typename ElfType::Off Off;
 
-  BundleElfFile(std::ifstream& fs,
-                std::size_t fileSize,
-                const std::string& fileName)
+  BundleElfFile(const std::shared_ptr<MappedFile>& image,
+                const struct stat& fileStat)
     : m_rawData()
   {
+    const auto* data = static_cast<char*>(image->GetData());
+    const uint64_t fileSize = image->GetSize();
+
     if (fileSize < sizeof(Ehdr)) {
       throw InvalidElfException("Missing ELF header");
     }
 
-    fs.seekg(0);
-
-    // Read the ELF header
+    // Headers are copied to the stack, because the section headers are
+    // not guaranteed to be aligned within the file.
     Ehdr elfHeader;
-    fs.read(reinterpret_cast<char*>(&elfHeader), sizeof elfHeader);
+    memcpy(&elfHeader, data, sizeof elfHeader);
 
     if (elfHeader.e_type != ET_DYN) {
       throw InvalidElfException("Not an ELF shared library");
     }
 
-    if (elfHeader.e_shoff + (elfHeader.e_shnum * elfHeader.e_shentsize) >
-        fileSize) {
+    if (elfHeader.e_shentsize < sizeof(Shdr) ||
+        elfHeader.e_shoff +
+            uint64_t(elfHeader.e_shnum) * elfHeader.e_shentsize >
+          fileSize ||
+        elfHeader.e_shstrndx >= elfHeader.e_shnum) {
       throw InvalidElfException("ELF section headers missing");
     }
 
-    // read in all section headers
-    auto sectionHeaders = std::make_unique<Shdr[]>(elfHeader.e_shnum);
-    fs.seekg(elfHeader.e_shoff);
-    fs.read(reinterpret_cast<char*>(sectionHeaders.get()),
-            sizeof(Shdr) * elfHeader.e_shnum);
-
-    // parse the .us_resources section
-    // keep the buffer in a smart pointer to correctly clean up at end
-    // of scope even if exceptions occur.
-    auto buffer =
-      std::make_unique<char[]>(sectionHeaders[elfHeader.e_shstrndx].sh_size);
-    if (nullptr != buffer) {
-      fs.seekg(sectionHeaders[elfHeader.e_shstrndx].sh_offset);
-      fs.read(buffer.get(), sectionHeaders[elfHeader.e_shstrndx].sh_size);
-
-      for (int i = 0; i < elfHeader.e_shnum; ++i) {
-        if (0 == strcmp(".us_resources",
-                        (buffer.get() + sectionHeaders[i].sh_name))) {
-          fs.seekg(sectionHeaders[i].sh_offset);
-          auto zipContentSize = sectionHeaders[i].sh_size;
-          if (0 < zipContentSize) {
-            off_t pa_offset =
-              (sectionHeaders[i].sh_offset) & ~(sysconf(_SC_PAGESIZE) - 1);
-            size_t mappedLength =
-              zipContentSize + (sectionHeaders[i].sh_offset) - pa_offset;
-            m_rawData = std::make_shared<RawBundleResources>(
-              std::make_unique<MappedFile>(fileName, mappedLength, pa_offset));
-            break;
-          }
-        }
+    auto getSectionHeader = [&](std::size_t i) {
+      Shdr header;
+      memcpy(&header,
+             data + elfHeader.e_shoff + i * elfHeader.e_shentsize,
+             sizeof header);
+      return header;
+    };
+
+    const Shdr names = getSectionHeader(elfHeader.e_shstrndx);
+    if (names.sh_offset + uint64_t(names.sh_size) > fileSize) {
+      throw InvalidElfException("ELF section names missing");
+    }
+
+    static const char sectionName[] = ".us_resources";
+    for (std::size_t i = 0; i < elfHeader.e_shnum; ++i) {
+      const Shdr section = getSectionHeader(i);
+      if (section.sh_name + uint64_t(sizeof sectionName) > names.sh_size ||
+          0 != memcmp(data + names.sh_offset + section.sh_name,
+                      sectionName,
+                      sizeof sectionName)) {
+        continue;
       }
+
+      if (0 < section.sh_size && section.sh_type != SHT_NOBITS &&
+          section.sh_offset + uint64_t(section.sh_size) <= fileSize) {
+        void* loaded = FindLoadedSection(fileStat, section);
+        m_rawData = std::make_shared<RawBundleResources>(
+          std::make_unique<DataContainerRange>(
+            loaded ? nullptr : image,
+            loaded ? loaded
+                   : static_cast<char*>(image->GetData()) + section.sh_offset,
+            section.sh_size));
+      }
+      break;
     }
   }
 
@@ -166,47 +190,116 @@ public:
   }
 
 private:
+  struct LoadedImage
+  {
+    const struct stat* fileStat;
+    const Shdr* section;
+    void* data;
+  };
+
+  // Return the address of the loaded section, if the file is loaded as
+  // the executable or as the image containing this code.
+  static void* FindLoadedSection(const struct stat& fileStat,
+                                 const Shdr& section)
+  {
+    // Only images of the host class can be loaded.
+    if (sizeof(Phdr) != sizeof(ElfW(Phdr)) || !(section.sh_flags & SHF_ALLOC)) {
+      return nullptr;
+    }
+    LoadedImage loaded = { &fileStat, &section, nullptr };
+    dl_iterate_phdr(&MatchLoadedImage, &loaded);
+    return loaded.data;
+  }
+
+  static int MatchLoadedImage(struct dl_phdr_info* info, std::size_t, void* d)
+  {
+    auto* loaded = static_cast<LoadedImage*>(d);
+    const Shdr& section = *loaded->section;
+    const auto anchor = reinterpret_cast<ElfW(Addr)>(GetBundleElfFileAnchor());
+    const bool isExecutable = !info->dlpi_name || !*info->dlpi_name;
+
+    bool containsSection = false;
+    bool containsAnchor = false;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+      const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+      if (segment.p_type != PT_LOAD) {
+        continue;
+      }
+      const ElfW(Addr) begin = info->dlpi_addr + segment.p_vaddr;
+      containsAnchor |= anchor >= begin && anchor < begin + segment.p_memsz;
+      containsSection |=
+        section.sh_addr >= segment.p_vaddr &&
+        section.sh_addr + section.sh_size <=
+          segment.p_vaddr + segment.p_filesz &&
+        section.sh_addr - segment.p_vaddr ==
+          section.sh_offset - segment.p_offset;
+    }
+
+    if (!isExecutable && !containsAnchor) {
+      return 0;
+    }
+
+    // Compare the file identity, names of loaded images may differ from
+    // the bundle location.
+    struct stat imageStat;
+    const char* path = isExecutable ? "/proc/self/exe" : info->dlpi_name;
+    if (containsSection && stat(path, &imageStat) == 0 &&
+        imageStat.st_dev == loaded->fileStat->st_dev &&
+        imageStat.st_ino == loaded->fileStat->st_ino) {
+      loaded->data = reinterpret_cast<void*>(info->dlpi_addr + section.sh_addr);
+      return 1;
+    }
+    return 0;
+  }
+
   std::shared_ptr<RawBundleResources> m_rawData;
 };
 
 std::unique_ptr<BundleObjFile> CreateBundleElfFile(const std::string& fileName)
 {
-  struct stat elfStat;
-  errno = 0;
-  if (stat(fileName.c_str(), &elfStat) != 0) {
-    throw InvalidElfException("Stat for " + fileName + " failed", errno);
+  int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw InvalidElfException("Opening " + fileName + " failed", errno);
   }
 
-  std::size_t fileSize = elfStat.st_size;
-
-  if (fileSize < EI_NIDENT) {
+  // The file descriptor is not needed after the file is mapped.
+  struct stat elfStat;
+  if (fstat(fd, &elfStat) != 0) {
+    int errorNumber = errno;
+    close(fd);
+    throw InvalidElfException("Stat for " + fileName + " failed", errorNumber);
+  }
+  if (static_cast<std::size_t>(elfStat.st_size) < EI_NIDENT) {
+    close(fd);
     throw InvalidElfException("Missing ELF identification");
   }
+  auto image = std::make_shared<MappedFile>(fd, elfStat.st_size, 0);
+  int errorNumber = errno;
+  close(fd);
+  if (!image->GetData()) {
+    throw InvalidElfException("Mapping " + fileName + " failed", errorNumber);
+  }
 
-  std::ifstream elfFile(fileName.c_str(), std::ios_base::binary);
-  elfFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-  char elfIdent[EI_NIDENT];
-  elfFile.read(elfIdent, sizeof elfIdent);
-
+  const auto* elfIdent = static_cast<const unsigned char*>(image->GetData());
   if (memcmp(elfIdent, ELFMAG, SELFMAG) != 0) {
     throw InvalidElfException("Not an ELF object file");
   }
 
-  std::ifstream selfFile(fileName, std::ios_base::binary);
-  char selfIdent[EI_NIDENT];
-  selfFile.read(selfIdent, sizeof selfIdent);
-  selfFile.close();
-  if (memcmp(elfIdent, selfIdent, EI_VERSION) != 0) {
+  // The headers are read in place, so they must use the host byte order.
+#  if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (elfIdent[EI_DATA] != ELFDATA2LSB) {
+#  else
+  if (elfIdent[EI_DATA] != ELFDATA2MSB) {
+#  endif
     throw InvalidElfException("Not a compatible ELF object file");
   }
 
   if (elfIdent[EI_CLASS] == ELFCLASS32) {
     return std::unique_ptr<BundleObjFile>(
-      new BundleElfFile<Elf<ELFCLASS32>>(elfFile, fileSize, fileName));
+      new BundleElfFile<Elf<ELFCLASS32>>(image, elfStat));
   } else if (elfIdent[EI_CLASS] == ELFCLASS64) {
     return std::unique_ptr<BundleObjFile>(
-      new BundleElfFile<Elf<ELFCLASS64>>(elfFile, fileSize, fileName));
+      new BundleElfFile<Elf<ELFCLASS64>>(image, elfStat));
   } else {
     throw InvalidElfException("Unknown ELF format");
   }
@@ -65,6 +65,30 @@ private:
   std::size_t m_DataSize;
 };
 
+// A range of the data of another container, which is kept alive as long
+// as the range is in use. Without an owner, the data must outlive the
+// range.
+class DataContainerRange final : public DataContainer
+{
+public:
+  DataContainerRange(std::shared_ptr<DataContainer> owner,
+                     void* data,
+                     std::size_t dataSize)
+    : m_Owner(std::move(owner))
+    , m_Data(data)
+    , m_DataSize(dataSize)
+  {}
+  ~DataContainerRange() = default;
+
+  void* GetData() const override { return m_Data; }
+  std::size_t GetSize() const override { return m_DataSize; }
+
+private:
+  std::shared_ptr<DataContainer> m_Owner;
+  void* m_Data;
+  std::size_t m_DataSize;
+};
+
 }
 
 #endif // CPPMICROSERVICES_BUNDLEOBJFILE_H
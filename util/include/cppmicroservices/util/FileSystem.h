@@ -23,6 +23,7 @@
 #ifndef CPPMICROSERVICES_UTIL_FILESYSTEM_H
 #define CPPMICROSERVICES_UTIL_FILESYSTEM_H
 
+#include <cstdint>
 #include <string>
 
 namespace cppmicroservices {
@@ -48,6 +49,15 @@ bool IsDirectory(const std::string& path);
 bool IsFile(const std::string& path);
 bool IsRelative(const std::string& path);
 
+// Get the size in bytes, the last modification time (in seconds
+// since the epoch) and the file serial number (the inode on POSIX
+// systems, 0 where it is not available) of a file. Returns false if
+// the file cannot be accessed.
+bool GetFileInfo(const std::string& path,
+                 std::uint64_t& size,
+                 std::int64_t& modifiedTime,
+                 std::uint64_t& fileId);
+
 std::string GetAbsolute(const std::string& path, const std::string& base);
 
 void MakePath(const std::string& path);
@@ -58,6 +58,20 @@ public:
     }
   }
 
+  // Map a range of the open file fileDesc. The mapping does not need the
+  // file descriptor, which remains owned by the caller.
+  MappedFile(int fd, size_t mapLength, off_t offset)
+    : fileDesc(-1)
+    , mappedAddress(nullptr)
+    , mapSize(mapLength)
+  {
+    mappedAddress = mmap(0, mapLength, PROT_READ, MAP_PRIVATE, fd, offset);
+    if (MAP_FAILED == mappedAddress) {
+      mappedAddress = nullptr;
+      mapSize = 0;
+    }
+  }
+
   ~MappedFile()
   {
     if (mappedAddress && mapSize) {
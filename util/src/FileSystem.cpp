@@ -247,6 +247,22 @@ bool IsFile(const std::string& path)
   return S_ISREG(s.st_mode);
 }
 
+bool GetFileInfo(const std::string& path,
+                 std::uint64_t& size,
+                 std::int64_t& modifiedTime,
+                 std::uint64_t& fileId)
+{
+  US_STAT s;
+  if (us_stat(path.c_str(), &s)) {
+    return false;
+  }
+  size = static_cast<std::uint64_t>(s.st_size);
+  modifiedTime = static_cast<std::int64_t>(s.st_mtime);
+  // st_ino is always 0 on Windows
+  fileId = static_cast<std::uint64_t>(s.st_ino);
+  return true;
+}
+
 bool IsRelative(const std::string& path)
 {
 #ifdef US_PLATFORM_WINDOWS
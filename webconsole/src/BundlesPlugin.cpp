@@ -36,6 +36,7 @@
 #include "cppmicroservices/Constants.h"
 
 #include <cmath>
+#include <sstream>
 
 namespace cppmicroservices {
 
@@ -334,7 +335,9 @@ void BundlesPlugin::GetBundleData(long id,
 
   // ----------------- Get bundle manifest data ---------------------
 
-  data["bundle-manifest"] = Any(bundle.GetHeaders()).ToJSON();
+  std::ostringstream manifest;
+  any_value_to_json(manifest, headers);
+  data["bundle-manifest"] = manifest.str();
 
   // --------------- Get bundle resource information ------------------
 
@@ -362,7 +365,9 @@ void BundlesPlugin::GetBundleData(long id,
     for (auto const& p : s.GetPropertyKeys()) {
       props.insert(std::make_pair(p, s.GetProperty(p)));
     }
-    service["props"] = Any(props).ToJSON();
+    std::ostringstream propsJson;
+    any_value_to_json(propsJson, props);
+    service["props"] = propsJson.str();
 
     services << std::move(service);
   }
@@ -35,6 +35,7 @@
 #include "cppmicroservices/GetBundleContext.h"
 
 #include <set>
+#include <sstream>
 
 namespace cppmicroservices {
 
@@ -117,7 +118,9 @@ AbstractWebConsolePlugin::TemplateData ServicesPlugin::GetInterface(
     entry["scope"] =
       ref.GetProperty(Constants::SERVICE_SCOPE).ToStringNoExcept();
     entry["types"] = ref.GetProperty(Constants::OBJECTCLASS).ToStringNoExcept();
-    entry["props"] = Any(props).ToJSON();
+    std::ostringstream propsJson;
+    any_value_to_json(propsJson, props);
+    entry["props"] = propsJson.str();
 
     data << std::move(entry);
   }